@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "Result.h"
+
+namespace SFS
+{
+/**
+ * @brief Outcome of an asynchronous SFSClient call, delivered through a std::future
+ * @details value is only meaningful when result is a success
+ */
+template <typename T>
+struct AsyncResult
+{
+    /// @brief Result of the call, with the same codes the synchronous variant returns
+    Result result{Result::NotSet};
+
+    /// @brief The data retrieved by the call
+    T value{};
+};
+} // namespace SFS
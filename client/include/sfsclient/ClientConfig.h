@@ -5,6 +5,8 @@
 
 #include "Logging.h"
 
+#include <chrono>
+#include <cstddef>
 #include <optional>
 #include <string>
 
@@ -30,5 +32,193 @@ struct ClientConfig
      * LogData does not exist after the callback returns, so caller has to copy it if the data will be stored.
      */
     std::optional<LoggingCallbackFn> logCallbackFn;
+
+    /**
+     * @brief Maximum number of idle connections kept alive by the SFSClient to be reused by later requests
+     * @details Reusing a connection allows back-to-back requests to skip a new TCP and TLS handshake. Connections are
+     * only kept while idle, so this does not limit the number of concurrent requests. Set to 0 to disable pooling.
+     */
+    unsigned maxIdleConnections{4};
+
+    /// @brief Time an idle connection can be kept in the pool before it is discarded instead of being reused
+    std::chrono::seconds idleConnectionTimeout{60};
+
+    /**
+     * @brief Drives all network transfers of the SFSClient from a single background thread
+     * @details When set, requests are executed by an event-driven engine instead of in the calling thread, and
+     * connections are reused across all calls. Each call still blocks its thread until its own request completes,
+     * including the retries, so the number of requests in flight is bounded by the number of threads making calls,
+     * synchronous or asynchronous. What the engine saves is the time those threads would spend on network I/O and
+     * back-off between retries, and the connections and handshakes shared across calls.
+     */
+    bool useBackgroundTransferThread{false};
+
+    /**
+     * @brief Sends requests over HTTP/2, so that concurrent requests are multiplexed over a single connection
+     * @details Only takes effect along with useBackgroundTransferThread, as requests can only share a connection when
+     * they are driven by the same thread. Concurrent calls, and the parallel requests of a single call, then share one
+     * TCP and TLS connection to the service instead of opening one each. HTTP/2 is negotiated during the TLS
+     * handshake, so requests fall back to HTTP/1.1 if it is not available.
+     */
+    bool useHttp2{false};
+
+    /**
+     * @brief Maximum size in bytes of a response of the service kept in memory
+     * @details Guards against servers sending unexpected amounts of data. A larger response fails the call with
+     * ConnectionUnexpectedError, unless it is a download info response within maxStreamedDownloadInfoSize.
+     */
+    size_t maxResponseSize{100000};
+
+    /**
+     * @brief Maximum size in bytes of a download info response that is larger than maxResponseSize
+     * @details Such a response is written to a temporary file as it is received and then parsed from it incrementally,
+     * so products with many files are not bound by maxResponseSize, and memory only holds the resulting files. These
+     * responses are not stored in persistentCacheFile. Defaults to 0, which makes them fail.
+     */
+    size_t maxStreamedDownloadInfoSize{0};
+
+    /**
+     * @brief Fails calls right away while the service has asked, with a Retry-After header, to be sent no requests
+     * @details Once a response tells to retry later, requests to the same host from any SFSClient of the process wait
+     * until that time before they are sent. When set, calls fail with HttpTooManyRequests instead of waiting. Calls
+     * also fail that way if the wait would go past RequestParams::retryDeadline.
+     */
+    bool failFastWhenThrottled{false};
+
+    /**
+     * @brief Spreads the delays between retries randomly, with decorrelated jitter
+     * @details Clients throttled at the same time then retry at different times instead of all together. Each delay is
+     * drawn between the base delay and three times the previous one, and never exceeds the longest delay of the
+     * exponential back-off used otherwise. Delays given with Retry-After are used as is. Defaults to false.
+     */
+    bool jitterRetryDelays{false};
+
+    /**
+     * @brief Fraction of the requests of the SFSClient that can be retried
+     * @details Retries are drawn from a budget shared by all calls of the SFSClient, to which every request adds this
+     * fraction of a retry, so that retries can not exceed that share of the traffic while the service keeps failing.
+     * Defaults to std::nullopt, which lets every request retry up to its own limit. 0.1 is a sensible value to enable
+     * it with. Use SFSClient::GetStatistics() to see the state of the budget.
+     */
+    std::optional<double> retryBudgetRatio{};
+
+    /// @brief Number of retries the budget holds at most, and starts with, which allows for bursts of failures
+    unsigned retryBudgetBurst{10};
+
+    /**
+     * @brief Number of consecutive failed attempts to reach a host after which requests to it fail right away
+     * @details Responses with a 5xx status code, timeouts and connection errors count as failures, while errors of the
+     * client itself, such as a response over the size limits, do not. Once the circuit breaker of a host trips, calls
+     * fail with HttpServiceNotAvailable without sending requests for circuitBreakerCoolDown. A single request is then
+     * let through to probe the host: the breaker closes again if it succeeds, and stays open for another cool-down
+     * otherwise. Defaults to 0, which disables the circuit breaker.
+     */
+    unsigned circuitBreakerFailureThreshold{0};
+
+    /// @brief Time requests to a host fail right away once its circuit breaker trips
+    std::chrono::seconds circuitBreakerCoolDown{30};
+
+    /**
+     * @brief Maximum number of threads used by the SFSClient to run asynchronous calls
+     * @details Asynchronous calls are queued and run by a pool of at most this many threads, which are only started
+     * once asynchronous calls are made. Each call holds a thread for its whole duration, including the waits before
+     * retries, so this is also the maximum number of asynchronous calls in flight. Calls beyond this limit wait in the
+     * queue until a thread is free.
+     */
+    unsigned maxAsyncThreads{4};
+
+    /**
+     * @brief Maximum number of requests a single call sends to the service at the same time
+     * @details Calls that need several independent requests, such as retrieving the download info of multiple products
+     * or of an app and its prerequisites, send them concurrently up to this limit. The calling thread sends some of
+     * them itself and the rest are sent from the asynchronous call pool, so the limit is also bounded by
+     * maxAsyncThreads + 1. Set to 1 to send them one at a time.
+     */
+    unsigned maxParallelRequestsPerCall{8};
+
+    /**
+     * @brief Time the latest version of a product is kept in memory and reused instead of asking the service again
+     * @details Lookups are cached per instanceId, namespace, product and targeting attributes. A cached lookup skips
+     * the request to the service entirely, so a new version is only seen once the cached one expires. Set to 0 to
+     * disable the cache, which is the default. Use SFSClient::GetStatistics() to see how effective the cache is.
+     */
+    std::chrono::seconds latestVersionCacheTtl{0};
+
+    /// @brief Maximum number of latest version lookups kept in memory. The least recently used ones are dropped first
+    size_t latestVersionCacheMaxEntries{256};
+
+    /**
+     * @brief Time a cached latest version can still be returned after it expires, while it is refreshed in the
+     * background
+     * @details With this stale-while-revalidate mode, an expired lookup does not wait for the service: the cached
+     * version is returned at once, and the lookup is sent again from a background thread. The cached version is
+     * replaced once the response arrives, so later calls see any newer version. The download info of the version is
+     * cached and refreshed along with it, so GetLatestDownloadInfo() calls that find an expired lookup do not wait for
+     * the service either. Lookups that expired longer ago than this wait for the service as usual. Defaults to 0,
+     * which disables this mode.
+     */
+    std::chrono::seconds latestVersionCacheStaleWhileRevalidate{0};
+
+    /**
+     * @brief Time a latest version lookup of a single product waits for lookups from other calls, so that they are
+     * all sent to the service in a single batch request
+     * @details Useful when many independent calls each look up one product, as it saves requests and handshakes at the
+     * cost of up to this much latency per lookup. A batch is sent early once latestVersionBatchMaxSize lookups have
+     * joined it. App lookups are never batched. Defaults to 0, which disables batching.
+     */
+    std::chrono::milliseconds latestVersionBatchWindow{0};
+
+    /// @brief Number of lookups that make a batch request full. See latestVersionBatchWindow
+    size_t latestVersionBatchMaxSize{32};
+
+    /**
+     * @brief Percentile of the recent latest version lookup latencies, in (0, 1], after which a lookup that has not
+     * been answered is sent again on another connection
+     * @details Hedging this way cuts the tail latency caused by the occasional slow connection: the first response is
+     * used and the other request is aborted. Lookups are only hedged once the latencies of 20 lookups are known. Both
+     * requests are sent from the threads of the pool set by maxAsyncThreads, so lookups are not hedged while all of
+     * them are busy. Batched lookups are not hedged. Defaults to std::nullopt, which disables hedging. 0.95 is a common
+     * choice.
+     */
+    std::optional<double> latestVersionHedgePercentile{};
+
+    /**
+     * @brief Fraction of the latest version lookups that can be hedged at most, so that hedging can not overload the
+     * service when it is slow for every request. See latestVersionHedgePercentile
+     */
+    double latestVersionHedgeMaxRate{0.05};
+
+    /**
+     * @brief Time the download info of a product version is kept in memory and reused instead of asking the service
+     * again
+     * @details The files of a given version never change, so this can be long. If the download URLs returned by the
+     * service encode an expiry time, entries are dropped a few minutes before the earliest URL expires, regardless of
+     * this setting. Set to 0 to disable the cache, which is the default.
+     */
+    std::chrono::seconds downloadInfoCacheTtl{0};
+
+    /// @brief Maximum number of product versions whose download info is kept in memory
+    size_t downloadInfoCacheMaxEntries{256};
+
+    /**
+     * @brief Path of a file where the latest version and download info responses of the service are stored, so that
+     * they can be reused by later processes
+     * @details The file is only read once the first lookup is made, and can be shared by concurrent processes. Stored
+     * responses are used without asking the service as long as they are within latestVersionCacheTtl and
+     * downloadInfoCacheTtl, respectively. Not set by default, which disables the file.
+     */
+    std::optional<std::string> persistentCacheFile{};
+
+    /**
+     * @brief Time a response stored in persistentCacheFile can still be used after it expires
+     * @details An expired response within this tolerance is returned right away, and a request to refresh it is sent in
+     * the background. This keeps lookups fast after a restart, and keeps them working while the service is
+     * unreachable. Download info is never used past the expiry of its download URLs. Defaults to 0, which means
+     * expired responses are not used.
+     */
+    std::chrono::seconds persistentCacheMaxStaleness{0};
+
+    /// @brief Maximum number of responses kept in persistentCacheFile. The oldest ones are dropped first
+    size_t persistentCacheMaxEntries{512};
 };
 } // namespace SFS
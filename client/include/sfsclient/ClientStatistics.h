@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SFS
+{
+/// @brief Counters of one of the caches of an SFSClient
+struct CacheStatistics
+{
+    /// @brief Number of lookups answered from the cache
+    uint64_t hits{0};
+
+    /// @brief Number of the hits that returned an expired entry while it was refreshed in the background
+    uint64_t staleHits{0};
+
+    /// @brief Number of lookups that were not in the cache, or whose entry had expired
+    uint64_t misses{0};
+
+    /// @brief Number of entries dropped to make room for new ones
+    uint64_t evictions{0};
+
+    /// @brief Number of entries currently held by the cache
+    size_t entries{0};
+};
+
+/// @brief State of the retry budget of an SFSClient. See ClientConfig::retryBudgetRatio
+struct RetryBudgetStatistics
+{
+    /// @brief Number of retries the budget allows right now. Fractions of a retry build up as requests are made
+    double availableRetries{0};
+
+    /// @brief Number of retries made
+    uint64_t retries{0};
+
+    /// @brief Number of retries that were not made because the budget was exhausted
+    uint64_t rejectedRetries{0};
+};
+
+/// @brief Snapshot of the internal counters of an SFSClient, meant to help tuning its configuration
+struct ClientStatistics
+{
+    /// @brief Cache of latest version lookups. See ClientConfig::latestVersionCacheTtl
+    CacheStatistics latestVersionCache;
+
+    /// @brief Cache of download info. See ClientConfig::downloadInfoCacheTtl
+    CacheStatistics downloadInfoCache;
+
+    /// @brief Responses stored on disk. See ClientConfig::persistentCacheFile
+    CacheStatistics persistentCache;
+
+    /// @brief Number of requests that waited for an identical request already in flight instead of being sent
+    uint64_t coalescedRequests{0};
+
+    /// @brief Number of batch requests sent for latest version lookups. See ClientConfig::latestVersionBatchWindow
+    uint64_t latestVersionBatches{0};
+
+    /// @brief Number of latest version lookups sent as part of those batch requests
+    uint64_t batchedLatestVersionLookups{0};
+
+    /// @brief Retries drawn from the retry budget. All zero if the budget is disabled
+    RetryBudgetStatistics retryBudget;
+
+    /// @brief Number of times the circuit breaker of a host tripped. See ClientConfig::circuitBreakerFailureThreshold
+    uint64_t circuitBreakerTrips{0};
+
+    /// @brief Number of requests that failed right away because the circuit breaker of their host was open
+    uint64_t circuitBreakerRejections{0};
+
+    /// @brief Number of latest version lookups sent again as hedges. See ClientConfig::latestVersionHedgePercentile
+    uint64_t hedgedRequests{0};
+
+    /// @brief Number of hedges whose response arrived before the one of the original lookup
+    uint64_t hedgeWins{0};
+};
+} // namespace SFS
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -27,8 +28,7 @@ struct ProductRequest
 struct RequestParams
 {
     /// @brief List of products to be retrieved from the server (required)
-    /// @note At the moment only a single product request is supported. Using a vector for future implementation of
-    /// batch requests
+    /// @note At the moment only a single product request is supported for apps
     std::vector<ProductRequest> productRequests;
 
     /// @brief Base CorrelationVector to be used in the request for service telemetry stitching (optional)
@@ -37,5 +37,9 @@ struct RequestParams
 
     /// @brief Retry for a web request after a failed attempt. If true, client will retry up to c_maxRetries times
     bool retryOnError{true};
+
+    /// @brief Point in time after which no retry is started (optional)
+    /// @note A retry that would have to wait past it is not made, and the error of the last attempt is returned instead
+    std::optional<std::chrono::steady_clock::time_point> retryDeadline;
 };
 } // namespace SFS
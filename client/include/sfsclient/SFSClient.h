@@ -4,12 +4,15 @@
 #pragma once
 
 #include "AppContent.h"
+#include "AsyncResult.h"
 #include "ClientConfig.h"
+#include "ClientStatistics.h"
 #include "Content.h"
 #include "Logging.h"
 #include "RequestParams.h"
 #include "Result.h"
 
+#include <future>
 #include <memory>
 #include <optional>
 #include <string>
@@ -48,7 +51,10 @@ class SFSClient
 
     /**
      * @brief Retrieve combined metadata & download URLs from the latest version of specified products
-     * @note At the moment only a single product request is supported
+     * @details Multiple products can be requested at once. Their versions are resolved in a single request to the
+     * service, and their download info is then retrieved concurrently. Products unknown to the service are left out of
+     * @param contents, which follows the order of the request. If none of the products is known, HttpNotFound is
+     * returned.
      * @param requestParams Parameters that define this request
      * @param contents A vector of Content that is populated with the result
      */
@@ -64,6 +70,45 @@ class SFSClient
     [[nodiscard]] Result GetLatestAppDownloadInfo(const RequestParams& requestParams,
                                                   std::vector<AppContent>& contents) const noexcept;
 
+    //
+    // Asynchronous variants of the API above
+    //
+
+    /**
+     * @brief Starts retrieving combined metadata & download URLs from the latest version of specified products
+     * @details Returns immediately. The request is run by a pool of threads internal to the SFSClient, and its outcome
+     * is delivered through @param future, with the same Result codes GetLatestDownloadInfo() returns.
+     * A call holds one thread of the pool until it completes, retries included, so at most
+     * ClientConfig::maxAsyncThreads calls run at a time and the others wait in a queue.
+     * The SFSClient waits for pending calls to complete before being destroyed.
+     * @param requestParams Parameters that define this request. They are copied, so they need not outlive the call.
+     * @param future Receives the outcome of the request once it completes
+     * @return Success if the request was started
+     */
+    [[nodiscard]] Result GetLatestDownloadInfoAsync(
+        const RequestParams& requestParams,
+        std::future<AsyncResult<std::vector<Content>>>& future) const noexcept;
+
+    /**
+     * @brief Starts retrieving combined metadata & download URLs from the latest version of specified apps
+     * @details Returns immediately. The request is run by a pool of threads internal to the SFSClient, and its outcome
+     * is delivered through @param future, with the same Result codes GetLatestAppDownloadInfo() returns.
+     * A call holds one thread of the pool until it completes, retries included, so at most
+     * ClientConfig::maxAsyncThreads calls run at a time and the others wait in a queue.
+     * The SFSClient waits for pending calls to complete before being destroyed.
+     * @param requestParams Parameters that define this request. They are copied, so they need not outlive the call.
+     * @param future Receives the outcome of the request once it completes
+     * @return Success if the request was started
+     */
+    [[nodiscard]] Result GetLatestAppDownloadInfoAsync(
+        const RequestParams& requestParams,
+        std::future<AsyncResult<std::vector<AppContent>>>& future) const noexcept;
+
+    /**
+     * @return A snapshot of the internal counters of this SFSClient, such as cache hits and misses
+     */
+    ClientStatistics GetStatistics() const noexcept;
+
     /**
      * @return The version of the SFSClient library
      */
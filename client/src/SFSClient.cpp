@@ -4,13 +4,36 @@
 #include "SFSClient.h"
 
 #include "details/ErrorHandling.h"
+#include "details/Executor.h"
 #include "details/ReportingHandler.h"
 #include "details/SFSClientImpl.h"
 #include "details/connection/CurlConnectionManager.h"
+#include "details/connection/CurlMultiConnectionManager.h"
 
 using namespace SFS;
 using namespace SFS::details;
 
+namespace
+{
+/**
+ * @brief Runs @param fn, turning whatever it throws into the Result of the returned AsyncResult
+ */
+template <typename T, typename Fn>
+AsyncResult<T> RunAsyncCall(Fn&& fn) noexcept
+{
+    AsyncResult<T> out;
+    out.result = [&]() -> Result {
+        try
+        {
+            out.value = fn();
+            return Result::Success;
+        }
+        SFS_CATCH_RETURN()
+    }();
+    return out;
+}
+} // namespace
+
 // Defining the constructor and destructor here allows us to use a unique_ptr to SFSClientImpl in the header file
 SFSClient::SFSClient() noexcept = default;
 SFSClient::~SFSClient() noexcept = default;
@@ -23,9 +46,32 @@ try
         return Result(Result::InvalidArg, "ClientConfig::accountId cannot be empty");
     }
 
+    if (config.retryBudgetRatio && !(*config.retryBudgetRatio >= 0.0))
+    {
+        return Result(Result::InvalidArg, "ClientConfig::retryBudgetRatio cannot be negative");
+    }
+
+    if (config.latestVersionHedgePercentile &&
+        !(*config.latestVersionHedgePercentile > 0.0 && *config.latestVersionHedgePercentile <= 1.0))
+    {
+        return Result(Result::InvalidArg, "ClientConfig::latestVersionHedgePercentile must be in (0, 1]");
+    }
+
+    if (!(config.latestVersionHedgeMaxRate >= 0.0))
+    {
+        return Result(Result::InvalidArg, "ClientConfig::latestVersionHedgeMaxRate cannot be negative");
+    }
+
     out.reset();
     std::unique_ptr<SFSClient> tmp(new SFSClient());
-    tmp->m_impl = std::make_unique<details::SFSClientImpl<CurlConnectionManager>>(std::move(config));
+    if (config.useBackgroundTransferThread)
+    {
+        tmp->m_impl = std::make_unique<details::SFSClientImpl<CurlMultiConnectionManager>>(std::move(config));
+    }
+    else
+    {
+        tmp->m_impl = std::make_unique<details::SFSClientImpl<CurlConnectionManager>>(std::move(config));
+    }
     out = std::move(tmp);
 
     LOG_INFO(out->m_impl->GetReportingHandler(), "SFSClient instance created successfully. Version: %s", GetVersion());
@@ -52,6 +98,34 @@ try
 }
 SFS_CATCH_RETURN()
 
+Result SFSClient::GetLatestDownloadInfoAsync(const RequestParams& requestParams,
+                                             std::future<AsyncResult<std::vector<Content>>>& future) const noexcept
+try
+{
+    future = m_impl->GetExecutor().Submit([impl = m_impl.get(), requestParams]() {
+        return RunAsyncCall<std::vector<Content>>([&]() { return impl->GetLatestDownloadInfo(requestParams); });
+    });
+    return Result::Success;
+}
+SFS_CATCH_RETURN()
+
+Result SFSClient::GetLatestAppDownloadInfoAsync(
+    const RequestParams& requestParams,
+    std::future<AsyncResult<std::vector<AppContent>>>& future) const noexcept
+try
+{
+    future = m_impl->GetExecutor().Submit([impl = m_impl.get(), requestParams]() {
+        return RunAsyncCall<std::vector<AppContent>>([&]() { return impl->GetLatestAppDownloadInfo(requestParams); });
+    });
+    return Result::Success;
+}
+SFS_CATCH_RETURN()
+
+ClientStatistics SFSClient::GetStatistics() const noexcept
+{
+    return m_impl->GetStatistics();
+}
+
 const char* SFSClient::GetVersion() noexcept
 {
 #ifdef SFS_GIT_INFO
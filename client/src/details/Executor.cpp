@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "Executor.h"
+
+#include <algorithm>
+#include <exception>
+
+using namespace SFS::details;
+
+Executor::Executor(unsigned maxThreads) : m_maxThreads(std::max(maxThreads, 1u))
+{
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard guard(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void Executor::Post(std::function<void()> task)
+{
+    std::unique_lock lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+
+    if (m_idleThreads == 0 && m_threads.size() < m_maxThreads)
+    {
+        try
+        {
+            m_threads.emplace_back([this]() { RunWorker(); });
+        }
+        catch (...)
+        {
+            // Busy workers will get to the task eventually, but without any worker it would never run
+            if (m_threads.empty())
+            {
+                m_tasks.pop_back();
+                throw;
+            }
+        }
+        return;
+    }
+
+    lock.unlock();
+    m_cv.notify_one();
+}
+
+bool Executor::TryPost(std::function<void()> task)
+{
+    std::unique_lock lock(m_mutex);
+
+    // Each idle worker takes one of the queued tasks, so the task only runs right away if it finds one left for it
+    if (m_tasks.size() < m_idleThreads)
+    {
+        m_tasks.push_back(std::move(task));
+        lock.unlock();
+        m_cv.notify_one();
+        return true;
+    }
+
+    if (m_tasks.size() > m_idleThreads || m_threads.size() >= m_maxThreads)
+    {
+        return false;
+    }
+
+    m_tasks.push_back(std::move(task));
+    try
+    {
+        m_threads.emplace_back([this]() { RunWorker(); });
+    }
+    catch (...)
+    {
+        m_tasks.pop_back();
+        return false;
+    }
+    return true;
+}
+
+void Executor::ParallelFor(size_t count, size_t maxParallelism, const std::function<void(size_t)>& fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Shared with the helpers posted to the workers, since a helper may only start after this call has returned. It
+    // will then find no index left to claim, and never touch fn.
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        const std::function<void(size_t)>* fn;
+        size_t count;
+        size_t next{0};
+        size_t running{0};
+        std::exception_ptr error;
+    };
+
+    auto state = std::make_shared<State>();
+    state->fn = &fn;
+    state->count = count;
+
+    auto work = [state]() {
+        std::unique_lock lock(state->mutex);
+        while (!state->error && state->next < state->count)
+        {
+            const size_t index = state->next++;
+            ++state->running;
+            lock.unlock();
+
+            std::exception_ptr error;
+            try
+            {
+                (*state->fn)(index);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            if (error && !state->error)
+            {
+                state->error = error;
+            }
+            --state->running;
+            state->cv.notify_all();
+        }
+    };
+
+    const size_t parallelism = std::min({count, maxParallelism, static_cast<size_t>(m_maxThreads) + 1});
+    const size_t helperCount = parallelism > 0 ? parallelism - 1 : 0;
+    for (size_t i = 0; i < helperCount; ++i)
+    {
+        try
+        {
+            Post(work);
+        }
+        catch (...)
+        {
+            // The calling thread can still get through all of the work on its own
+            break;
+        }
+    }
+
+    work();
+
+    std::unique_lock lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->running == 0; });
+    if (state->error)
+    {
+        std::rethrow_exception(state->error);
+    }
+}
+
+void Executor::RunWorker()
+{
+    std::unique_lock lock(m_mutex);
+    while (true)
+    {
+        if (m_tasks.empty())
+        {
+            // Queued tasks are drained before stopping, so no posted task is ever dropped
+            if (m_stopping)
+            {
+                return;
+            }
+
+            ++m_idleThreads;
+            m_cv.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            --m_idleThreads;
+            continue;
+        }
+
+        auto task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
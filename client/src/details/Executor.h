@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace SFS::details
+{
+/**
+ * @brief Runs tasks on a bounded pool of worker threads
+ * @details Workers are only started when tasks are posted and no worker is idle, up to the maximum given on
+ * construction, so an Executor that is never used costs no threads. Tasks run in the order they were posted.
+ * This class is thread-safe.
+ */
+class Executor
+{
+  public:
+    /**
+     * @param maxThreads Maximum number of worker threads. At least one thread is always allowed.
+     */
+    explicit Executor(unsigned maxThreads);
+
+    /**
+     * @brief Runs all tasks still queued, then stops the worker threads
+     */
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * @brief Queues @param task to be run by a worker thread. The task must not throw.
+     * @throws std::system_error if no worker thread is available and none can be started
+     */
+    void Post(std::function<void()> task);
+
+    /**
+     * @brief Queues @param task only if a worker thread can run it right away, be it an idle worker or a new one
+     * @details Unlike with Post(), a caller can then wait for the task without risking to wait for the tasks queued
+     * before it, or for its own task to be run by the thread it is blocking. The task must not throw.
+     * @return False if all workers are busy and no more can be started, in which case the task is not queued
+     */
+    bool TryPost(std::function<void()> task);
+
+    /**
+     * @brief Queues @param fn to be run by a worker thread
+     * @return A future that receives the return value of fn, or the exception it threw
+     */
+    template <typename Fn>
+    auto Submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn>>
+    {
+        using ReturnT = std::invoke_result_t<Fn>;
+
+        // std::function requires a copyable callable, so the move-only packaged_task is shared instead
+        auto task = std::make_shared<std::packaged_task<ReturnT()>>(std::forward<Fn>(fn));
+        auto future = task->get_future();
+        Post([task]() { (*task)(); });
+        return future;
+    }
+
+    /**
+     * @brief Calls @param fn for every index in [0, @param count), spreading the calls over the calling thread and up
+     * to @param maxParallelism - 1 worker threads
+     * @details The calling thread takes part in the work instead of only waiting for the workers, so this completes
+     * even when all workers are busy, and it can be safely called from a task running on this Executor.
+     * Once a call throws, no new calls are started, and the first exception is rethrown after the running calls end.
+     */
+    void ParallelFor(size_t count, size_t maxParallelism, const std::function<void(size_t)>& fn);
+
+  private:
+    void RunWorker();
+
+    const unsigned m_maxThreads;
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    unsigned m_idleThreads{0};
+    bool m_stopping{false};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+} // namespace SFS::details
@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "LatestVersionBatcher.h"
+
+#include "ReportingHandler.h"
+#include "SFSException.h"
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <unordered_map>
+
+using namespace SFS;
+using namespace SFS::details;
+
+struct LatestVersionBatcher::Batch
+{
+    std::vector<ProductRequest> requests;
+    std::vector<std::promise<std::shared_ptr<const VersionEntity>>> promises;
+    bool isClosed{false};
+};
+
+LatestVersionBatcher::LatestVersionBatcher(std::chrono::milliseconds window,
+                                           size_t maxBatchSize,
+                                           const ReportingHandler& handler)
+    : m_window(window)
+    , m_maxBatchSize(std::max<size_t>(maxBatchSize, 1))
+    , m_handler(handler)
+{
+}
+
+std::unique_ptr<VersionEntity> LatestVersionBatcher::GetLatestVersion(const ProductRequest& productRequest,
+                                                                      const SendBatchFn& sendBatch)
+{
+    return GetLatestVersion(productRequest, sendBatch, [](const std::exception_ptr&) { return true; });
+}
+
+std::unique_ptr<VersionEntity> LatestVersionBatcher::GetLatestVersion(const ProductRequest& productRequest,
+                                                                      const SendBatchFn& sendBatch,
+                                                                      const IsSharedErrorFn& isSharedError)
+{
+    while (true)
+    {
+        try
+        {
+            return JoinBatch(productRequest, sendBatch, isSharedError);
+        }
+        catch (const UnsharedError&)
+        {
+            LOG_INFO(m_handler,
+                     "The batch of [%s] failed for a reason specific to its sender. Joining the next batch",
+                     productRequest.product.c_str());
+        }
+    }
+}
+
+std::unique_ptr<VersionEntity> LatestVersionBatcher::JoinBatch(const ProductRequest& productRequest,
+                                                               const SendBatchFn& sendBatch,
+                                                               const IsSharedErrorFn& isSharedError)
+{
+    std::shared_ptr<Batch> batch;
+    std::future<std::shared_ptr<const VersionEntity>> result;
+    bool isSender = false;
+    {
+        std::unique_lock lock(m_mutex);
+
+        auto closeBatch = [this](Batch& batchToClose) {
+            batchToClose.isClosed = true;
+            if (m_openBatch.get() == &batchToClose)
+            {
+                m_openBatch.reset();
+            }
+            m_batchClosed.notify_all();
+        };
+
+        // The service returns each product once, so another lookup of the same product has to go in the next batch
+        if (m_openBatch && std::any_of(m_openBatch->requests.begin(),
+                                       m_openBatch->requests.end(),
+                                       [&](const ProductRequest& request) {
+                                           return request.product == productRequest.product;
+                                       }))
+        {
+            closeBatch(*m_openBatch);
+        }
+
+        if (!m_openBatch)
+        {
+            m_openBatch = std::make_shared<Batch>();
+            isSender = true;
+        }
+
+        batch = m_openBatch;
+        batch->requests.push_back(productRequest);
+        batch->promises.emplace_back();
+        result = batch->promises.back().get_future();
+
+        if (batch->requests.size() >= m_maxBatchSize)
+        {
+            closeBatch(*batch);
+        }
+
+        if (isSender)
+        {
+            m_batchClosed.wait_for(lock, m_window, [&batch]() { return batch->isClosed; });
+            closeBatch(*batch);
+        }
+    }
+
+    // Once closed, a batch is no longer changed by other threads
+    if (isSender)
+    {
+        Send(*batch, sendBatch, isSharedError);
+    }
+
+    return result.get()->Clone();
+}
+
+uint64_t LatestVersionBatcher::GetBatchCount() const
+{
+    return m_batchCount;
+}
+
+uint64_t LatestVersionBatcher::GetBatchedLookupCount() const
+{
+    return m_batchedLookupCount;
+}
+
+void LatestVersionBatcher::Send(Batch& batch, const SendBatchFn& sendBatch, const IsSharedErrorFn& isSharedError)
+{
+    LOG_INFO(m_handler, "Sending a batch of %zu latest version lookups", batch.requests.size());
+    ++m_batchCount;
+    m_batchedLookupCount += batch.requests.size();
+
+    VersionEntities entities;
+    try
+    {
+        entities = sendBatch(batch.requests);
+    }
+    catch (...)
+    {
+        // The sender is the first lookup of the batch
+        const auto error = std::current_exception();
+        const auto othersError = isSharedError(error) ? error : std::make_exception_ptr(UnsharedError{});
+        for (size_t i = 0; i < batch.promises.size(); ++i)
+        {
+            batch.promises[i].set_exception(i == 0 ? error : othersError);
+        }
+        return;
+    }
+
+    std::unordered_map<std::string, std::shared_ptr<const VersionEntity>> entitiesByProduct;
+    for (auto& entity : entities)
+    {
+        const std::string product = entity->contentId.name;
+        entitiesByProduct.emplace(product, std::move(entity));
+    }
+
+    for (size_t i = 0; i < batch.requests.size(); ++i)
+    {
+        const auto& product = batch.requests[i].product;
+        auto it = entitiesByProduct.find(product);
+        if (it == entitiesByProduct.end())
+        {
+            LOG_WARNING(m_handler, "Product [%s] was not found by the service", product.c_str());
+            batch.promises[i].set_exception(std::make_exception_ptr(
+                SFSException(Result::HttpNotFound, "Product [" + product + "] was not found by the service")));
+            continue;
+        }
+        batch.promises[i].set_value(it->second);
+    }
+}
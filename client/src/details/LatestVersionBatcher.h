@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "RequestParams.h"
+#include "entity/VersionEntity.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SFS::details
+{
+class ReportingHandler;
+
+/**
+ * @brief Groups latest version lookups of single products made around the same time into batch requests
+ * @details The first lookup to arrive opens a batch, and waits for other lookups to join it until the window ends or
+ * the batch is full. It then sends the batch from its own thread, and hands each waiting lookup the entity of its
+ * product. A batch holds at most one lookup per product, as the entities returned by the service are matched to the
+ * lookups by product name. This class is thread-safe.
+ */
+class LatestVersionBatcher
+{
+  public:
+    using SendBatchFn = std::function<VersionEntities(const std::vector<ProductRequest>&)>;
+    using IsSharedErrorFn = std::function<bool(const std::exception_ptr&)>;
+
+    /**
+     * @param window Time the first lookup of a batch waits for others to join it
+     * @param maxBatchSize Number of lookups that make a batch full, so that it is sent without waiting any longer
+     */
+    LatestVersionBatcher(std::chrono::milliseconds window, size_t maxBatchSize, const ReportingHandler& handler);
+
+    LatestVersionBatcher(const LatestVersionBatcher&) = delete;
+    LatestVersionBatcher& operator=(const LatestVersionBatcher&) = delete;
+
+    /**
+     * @brief Adds @param productRequest to the open batch and waits for its entity
+     * @param sendBatch Sends a batch to the service. Only called if this lookup is the one that sends the batch.
+     * @throws SFSException with HttpNotFound if the service did not return the product, or the error that failed the
+     * whole batch
+     */
+    std::unique_ptr<VersionEntity> GetLatestVersion(const ProductRequest& productRequest, const SendBatchFn& sendBatch);
+
+    /**
+     * @brief Like GetLatestVersion(productRequest, sendBatch), but only hands the errors of a batch for which
+     * @param isSharedError returns true to the other lookups of the batch
+     * @details The functions of the lookup that sends the batch are used. Other errors are specific to that lookup,
+     * such as its request being cancelled, so only that lookup fails with them, and the other lookups of the batch
+     * join the next batch instead.
+     */
+    std::unique_ptr<VersionEntity> GetLatestVersion(const ProductRequest& productRequest,
+                                                    const SendBatchFn& sendBatch,
+                                                    const IsSharedErrorFn& isSharedError);
+
+    /// @brief Number of batch requests sent
+    uint64_t GetBatchCount() const;
+
+    /// @brief Number of lookups sent as part of a batch request
+    uint64_t GetBatchedLookupCount() const;
+
+  private:
+    struct Batch;
+
+    /// @brief Handed to the other lookups of a batch instead of an error that is not shared, so they join another one
+    struct UnsharedError
+    {
+    };
+
+    /**
+     * @brief Adds @param productRequest to the open batch, sends it if this lookup opened it, and waits for its entity
+     * @throws UnsharedError if the batch failed with an error of its sender that is not shared
+     */
+    std::unique_ptr<VersionEntity> JoinBatch(const ProductRequest& productRequest,
+                                             const SendBatchFn& sendBatch,
+                                             const IsSharedErrorFn& isSharedError);
+
+    void Send(Batch& batch, const SendBatchFn& sendBatch, const IsSharedErrorFn& isSharedError);
+
+    const std::chrono::milliseconds m_window;
+    const size_t m_maxBatchSize;
+    const ReportingHandler& m_handler;
+
+    std::mutex m_mutex;
+    std::condition_variable m_batchClosed;
+
+    // Batch that new lookups join, if any. It is closed once it is full or its window ends.
+    std::shared_ptr<Batch> m_openBatch;
+
+    std::atomic<uint64_t> m_batchCount{0};
+    std::atomic<uint64_t> m_batchedLookupCount{0};
+};
+} // namespace SFS::details
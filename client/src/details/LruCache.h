@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "ClientStatistics.h"
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace SFS::details
+{
+/**
+ * @brief Size-bounded least-recently-used cache whose entries expire after a time to live
+ * @details Once full, inserting a new entry evicts the least recently used one. Expired entries are dropped when they
+ * are looked up. Values are returned by copy, so they should be cheap to copy, such as a std::shared_ptr to const data.
+ * This class is thread-safe.
+ */
+template <typename ValueT>
+class LruCache
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param maxEntries Maximum number of entries held. A cache with no entries never stores anything.
+     * @param ttl Time an entry can be returned after being inserted
+     */
+    LruCache(size_t maxEntries, Clock::duration ttl) : m_maxEntries(maxEntries), m_ttl(ttl)
+    {
+    }
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    struct Lookup
+    {
+        ValueT value;
+
+        /// @brief Whether the value has expired, and should be refreshed by the caller
+        bool isStale;
+    };
+
+    /**
+     * @return The value stored for @param key, or std::nullopt if there is none or it has expired
+     */
+    std::optional<ValueT> Get(const std::string& key)
+    {
+        auto lookup = GetAllowingStale(key, Clock::duration::zero());
+        if (!lookup)
+        {
+            return std::nullopt;
+        }
+        return std::move(lookup->value);
+    }
+
+    /**
+     * @brief Like Get(), but also returns a value that expired less than @param maxStaleness ago, flagged as stale
+     * @details Values that expired before that are dropped.
+     */
+    std::optional<Lookup> GetAllowingStale(const std::string& key, Clock::duration maxStaleness)
+    {
+        std::lock_guard guard(m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+        {
+            ++m_statistics.misses;
+            return std::nullopt;
+        }
+
+        auto entryIt = it->second;
+        const auto now = Clock::now();
+        if (now >= entryIt->expiresAt + maxStaleness)
+        {
+            m_entries.erase(entryIt);
+            m_index.erase(it);
+            ++m_statistics.misses;
+            return std::nullopt;
+        }
+
+        // Most recently used entries are kept at the front
+        m_entries.splice(m_entries.begin(), m_entries, entryIt);
+        ++m_statistics.hits;
+
+        const bool isStale = now >= entryIt->expiresAt;
+        if (isStale)
+        {
+            ++m_statistics.staleHits;
+        }
+        return Lookup{entryIt->value, isStale};
+    }
+
+    /**
+     * @brief Stores @param value for @param key, replacing any previous value
+     */
+    void Put(const std::string& key, ValueT value)
+    {
+        Put(key, std::move(value), Clock::now() + m_ttl);
+    }
+
+    /**
+     * @brief Stores @param value for @param key until @param expiresAt, replacing any previous value
+     */
+    void Put(const std::string& key, ValueT value, Clock::time_point expiresAt)
+    {
+        if (m_maxEntries == 0)
+        {
+            return;
+        }
+
+        std::lock_guard guard(m_mutex);
+        if (auto it = m_index.find(key); it != m_index.end())
+        {
+            it->second->value = std::move(value);
+            it->second->expiresAt = expiresAt;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return;
+        }
+
+        if (m_entries.size() >= m_maxEntries)
+        {
+            m_index.erase(m_entries.back().key);
+            m_entries.pop_back();
+            ++m_statistics.evictions;
+        }
+
+        m_entries.push_front({key, std::move(value), expiresAt});
+        m_index.emplace(key, m_entries.begin());
+    }
+
+    /**
+     * @brief Calls @param fn with the value stored for @param key, if any, so it can be modified in place
+     * @details The entry keeps its expiry and its place in the eviction order. @param fn is called under the lock of
+     * the cache, so it should be quick and must not use the cache.
+     */
+    template <typename Fn>
+    void Update(const std::string& key, Fn&& fn)
+    {
+        std::lock_guard guard(m_mutex);
+        if (auto it = m_index.find(key); it != m_index.end())
+        {
+            std::forward<Fn>(fn)(it->second->value);
+        }
+    }
+
+    /**
+     * @brief Removes the value stored for @param key, if any
+     */
+    void Remove(const std::string& key)
+    {
+        std::lock_guard guard(m_mutex);
+        if (auto it = m_index.find(key); it != m_index.end())
+        {
+            m_entries.erase(it->second);
+            m_index.erase(it);
+        }
+    }
+
+    CacheStatistics GetStatistics() const
+    {
+        std::lock_guard guard(m_mutex);
+        CacheStatistics statistics = m_statistics;
+        statistics.entries = m_entries.size();
+        return statistics;
+    }
+
+  private:
+    struct Entry
+    {
+        std::string key;
+        ValueT value;
+        Clock::time_point expiresAt;
+    };
+
+    const size_t m_maxEntries;
+    const Clock::duration m_ttl;
+
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> m_index;
+    CacheStatistics m_statistics;
+
+    mutable std::mutex m_mutex;
+};
+} // namespace SFS::details
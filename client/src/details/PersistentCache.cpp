@@ -0,0 +1,403 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "PersistentCache.h"
+
+#include "ReportingHandler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace SFS;
+using namespace SFS::details;
+
+namespace
+{
+constexpr char c_magic[] = {'S', 'F', 'S', 'C'};
+constexpr uint32_t c_formatVersion = 1;
+constexpr size_t c_headerSize = 16;
+constexpr size_t c_entryHeaderSize = 24;
+constexpr size_t c_alignment = 8;
+
+// Time the background thread waits after an entry is put, so that the entries put meanwhile are written with it
+constexpr std::chrono::seconds c_flushDelay{1};
+
+size_t PaddingFor(size_t size)
+{
+    return (c_alignment - size % c_alignment) % c_alignment;
+}
+
+void AppendUint32(std::string& buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void AppendInt64(std::string& buffer, int64_t value)
+{
+    const auto unsignedValue = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; ++i)
+    {
+        buffer += static_cast<char>((unsignedValue >> (8 * i)) & 0xFF);
+    }
+}
+
+uint32_t ReadUint32(const char* data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+int64_t ReadInt64(const char* data)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return static_cast<int64_t>(value);
+}
+
+int64_t ToEpochSeconds(PersistentCache::Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+// Whether @param seconds since the epoch fit in a time point of the clock, leaving room for the staleness added to it.
+// Timestamps come straight from the file, and converting an out-of-range one would overflow
+bool IsValidEpochSeconds(int64_t seconds)
+{
+    constexpr int64_t maxSeconds =
+        std::chrono::duration_cast<std::chrono::seconds>(PersistentCache::Clock::duration::max()).count() / 2;
+    return seconds >= -maxSeconds && seconds <= maxSeconds;
+}
+
+PersistentCache::Clock::time_point FromEpochSeconds(int64_t seconds)
+{
+    return PersistentCache::Clock::time_point(
+        std::chrono::duration_cast<PersistentCache::Clock::duration>(std::chrono::seconds(seconds)));
+}
+
+std::filesystem::path MakeTemporaryPath(const std::filesystem::path& filePath)
+{
+    // Unique across the threads and processes that may be writing the file at the same time
+    const size_t suffix = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                          static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::filesystem::path temporaryPath = filePath;
+    temporaryPath += ".tmp" + std::to_string(suffix);
+    return temporaryPath;
+}
+} // namespace
+
+PersistentCache::PersistentCache(std::filesystem::path filePath,
+                                 size_t maxEntries,
+                                 Clock::duration retention,
+                                 const ReportingHandler& handler)
+    : m_filePath(std::move(filePath))
+    , m_maxEntries(maxEntries)
+    , m_retention(retention)
+    , m_handler(handler)
+{
+}
+
+PersistentCache::~PersistentCache()
+{
+    {
+        std::lock_guard guard(m_mutex);
+        m_stopping = true;
+    }
+    m_flushCondition.notify_all();
+    if (m_flushThread.joinable())
+    {
+        m_flushThread.join();
+    }
+
+    Flush();
+}
+
+std::optional<PersistentCache::Entry> PersistentCache::Get(const std::string& key)
+{
+    std::lock_guard guard(m_mutex);
+    Load();
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        ++m_statistics.misses;
+        return std::nullopt;
+    }
+
+    ++m_statistics.hits;
+    return it->second;
+}
+
+void PersistentCache::Put(const std::string& key, std::string value, Clock::time_point expiresAt)
+{
+    if (m_maxEntries == 0 || key.size() > std::numeric_limits<uint32_t>::max() ||
+        value.size() > std::numeric_limits<uint32_t>::max())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard guard(m_mutex);
+        Load();
+
+        m_entries[key] = Entry{std::move(value), Clock::now(), expiresAt};
+        if (m_entries.size() > m_maxEntries)
+        {
+            m_statistics.evictions += Trim(m_entries);
+        }
+        m_dirty = true;
+
+        if (!m_flushThread.joinable())
+        {
+            m_flushThread = std::thread([this]() { RunFlushes(); });
+        }
+    }
+    m_flushCondition.notify_all();
+}
+
+void PersistentCache::Flush()
+{
+    std::lock_guard flushGuard(m_flushMutex);
+
+    Entries entries;
+    {
+        std::lock_guard guard(m_mutex);
+        if (!m_dirty)
+        {
+            return;
+        }
+        entries = m_entries;
+        m_dirty = false;
+    }
+
+    // The file is read and written without holding m_mutex, so lookups and Put() calls never wait for it. Entries
+    // written by other processes since the file was read are kept, unless this process has a newer one.
+    Entries fileEntries = ReadFile();
+    for (auto& [key, entry] : entries)
+    {
+        auto it = fileEntries.find(key);
+        if (it == fileEntries.end() || it->second.storedAt < entry.storedAt)
+        {
+            fileEntries[key] = std::move(entry);
+        }
+    }
+    Trim(fileEntries);
+    WriteFile(fileEntries);
+
+    // Entries of other processes are picked up, and those put since the snapshot are kept
+    std::lock_guard guard(m_mutex);
+    for (auto& [key, entry] : fileEntries)
+    {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end() || it->second.storedAt < entry.storedAt)
+        {
+            m_entries[key] = std::move(entry);
+        }
+    }
+    m_statistics.evictions += Trim(m_entries);
+}
+
+CacheStatistics PersistentCache::GetStatistics() const
+{
+    std::lock_guard guard(m_mutex);
+    CacheStatistics statistics = m_statistics;
+    statistics.entries = m_entries.size();
+    return statistics;
+}
+
+void PersistentCache::Load()
+{
+    if (m_loaded)
+    {
+        return;
+    }
+
+    m_entries = ReadFile();
+    m_loaded = true;
+    LOG_INFO(m_handler, "Loaded %zu entries from cache file [%s]", m_entries.size(), m_filePath.u8string().c_str());
+}
+
+void PersistentCache::RunFlushes()
+{
+    std::unique_lock lock(m_mutex);
+    while (true)
+    {
+        m_flushCondition.wait(lock, [this]() { return m_dirty || m_stopping; });
+        if (m_stopping)
+        {
+            // The destructor writes the remaining entries
+            return;
+        }
+
+        m_flushCondition.wait_for(lock, c_flushDelay, [this]() { return m_stopping; });
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+PersistentCache::Entries PersistentCache::ReadFile() const
+{
+    std::ifstream file(m_filePath, std::ios::binary);
+    if (!file)
+    {
+        return {};
+    }
+
+    const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+    auto ignoreFile = [&](const char* reason) {
+        LOG_WARNING(m_handler, "Ignoring cache file [%s]: %s", m_filePath.u8string().c_str(), reason);
+        return Entries{};
+    };
+
+    if (data.size() < c_headerSize || !std::equal(std::begin(c_magic), std::end(c_magic), data.begin()))
+    {
+        return ignoreFile("not a cache file");
+    }
+    if (ReadUint32(data.data() + 4) != c_formatVersion)
+    {
+        return ignoreFile("unsupported format version");
+    }
+
+    const uint32_t entryCount = ReadUint32(data.data() + 8);
+
+    Entries entries;
+    size_t offset = c_headerSize;
+    for (uint32_t i = 0; i < entryCount; ++i)
+    {
+        if (data.size() - offset < c_entryHeaderSize)
+        {
+            return ignoreFile("truncated entry");
+        }
+
+        const char* entryData = data.data() + offset;
+        const size_t keySize = ReadUint32(entryData);
+        const size_t valueSize = ReadUint32(entryData + 4);
+        const int64_t storedAt = ReadInt64(entryData + 8);
+        const int64_t expiresAt = ReadInt64(entryData + 16);
+        offset += c_entryHeaderSize;
+
+        const size_t dataSize = keySize + valueSize;
+        if (data.size() - offset < dataSize + PaddingFor(dataSize))
+        {
+            return ignoreFile("truncated entry");
+        }
+
+        if (!IsValidEpochSeconds(storedAt) || !IsValidEpochSeconds(expiresAt))
+        {
+            LOG_WARNING(m_handler,
+                        "Ignoring an entry of cache file [%s] with an invalid timestamp",
+                        m_filePath.u8string().c_str());
+            offset += dataSize + PaddingFor(dataSize);
+            continue;
+        }
+
+        entries[data.substr(offset, keySize)] =
+            Entry{data.substr(offset + keySize, valueSize), FromEpochSeconds(storedAt), FromEpochSeconds(expiresAt)};
+        offset += dataSize + PaddingFor(dataSize);
+    }
+
+    return entries;
+}
+
+void PersistentCache::WriteFile(const Entries& entries) const
+{
+    std::string data(std::begin(c_magic), std::end(c_magic));
+    AppendUint32(data, c_formatVersion);
+    AppendUint32(data, static_cast<uint32_t>(entries.size()));
+    AppendUint32(data, 0);
+
+    for (const auto& [key, entry] : entries)
+    {
+        AppendUint32(data, static_cast<uint32_t>(key.size()));
+        AppendUint32(data, static_cast<uint32_t>(entry.value.size()));
+        AppendInt64(data, ToEpochSeconds(entry.storedAt));
+        AppendInt64(data, ToEpochSeconds(entry.expiresAt));
+        data += key;
+        data += entry.value;
+        data.append(PaddingFor(key.size() + entry.value.size()), '\0');
+    }
+
+    std::error_code error;
+    if (m_filePath.has_parent_path())
+    {
+        std::filesystem::create_directories(m_filePath.parent_path(), error);
+    }
+
+    const std::filesystem::path temporaryPath = MakeTemporaryPath(m_filePath);
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file)
+        {
+            LOG_WARNING(m_handler, "Failed to write cache file [%s]", temporaryPath.u8string().c_str());
+            file.close();
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    // Renaming is atomic, so other processes either read the previous file or the new one, never a partial one
+    std::filesystem::rename(temporaryPath, m_filePath, error);
+    if (error)
+    {
+        LOG_WARNING(m_handler,
+                    "Failed to replace cache file [%s]: %s",
+                    m_filePath.u8string().c_str(),
+                    error.message().c_str());
+        std::filesystem::remove(temporaryPath, error);
+    }
+}
+
+size_t PersistentCache::Trim(Entries& entries) const
+{
+    const auto now = Clock::now();
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.expiresAt + m_retention <= now)
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (entries.size() <= m_maxEntries)
+    {
+        return 0;
+    }
+
+    std::vector<Entries::const_iterator> byAge;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        byAge.push_back(it);
+    }
+    std::sort(byAge.begin(), byAge.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs->second.storedAt < rhs->second.storedAt;
+    });
+
+    const size_t excess = entries.size() - m_maxEntries;
+    for (size_t i = 0; i < excess; ++i)
+    {
+        entries.erase(byAge[i]);
+    }
+    return excess;
+}
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "ClientStatistics.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace SFS::details
+{
+class ReportingHandler;
+
+/**
+ * @brief Key-value store of service responses kept in a file, so that they outlive the process
+ * @details The file is only read the first time an entry is needed, and the entries in memory are the ones served from
+ * then on. Put() only updates them, and a background thread writes the entries put during the last second to the file
+ * together, so that a burst of responses is written once and callers never wait for the file. Remaining entries are
+ * written when the cache is destroyed.
+ *
+ * The file can be shared by multiple processes: every write merges the entries currently in the file with the ones
+ * in memory, writes them to a temporary file and renames it over the original, so readers always see a complete file.
+ * Entries written by other processes are picked up at the same time. If processes race to update it, the last one
+ * wins, which at worst drops a few entries. I/O errors and corrupted files are logged and treated as an empty cache.
+ *
+ * The file is a compact binary format that can be memory-mapped and read in place. All integers are little-endian, and
+ * every entry starts at an 8-byte boundary:
+ *   - Header: "SFSC", uint32 format version, uint32 entry count, uint32 reserved
+ *   - Entry: uint32 key size, uint32 value size, int64 stored at, int64 expires at (both in seconds since the Unix
+ *     epoch), followed by the key and the value, padded with zeroes to the next 8-byte boundary
+ *
+ * This class is thread-safe.
+ */
+class PersistentCache
+{
+  public:
+    using Clock = std::chrono::system_clock;
+
+    struct Entry
+    {
+        std::string value;
+        Clock::time_point storedAt;
+        Clock::time_point expiresAt;
+    };
+
+    /**
+     * @param filePath File the entries are stored in. Its directory is created if it does not exist.
+     * @param maxEntries Maximum number of entries kept in the file. The oldest ones are dropped first.
+     * @param retention Time an entry is kept in the file after it expires, so it can still be used as a stale answer
+     */
+    PersistentCache(std::filesystem::path filePath,
+                    size_t maxEntries,
+                    Clock::duration retention,
+                    const ReportingHandler& handler);
+
+    ~PersistentCache();
+
+    PersistentCache(const PersistentCache&) = delete;
+    PersistentCache& operator=(const PersistentCache&) = delete;
+
+    /**
+     * @return The entry stored for @param key, expired or not, or std::nullopt if there is none
+     */
+    std::optional<Entry> Get(const std::string& key);
+
+    /**
+     * @brief Stores @param value for @param key. It is written to the file in the background.
+     */
+    void Put(const std::string& key, std::string value, Clock::time_point expiresAt);
+
+    /**
+     * @brief Writes the entries put since the last write to the file right away
+     */
+    void Flush();
+
+    /**
+     * @return A snapshot of the counters of the cache
+     */
+    CacheStatistics GetStatistics() const;
+
+  private:
+    using Entries = std::unordered_map<std::string, Entry>;
+
+    // Reads the file the first time it is needed. Must be called with m_mutex held.
+    void Load();
+
+    // Body of m_flushThread
+    void RunFlushes();
+
+    Entries ReadFile() const;
+    void WriteFile(const Entries& entries) const;
+
+    // Drops the entries past their retention, then the oldest ones beyond m_maxEntries
+    // @return The number of entries dropped beyond m_maxEntries
+    size_t Trim(Entries& entries) const;
+
+    const std::filesystem::path m_filePath;
+    const size_t m_maxEntries;
+    const Clock::duration m_retention;
+    const ReportingHandler& m_handler;
+
+    mutable std::mutex m_mutex;
+    bool m_loaded{false};
+    Entries m_entries;
+    CacheStatistics m_statistics;
+
+    // Set when an entry was put since the last write
+    bool m_dirty{false};
+
+    // Writes to the file are made one at a time
+    std::mutex m_flushMutex;
+
+    // Started by the first Put(), so that caches that are only read never start it
+    std::thread m_flushThread;
+    std::condition_variable m_flushCondition;
+    bool m_stopping{false};
+};
+} // namespace SFS::details
@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "RequestBody.h"
+
+#include "ErrorHandling.h"
+#include "ReportingHandler.h"
+
+using namespace SFS;
+using namespace SFS::details;
+
+namespace
+{
+// Returns the length of the UTF-8 sequence @param str starts with, or 0 if it does not start with a valid one
+size_t GetUtf8SequenceLength(std::string_view str)
+{
+    const auto byteAt = [&str](size_t i) { return static_cast<unsigned char>(str[i]); };
+
+    const unsigned char lead = byteAt(0);
+    if (lead < 0x80)
+    {
+        return 1;
+    }
+
+    // Bounds of the second byte, which exclude overlong forms, surrogates and code points above U+10FFFF
+    size_t length = 0;
+    unsigned char min = 0x80;
+    unsigned char max = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        min = lead == 0xE0 ? 0xA0 : min;
+        max = lead == 0xED ? 0x9F : max;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        min = lead == 0xF0 ? 0x90 : min;
+        max = lead == 0xF4 ? 0x8F : max;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (str.size() < length || byteAt(1) < min || byteAt(1) > max)
+    {
+        return 0;
+    }
+    for (size_t i = 2; i < length; ++i)
+    {
+        if (byteAt(i) < 0x80 || byteAt(i) > 0xBF)
+        {
+            return 0;
+        }
+    }
+    return length;
+}
+
+void AppendTargetingAttributes(const TargetingAttributes& attributes,
+                               std::string& body,
+                               const ReportingHandler& handler)
+{
+    body += '{';
+    bool isFirst = true;
+    for (const auto& [name, value] : attributes)
+    {
+        if (!isFirst)
+        {
+            body += ',';
+        }
+        isFirst = false;
+
+        AppendJsonString(name, body, handler);
+        body += ':';
+        AppendJsonString(value, body, handler);
+    }
+    body += '}';
+}
+} // namespace
+
+void SFS::details::WriteLatestVersionRequestBody(const TargetingAttributes& attributes,
+                                                 std::string& body,
+                                                 const ReportingHandler& handler)
+{
+    body.clear();
+    body += R"({"TargetingAttributes":)";
+    AppendTargetingAttributes(attributes, body, handler);
+    body += '}';
+}
+
+void SFS::details::WriteLatestVersionBatchRequestBody(const std::vector<ProductRequest>& requests,
+                                                      std::string& body,
+                                                      const ReportingHandler& handler)
+{
+    body.clear();
+    body += '[';
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        if (i > 0)
+        {
+            body += ',';
+        }
+        body += R"({"TargetingAttributes":)";
+        AppendTargetingAttributes(requests[i].attributes, body, handler);
+        body += R"(,"Product":)";
+        AppendJsonString(requests[i].product, body, handler);
+        body += '}';
+    }
+    body += ']';
+}
+
+void SFS::details::AppendJsonString(std::string_view value, std::string& body, const ReportingHandler& handler)
+{
+    static constexpr char c_hexDigits[] = "0123456789abcdef";
+
+    body += '"';
+    size_t i = 0;
+    while (i < value.size())
+    {
+        const auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x80)
+        {
+            const size_t length = GetUtf8SequenceLength(value.substr(i));
+            THROW_CODE_IF_LOG(InvalidArg, length == 0, handler, "Request body string is not valid UTF-8");
+            body.append(value, i, length);
+            i += length;
+            continue;
+        }
+
+        switch (c)
+        {
+        case '"':
+            body += "\\\"";
+            break;
+        case '\\':
+            body += "\\\\";
+            break;
+        case '\b':
+            body += "\\b";
+            break;
+        case '\f':
+            body += "\\f";
+            break;
+        case '\n':
+            body += "\\n";
+            break;
+        case '\r':
+            body += "\\r";
+            break;
+        case '\t':
+            body += "\\t";
+            break;
+        default:
+            if (c < 0x20)
+            {
+                body += "\\u00";
+                body += c_hexDigits[c >> 4];
+                body += c_hexDigits[c & 0xF];
+            }
+            else
+            {
+                body += static_cast<char>(c);
+            }
+            break;
+        }
+        ++i;
+    }
+    body += '"';
+}
@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "RequestParams.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SFS::details
+{
+class ReportingHandler;
+
+/**
+ * @brief Writes the JSON body of a latest version request for @param attributes into @param body
+ * @details The body is {"TargetingAttributes":{...}}. The previous contents of @param body are replaced, but its
+ * capacity is kept, so writing bodies into the same string does not allocate once it is large enough.
+ * @throws SFSException with InvalidArg if an attribute is not valid UTF-8
+ */
+void WriteLatestVersionRequestBody(const TargetingAttributes& attributes,
+                                   std::string& body,
+                                   const ReportingHandler& handler);
+
+/**
+ * @brief Writes the JSON body of a latest version batch request for @param requests into @param body
+ * @details The body is [{"TargetingAttributes":{...},"Product":"..."},...]. The previous contents of @param body are
+ * replaced, but its capacity is kept.
+ * @throws SFSException with InvalidArg if a product or an attribute is not valid UTF-8
+ */
+void WriteLatestVersionBatchRequestBody(const std::vector<ProductRequest>& requests,
+                                        std::string& body,
+                                        const ReportingHandler& handler);
+
+/**
+ * @brief Appends @param value to @param body as a JSON string, escaped like nlohmann::json::dump() does
+ * @throws SFSException with InvalidArg if @param value is not valid UTF-8
+ */
+void AppendJsonString(std::string_view value, std::string& body, const ReportingHandler& handler);
+} // namespace SFS::details
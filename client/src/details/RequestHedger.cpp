@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "RequestHedger.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SFS::details;
+using namespace std::chrono;
+
+namespace
+{
+// Number of latencies the hedge delay is computed from
+constexpr size_t c_maxLatencies = 100;
+
+// Requests are not hedged until this many latencies are known, as the percentile of fewer ones means little
+constexpr size_t c_minLatencies = 20;
+
+// Number of hedges the budget holds at most, which bounds the burst of hedges after a quiet period
+constexpr double c_maxTokens = 10.0;
+} // namespace
+
+RequestHedger::RequestHedger(double percentile, double maxHedgeRate)
+    : m_percentile(percentile)
+    , m_maxHedgeRate(maxHedgeRate)
+{
+    m_latencies.reserve(c_maxLatencies);
+}
+
+std::optional<milliseconds> RequestHedger::OnRequest()
+{
+    std::lock_guard guard(m_mutex);
+    m_tokens = std::min(m_tokens + m_maxHedgeRate, c_maxTokens);
+
+    if (m_latencies.size() < c_minLatencies || m_tokens < 1.0)
+    {
+        return std::nullopt;
+    }
+
+    // Nearest-rank percentile
+    auto latencies = m_latencies;
+    const auto rank = static_cast<size_t>(std::ceil(m_percentile * static_cast<double>(latencies.size())));
+    const auto nth = latencies.begin() + (std::max<size_t>(rank, 1) - 1);
+    std::nth_element(latencies.begin(), nth, latencies.end());
+    return *nth;
+}
+
+bool RequestHedger::TryHedge()
+{
+    std::lock_guard guard(m_mutex);
+    if (m_tokens < 1.0)
+    {
+        return false;
+    }
+
+    m_tokens -= 1.0;
+    ++m_hedges;
+    return true;
+}
+
+void RequestHedger::RecordLatency(milliseconds latency)
+{
+    std::lock_guard guard(m_mutex);
+    if (m_latencies.size() < c_maxLatencies)
+    {
+        m_latencies.push_back(latency);
+    }
+    else
+    {
+        m_latencies[m_nextLatency] = latency;
+    }
+    m_nextLatency = (m_nextLatency + 1) % c_maxLatencies;
+}
+
+void RequestHedger::OnHedgeWon()
+{
+    std::lock_guard guard(m_mutex);
+    ++m_hedgeWins;
+}
+
+uint64_t RequestHedger::GetHedgeCount() const
+{
+    std::lock_guard guard(m_mutex);
+    return m_hedges;
+}
+
+uint64_t RequestHedger::GetHedgeWinCount() const
+{
+    std::lock_guard guard(m_mutex);
+    return m_hedgeWins;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace SFS::details
+{
+/**
+ * @brief Decides when a request that is slow to answer is sent again, so that the first of the two responses is used
+ * @details The hedge delay is a percentile of the latencies of the last requests, so only the slowest requests are
+ * hedged. Hedges are bounded by a token bucket: every request adds @param maxHedgeRate of a token, and every hedge
+ * takes a whole one, so that hedges can not exceed that fraction of the requests. This class is thread-safe.
+ */
+class RequestHedger
+{
+  public:
+    /**
+     * @param percentile Percentile of the recent latencies, in (0, 1], after which requests are hedged
+     * @param maxHedgeRate Fraction of the requests that can be hedged
+     */
+    RequestHedger(double percentile, double maxHedgeRate);
+
+    RequestHedger(const RequestHedger&) = delete;
+    RequestHedger& operator=(const RequestHedger&) = delete;
+
+    /**
+     * @brief Records a request about to be sent, which adds to the hedge budget
+     * @return Time after which the request should be hedged if it has not been answered yet, or std::nullopt if it
+     * can not be hedged, as too few latencies are recorded yet or the budget is exhausted
+     */
+    std::optional<std::chrono::milliseconds> OnRequest();
+
+    /**
+     * @brief Takes a hedge from the budget
+     * @return False if the budget is exhausted, in which case the hedge must not be sent
+     */
+    bool TryHedge();
+
+    /// @brief Records the time a request took to be answered
+    void RecordLatency(std::chrono::milliseconds latency);
+
+    /// @brief Records that the response to a hedge arrived first
+    void OnHedgeWon();
+
+    /// @brief Number of hedges sent
+    uint64_t GetHedgeCount() const;
+
+    /// @brief Number of hedges whose response arrived before the one of the original request
+    uint64_t GetHedgeWinCount() const;
+
+  private:
+    const double m_percentile;
+    const double m_maxHedgeRate;
+
+    mutable std::mutex m_mutex;
+
+    // Latencies of the last requests, overwritten in a circle once full
+    std::vector<std::chrono::milliseconds> m_latencies;
+    size_t m_nextLatency{0};
+
+    double m_tokens{0.0};
+    uint64_t m_hedges{0};
+    uint64_t m_hedgeWins{0};
+};
+} // namespace SFS::details
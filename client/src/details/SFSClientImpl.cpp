@@ -6,17 +6,30 @@
 #include "AppContent.h"
 #include "Content.h"
 #include "ErrorHandling.h"
+#include "LatestVersionBatcher.h"
 #include "Logging.h"
+#include "RequestBody.h"
 #include "SFSUrlComponents.h"
 #include "TestOverride.h"
+#include "UrlExpiry.h"
 #include "Util.h"
+#include "connection/CircuitBreaker.h"
 #include "connection/Connection.h"
 #include "connection/ConnectionManager.h"
 #include "connection/CurlConnectionManager.h"
+#include "connection/CurlMultiConnectionManager.h"
+#include "connection/RetryBudget.h"
 #include "connection/mock/MockConnectionManager.h"
+#include "entity/ResponseParser.h"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 using namespace SFS;
@@ -28,6 +41,10 @@ constexpr const char* c_apiDomain = "api.cdp.microsoft.com";
 constexpr const char* c_defaultInstanceId = "default";
 constexpr const char* c_defaultNameSpace = "default";
 
+// Prefixes of the keys in the persistent cache, which holds both kinds of responses
+constexpr const char* c_latestVersionKeyPrefix = "LatestVersion/";
+constexpr const char* c_downloadInfoKeyPrefix = "DownloadInfo/";
+
 namespace
 {
 void LogIfTestOverridesAllowed(const ReportingHandler& handler)
@@ -38,53 +55,6 @@ void LogIfTestOverridesAllowed(const ReportingHandler& handler)
     }
 }
 
-void ThrowInvalidResponseIfFalse(bool condition, const std::string& message, const ReportingHandler& handler)
-{
-    THROW_CODE_IF_LOG(ServiceInvalidResponse, !condition, handler, message);
-}
-
-json ParseServerMethodStringToJson(const std::string& data, const std::string& method, const ReportingHandler& handler)
-{
-    try
-    {
-        return json::parse(data);
-    }
-    catch (json::parse_error& ex)
-    {
-        THROW_LOG(
-            Result(Result::ServiceInvalidResponse, "(" + method + ") JSON Parsing error: " + std::string(ex.what())),
-            handler);
-        return json(); // Unreachable code, but the compiler doesn't know that.
-    }
-}
-
-VersionEntities ConvertLatestVersionBatchResponseToVersionEntities(const json& data, const ReportingHandler& handler)
-{
-    // Expected format:
-    // [
-    //   {
-    //     "ContentId": {
-    //       "Namespace": <ns>,
-    //       "Name": <name>,
-    //       "Version": <version>
-    //     }
-    //   },
-    //   ...
-    // ]
-    //
-
-    ThrowInvalidResponseIfFalse(data.is_array(), "Response is not a JSON array", handler);
-    ThrowInvalidResponseIfFalse(data.size() > 0, "Response does not have the expected size", handler);
-
-    VersionEntities entities;
-    for (const auto& obj : data)
-    {
-        entities.push_back(std::move(VersionEntity::FromJson(obj, handler)));
-    }
-
-    return entities;
-}
-
 bool VerifyVersionResponseMatchesProduct(const ContentIdEntity& contentId,
                                          std::string_view nameSpace,
                                          std::string_view name)
@@ -132,15 +102,262 @@ void ValidateRequestParams(const RequestParams& requestParams, const ReportingHa
 {
     THROW_CODE_IF_LOG(InvalidArg, requestParams.productRequests.empty(), handler, "productRequests cannot be empty");
 
-    // TODO #78: Add support for multiple product requests
+    for (const auto& [product, _] : requestParams.productRequests)
+    {
+        THROW_CODE_IF_LOG(InvalidArg, product.empty(), handler, "product cannot be empty");
+    }
+}
+
+/**
+ * @brief Builds the key of a latest version lookup in the caches, which also identifies identical requests
+ * @details The key includes the service the request is sent to, as a cache file can be shared by clients of different
+ * accounts. Attributes are sorted so that the same set of attributes always gives the same key, and every part is
+ * length-prefixed so that different requests can never give the same key
+ */
+std::string MakeLatestVersionCacheKey(const std::string& baseUrl,
+                                      const std::string& accountId,
+                                      const std::string& instanceId,
+                                      const std::string& nameSpace,
+                                      const ProductRequest& productRequest)
+{
+    std::vector<std::pair<std::string_view, std::string_view>> attributes(productRequest.attributes.begin(),
+                                                                          productRequest.attributes.end());
+    std::sort(attributes.begin(), attributes.end());
+
+    std::string key;
+    auto append = [&key](std::string_view part) {
+        key += std::to_string(part.size());
+        key += ':';
+        key += part;
+    };
+
+    append(baseUrl);
+    append(accountId);
+    append(instanceId);
+    append(nameSpace);
+    append(productRequest.product);
+    for (const auto& [name, value] : attributes)
+    {
+        append(name);
+        append(value);
+    }
+    return key;
+}
+
+std::string MakeDownloadInfoCacheKey(const std::string& baseUrl,
+                                     const std::string& accountId,
+                                     const std::string& instanceId,
+                                     const std::string& nameSpace,
+                                     const std::string& product,
+                                     const std::string& version)
+{
+    std::string key;
+    for (const std::string* part : {&baseUrl, &accountId, &instanceId, &nameSpace, &product, &version})
+    {
+        key += std::to_string(part->size());
+        key += ':';
+        key += *part;
+    }
+    return key;
+}
+
+// Download URLs are dropped from the cache this long before they expire, so callers still have time to use them
+constexpr std::chrono::minutes c_downloadUrlExpiryMargin{5};
+
+/**
+ * @brief Returns how long the download info made of @param files can be reused from now
+ * @return The shortest of @param ttl and the time left before the download URLs expire, less a margin. It is not
+ * positive if the download info should not be reused at all.
+ */
+std::chrono::seconds GetDownloadInfoTimeToLive(const FileEntities& files, std::chrono::seconds ttl)
+{
+    const auto now = std::chrono::system_clock::now();
+    for (const auto& file : files)
+    {
+        if (const auto urlExpiry = GetUrlExpiry(file->url))
+        {
+            const auto timeLeft =
+                std::chrono::duration_cast<std::chrono::seconds>(*urlExpiry - now) - c_downloadUrlExpiryMargin;
+            ttl = std::min(ttl, timeLeft);
+        }
+    }
+    return ttl;
+}
+
+void ValidateAppRequestParams(const RequestParams& requestParams, const ReportingHandler& handler)
+{
+    // TODO #78: Add support for multiple app product requests
     THROW_CODE_IF_LOG(NotImpl,
                       requestParams.productRequests.size() > 1,
                       handler,
                       "There cannot be more than 1 productRequest at the moment");
 
-    for (const auto& [product, _] : requestParams.productRequests)
+    ValidateRequestParams(requestParams, handler);
+}
+
+/**
+ * @brief Puts the entities of a batch response in the order of the @param productRequests
+ * @details The service leaves out products it does not know, and returns repeated products only once, so the result
+ * has one entity per distinct known product
+ */
+VersionEntities OrderBatchVersionEntities(VersionEntities&& entities,
+                                          const std::vector<ProductRequest>& productRequests,
+                                          const ReportingHandler& handler)
+{
+    std::unordered_map<std::string, std::unique_ptr<VersionEntity>> entitiesByProduct;
+    for (auto& entity : entities)
     {
-        THROW_CODE_IF_LOG(InvalidArg, product.empty(), handler, "product cannot be empty");
+        const std::string product = entity->contentId.name;
+        entitiesByProduct.emplace(product, std::move(entity));
+    }
+
+    VersionEntities orderedEntities;
+    std::unordered_set<std::string> seenProducts;
+    for (const auto& [product, _] : productRequests)
+    {
+        if (!seenProducts.insert(product).second)
+        {
+            continue;
+        }
+
+        auto it = entitiesByProduct.find(product);
+        if (it == entitiesByProduct.end())
+        {
+            LOG_WARNING(handler, "Product [%s] was not found by the service", product.c_str());
+            continue;
+        }
+        orderedEntities.push_back(std::move(it->second));
+    }
+
+    return orderedEntities;
+}
+
+// A request that is sent again on another connection when it is slow to answer. It is shared by the call that made it
+// and the worker threads sending it, which may still be aborting the losing request once the call has returned.
+struct HedgedRequest
+{
+    using MakeConnectionFn = std::function<std::unique_ptr<Connection>(const ConnectionConfig&)>;
+
+    HedgedRequest(std::string url, std::string body, MakeConnectionFn makeConnection)
+        : url(std::move(url))
+        , body(std::move(body))
+        , makeConnection(std::move(makeConnection))
+    {
+    }
+
+    // Hands the config of the connection of the request at @param index to the worker thread sending it. Configs are
+    // made by the calling thread, which owns the connection they derive from, once a worker is known to send them.
+    void Configure(size_t index, ConnectionConfig config)
+    {
+        std::lock_guard guard(mutex);
+        configs[index] = std::move(config);
+        answered.notify_all();
+    }
+
+    // Sends the original request (index 0) or its hedge (index 1). The first successful response cancels the other one.
+    // The connection is only made here, so that a request that is not sent does not take a handle from the pool.
+    void Send(size_t index)
+    {
+        std::optional<ConnectionConfig> config;
+        {
+            std::unique_lock lock(mutex);
+            answered.wait(lock, [&]() { return configs[index].has_value(); });
+            config = std::move(configs[index]);
+        }
+
+        std::optional<std::string> result;
+        std::exception_ptr error;
+        try
+        {
+            auto connection = makeConnection(*config);
+            {
+                // A request whose peer already won is not sent at all
+                std::lock_guard guard(mutex);
+                if (response)
+                {
+                    done[index] = true;
+                    answered.notify_all();
+                    return;
+                }
+                connections[index] = std::move(connection);
+            }
+            result = connections[index]->Post(url, body);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard guard(mutex);
+        if (result && !response)
+        {
+            response = std::move(result);
+            winner = index;
+            if (connections[1 - index])
+            {
+                connections[1 - index]->Cancel();
+            }
+        }
+        if (index == 0)
+        {
+            originalError = error;
+        }
+        done[index] = true;
+        answered.notify_all();
+    }
+
+    // Marks the request at @param index as done without sending it
+    void Skip(size_t index)
+    {
+        std::lock_guard guard(mutex);
+        done[index] = true;
+        answered.notify_all();
+    }
+
+    const std::string url;
+    const std::string body;
+    const MakeConnectionFn makeConnection;
+    std::optional<ConnectionConfig> configs[2];
+    std::unique_ptr<Connection> connections[2];
+
+    std::mutex mutex;
+    std::condition_variable answered;
+    std::optional<std::string> response;
+    size_t winner{0};
+    std::exception_ptr originalError;
+    bool done[2]{false, false};
+};
+
+/**
+ * @brief Tells whether the @param error of a request made on @param connection can be shared with identical calls
+ * @details Successes and the errors of the service are shared. A request that was cancelled or timed out, or whose
+ * retries were cut short by the deadline of @param connection, may succeed for a caller with other limits, so those
+ * errors are kept by the caller whose request failed.
+ */
+bool IsSharedError(const std::exception_ptr& error, const Connection& connection)
+{
+    try
+    {
+        std::rethrow_exception(error);
+    }
+    catch (const SFSException& e)
+    {
+        switch (e.GetResult().GetCode())
+        {
+        case Result::ConnectionCancelled:
+        case Result::HttpTimeout:
+            return false;
+        case Result::HttpTooManyRequests:
+        case Result::HttpServiceNotAvailable:
+        case Result::HttpUnexpected:
+            return !connection.HasRetryDeadline();
+        default:
+            return true;
+        }
+    }
+    catch (...)
+    {
+        return true;
     }
 }
 } // namespace
@@ -151,15 +368,72 @@ SFSClientImpl<ConnectionManagerT>::SFSClientImpl(ClientConfig&& config)
     , m_instanceId(config.instanceId && !config.instanceId->empty() ? std::move(*config.instanceId)
                                                                     : c_defaultInstanceId)
     , m_nameSpace(config.nameSpace && !config.nameSpace->empty() ? std::move(*config.nameSpace) : c_defaultNameSpace)
+    , m_maxParallelRequests(config.maxParallelRequestsPerCall)
+    , m_maxResponseSize(config.maxResponseSize)
+    , m_maxStreamedDownloadInfoSize(config.maxStreamedDownloadInfoSize)
+    , m_failFastWhenThrottled(config.failFastWhenThrottled)
+    , m_jitterRetryDelays(config.jitterRetryDelays)
+    , m_executor(config.maxAsyncThreads)
 {
     if (config.logCallbackFn)
     {
         m_reportingHandler.SetLoggingCallback(std::move(*config.logCallbackFn));
     }
 
+    if (config.retryBudgetRatio)
+    {
+        m_retryBudget = std::make_shared<RetryBudget>(*config.retryBudgetRatio, config.retryBudgetBurst);
+    }
+
+    if (config.circuitBreakerFailureThreshold > 0)
+    {
+        m_circuitBreaker =
+            std::make_shared<CircuitBreaker>(config.circuitBreakerFailureThreshold, config.circuitBreakerCoolDown);
+    }
+
+    if (config.latestVersionHedgePercentile)
+    {
+        m_requestHedger =
+            std::make_unique<RequestHedger>(*config.latestVersionHedgePercentile, config.latestVersionHedgeMaxRate);
+    }
+
+    m_latestVersionCacheTtl = config.latestVersionCacheTtl;
+    m_latestVersionCacheStaleWhileRevalidate = config.latestVersionCacheStaleWhileRevalidate;
+    if (config.latestVersionCacheTtl.count() > 0 && config.latestVersionCacheMaxEntries > 0)
+    {
+        m_latestVersionCache = std::make_unique<LruCache<CachedLatestVersion>>(
+            config.latestVersionCacheMaxEntries,
+            config.latestVersionCacheTtl);
+    }
+
+    if (config.latestVersionBatchWindow.count() > 0)
+    {
+        m_latestVersionBatcher = std::make_unique<LatestVersionBatcher>(config.latestVersionBatchWindow,
+                                                                        config.latestVersionBatchMaxSize,
+                                                                        m_reportingHandler);
+    }
+
+    m_downloadInfoCacheTtl = config.downloadInfoCacheTtl;
+    if (config.downloadInfoCacheTtl.count() > 0 && config.downloadInfoCacheMaxEntries > 0)
+    {
+        m_downloadInfoCache = std::make_unique<LruCache<std::shared_ptr<const FileEntities>>>(
+            config.downloadInfoCacheMaxEntries,
+            config.downloadInfoCacheTtl);
+    }
+
+    // The file is only read once it is first needed, so that creating a client stays cheap
+    if (config.persistentCacheFile && !config.persistentCacheFile->empty())
+    {
+        m_persistentCache = std::make_unique<PersistentCache>(std::filesystem::u8path(*config.persistentCacheFile),
+                                                              config.persistentCacheMaxEntries,
+                                                              config.persistentCacheMaxStaleness,
+                                                              m_reportingHandler);
+        m_persistentCacheMaxStaleness = config.persistentCacheMaxStaleness;
+    }
+
     static_assert(std::is_base_of<ConnectionManager, ConnectionManagerT>::value,
                   "ConnectionManagerT not derived from ConnectionManager");
-    m_connectionManager = std::make_unique<ConnectionManagerT>(m_reportingHandler);
+    m_connectionManager = std::make_unique<ConnectionManagerT>(m_reportingHandler, ConnectionManagerConfig(config));
 
     LogIfTestOverridesAllowed(m_reportingHandler);
 }
@@ -167,27 +441,435 @@ SFSClientImpl<ConnectionManagerT>::SFSClientImpl(ClientConfig&& config)
 template <typename ConnectionManagerT>
 std::unique_ptr<VersionEntity> SFSClientImpl<ConnectionManagerT>::GetLatestVersion(const ProductRequest& productRequest,
                                                                                    Connection& connection) const
+{
+    return std::move(LookUpLatestVersion(productRequest, connection, true /*allowBatching*/).versionEntity);
+}
+
+template <typename ConnectionManagerT>
+typename SFSClientImpl<ConnectionManagerT>::LatestVersionLookup SFSClientImpl<
+    ConnectionManagerT>::LookUpLatestVersion(const ProductRequest& productRequest,
+                                             Connection& connection,
+                                             bool allowBatching) const
 try
+{
+    LatestVersionLookup lookup;
+    lookup.cacheKey = MakeLatestVersionCacheKey(GetBaseUrl(), m_accountId, m_instanceId, m_nameSpace, productRequest);
+    if (GetCachedLatestVersion(productRequest, lookup))
+    {
+        return lookup;
+    }
+
+    // Identical concurrent lookups share a single request, and each caller gets its own copy of the result
+    const auto& cacheKey = lookup.cacheKey;
+    const auto versionEntity = m_latestVersionFlights.Do(
+        cacheKey,
+        [&]() -> std::shared_ptr<const VersionEntity> {
+            if (allowBatching && m_latestVersionBatcher)
+            {
+                return FetchLatestVersionInBatch(productRequest, cacheKey, connection);
+            }
+            return FetchLatestVersion(productRequest, cacheKey, connection);
+        },
+        [&](const std::exception_ptr& error) { return IsSharedError(error, connection); });
+    lookup.versionEntity = versionEntity->Clone();
+    return lookup;
+}
+SFS_CATCH_LOG_RETHROW(m_reportingHandler)
+
+template <typename ConnectionManagerT>
+std::vector<typename SFSClientImpl<ConnectionManagerT>::LatestVersionLookup> SFSClientImpl<
+    ConnectionManagerT>::LookUpLatestVersions(
+    const std::vector<ProductRequest>& productRequests,
+    Connection& connection) const
+{
+    // Products requested more than once are looked up once, as the service answers a batch with one entity per product
+    std::vector<const ProductRequest*> uniqueRequests;
+    std::unordered_set<std::string> seenProducts;
+    for (const auto& productRequest : productRequests)
+    {
+        if (seenProducts.insert(productRequest.product).second)
+        {
+            uniqueRequests.push_back(&productRequest);
+        }
+    }
+
+    const std::string baseUrl = GetBaseUrl();
+    std::vector<LatestVersionLookup> lookups(uniqueRequests.size());
+    std::vector<ProductRequest> missingRequests;
+    std::unordered_map<std::string, size_t> missingByProduct;
+    std::string flightKey;
+    for (size_t i = 0; i < uniqueRequests.size(); ++i)
+    {
+        const auto& productRequest = *uniqueRequests[i];
+        auto& lookup = lookups[i];
+        lookup.cacheKey = MakeLatestVersionCacheKey(baseUrl, m_accountId, m_instanceId, m_nameSpace, productRequest);
+        if (!GetCachedLatestVersion(productRequest, lookup))
+        {
+            // The keys are length-prefixed as well, so that different sets of lookups never share a flight
+            flightKey += std::to_string(lookup.cacheKey.size()) + ':' + lookup.cacheKey;
+            missingRequests.push_back(productRequest);
+            missingByProduct.emplace(productRequest.product, i);
+        }
+    }
+
+    if (!missingRequests.empty())
+    {
+        // Identical concurrent lookups share a single batch request, whose entities are cached one by one
+        std::shared_ptr<const VersionEntities> batchEntities;
+        try
+        {
+            batchEntities = m_latestVersionBatchFlights.Do(
+                flightKey,
+                [&]() -> std::shared_ptr<const VersionEntities> {
+                    auto fetchedEntities = OrderBatchVersionEntities(GetLatestVersionBatch(missingRequests, connection),
+                                                                     missingRequests,
+                                                                     m_reportingHandler);
+                    for (const auto& entity : fetchedEntities)
+                    {
+                        StoreBatchedLatestVersion(lookups[missingByProduct.at(entity->contentId.name)].cacheKey,
+                                                  *entity);
+                    }
+                    return std::make_shared<const VersionEntities>(std::move(fetchedEntities));
+                },
+                [&](const std::exception_ptr& error) { return IsSharedError(error, connection); });
+        }
+        catch (const SFSException& e)
+        {
+            // The service only answers 404 when it knows none of the products of the batch. The cached products are
+            // still returned, as they would have been from a batch that included them.
+            if (e.GetResult().GetCode() != Result::HttpNotFound || missingRequests.size() == uniqueRequests.size())
+            {
+                throw;
+            }
+            for (const auto& productRequest : missingRequests)
+            {
+                LOG_WARNING(m_reportingHandler,
+                            "Product [%s] was not found by the service",
+                            productRequest.product.c_str());
+            }
+        }
+
+        if (batchEntities)
+        {
+            for (const auto& entity : *batchEntities)
+            {
+                lookups[missingByProduct.at(entity->contentId.name)].versionEntity = entity->Clone();
+            }
+        }
+    }
+
+    // Products the service did not return are left out, as they are from a batch response
+    std::vector<LatestVersionLookup> foundLookups;
+    for (auto& lookup : lookups)
+    {
+        if (lookup.versionEntity)
+        {
+            foundLookups.push_back(std::move(lookup));
+        }
+    }
+    return foundLookups;
+}
+
+template <typename ConnectionManagerT>
+bool SFSClientImpl<ConnectionManagerT>::GetCachedLatestVersion(const ProductRequest& productRequest,
+                                                               LatestVersionLookup& lookup) const
+{
+    const std::string& cacheKey = lookup.cacheKey;
+    if (m_latestVersionCache)
+    {
+        if (auto cached = m_latestVersionCache->GetAllowingStale(cacheKey, m_latestVersionCacheStaleWhileRevalidate))
+        {
+            const auto& [versionEntity, files, filesExpireAt] = cached->value;
+            if (cached->isStale)
+            {
+                LOG_INFO(m_reportingHandler,
+                         "Using stale cached latest version of [%s]: %s. Refreshing it in the background",
+                         productRequest.product.c_str(),
+                         versionEntity->contentId.version.c_str());
+
+                // The download info cached along with the version answers the call in full, as long as its URLs are
+                // valid. The refresh then gets the download info of the new version as well, for the next stale hit.
+                if (files && std::chrono::steady_clock::now() < filesExpireAt)
+                {
+                    lookup.staleFiles = files;
+                }
+                RefreshInBackground(c_latestVersionKeyPrefix + cacheKey,
+                                    [this, productRequest, cacheKey, withDownloadInfo = files != nullptr](
+                                        Connection& connection) {
+                                        RefreshLatestVersion(productRequest, cacheKey, withDownloadInfo, connection);
+                                    });
+            }
+            else
+            {
+                LOG_INFO(m_reportingHandler,
+                         "Using cached latest version of [%s]: %s",
+                         productRequest.product.c_str(),
+                         versionEntity->contentId.version.c_str());
+            }
+            lookup.versionEntity = versionEntity->Clone();
+            return true;
+        }
+    }
+
+    if (m_persistentCache)
+    {
+        lookup.versionEntity = GetPersistedLatestVersion(productRequest, cacheKey);
+    }
+    return lookup.versionEntity != nullptr;
+}
+
+template <typename ConnectionManagerT>
+void SFSClientImpl<ConnectionManagerT>::RefreshLatestVersion(const ProductRequest& productRequest,
+                                                             const std::string& cacheKey,
+                                                             bool withDownloadInfo,
+                                                             Connection& connection) const
+{
+    const auto versionEntity = FetchLatestVersion(productRequest, cacheKey, connection);
+    if (withDownloadInfo)
+    {
+        const auto& contentId = versionEntity->contentId;
+        StoreLatestDownloadInfo(cacheKey,
+                                contentId.version,
+                                GetDownloadInfo(contentId.name, contentId.version, connection));
+    }
+}
+
+template <typename ConnectionManagerT>
+void SFSClientImpl<ConnectionManagerT>::StoreLatestDownloadInfo(const std::string& cacheKey,
+                                                                const std::string& version,
+                                                                const FileEntities& files) const
+{
+    // Only stale lookups use the download info cached along with the latest version
+    if (!m_latestVersionCache || m_latestVersionCacheStaleWhileRevalidate.count() <= 0)
+    {
+        return;
+    }
+
+    const auto timeToLive =
+        GetDownloadInfoTimeToLive(files, m_latestVersionCacheTtl + m_latestVersionCacheStaleWhileRevalidate);
+    if (timeToLive.count() <= 0)
+    {
+        return;
+    }
+
+    auto sharedFiles = std::make_shared<const FileEntities>(FileEntity::CloneEntities(files));
+    const auto expiresAt = std::chrono::steady_clock::now() + timeToLive;
+    m_latestVersionCache->Update(cacheKey, [&](CachedLatestVersion& cached) {
+        // The entry may have been refreshed with a newer version in the meantime
+        if (cached.versionEntity->contentId.version == version)
+        {
+            cached.files = std::move(sharedFiles);
+            cached.filesExpireAt = expiresAt;
+        }
+    });
+}
+
+template <typename ConnectionManagerT>
+std::unique_ptr<VersionEntity> SFSClientImpl<ConnectionManagerT>::FetchLatestVersion(
+    const ProductRequest& productRequest,
+    const std::string& cacheKey,
+    Connection& connection) const
 {
     const auto& [product, attributes] = productRequest;
+
     const std::string url{SFSUrlComponents::GetLatestVersionUrl(GetBaseUrl(), m_instanceId, m_nameSpace, product)};
 
     LOG_INFO(m_reportingHandler, "Requesting latest version of [%s] from URL [%s]", product.c_str(), url.c_str());
 
-    const json body = {{"TargetingAttributes", attributes}};
-    LOG_VERBOSE(m_reportingHandler, "Request body [%s]", body.dump().c_str());
+    auto& body = connection.GetRequestBodyBuffer();
+    WriteLatestVersionRequestBody(attributes, body, m_reportingHandler);
+    LOG_VERBOSE(m_reportingHandler, "Request body [%s]", body.c_str());
 
-    const std::string postResponse{connection.Post(url, body.dump())};
-    const json versionResponse = ParseServerMethodStringToJson(postResponse, "GetLatestVersion", m_reportingHandler);
+    const std::string postResponse{m_requestHedger ? PostHedged(url, body, connection) : connection.Post(url, body)};
 
-    auto versionEntity = VersionEntity::FromJson(versionResponse, m_reportingHandler);
+    auto versionEntity = ParseVersionResponse(postResponse, "GetLatestVersion", m_reportingHandler);
     ValidateVersionEntity(*versionEntity, m_nameSpace, product, m_reportingHandler);
 
     LOG_INFO(m_reportingHandler, "Received a response with version %s", versionEntity->contentId.version.c_str());
 
+    StoreLatestVersion(cacheKey, *versionEntity, postResponse);
+
+    return versionEntity;
+}
+
+template <typename ConnectionManagerT>
+std::string SFSClientImpl<ConnectionManagerT>::PostHedged(const std::string& url,
+                                                          const std::string& body,
+                                                          Connection& connection) const
+{
+    using namespace std::chrono;
+
+    const auto begin = steady_clock::now();
+    const auto hedgeDelay = m_requestHedger->OnRequest();
+
+    // The requests are sent from worker threads, so that the call returns with the first response without waiting for
+    // the other request to be aborted. Without a worker free to send it right away, the request is not hedged, and is
+    // sent on @param connection without making any other.
+    const auto request = hedgeDelay ? std::make_shared<HedgedRequest>(
+                                          url,
+                                          body,
+                                          [this](const ConnectionConfig& config) { return MakeConnection(config); })
+                                    : nullptr;
+    if (!request || !m_executor.TryPost([request]() { request->Send(0); }))
+    {
+        std::string response = connection.Post(url, body);
+        m_requestHedger->RecordLatency(duration_cast<milliseconds>(steady_clock::now() - begin));
+        return response;
+    }
+    request->Configure(0, connection.MakeChildConfig());
+
+    std::unique_lock lock(request->mutex);
+    bool hedgePosted = false;
+    const auto isOriginalOver = [&]() { return request->response || request->done[0]; };
+    if (!request->answered.wait_until(lock, begin + *hedgeDelay, isOriginalOver))
+    {
+        // The hedge is configured once posted, and the worker only makes its connection if it is let through
+        lock.unlock();
+        hedgePosted = m_executor.TryPost([this, request, hedgeDelay]() {
+            if (!m_requestHedger->TryHedge())
+            {
+                request->Skip(1);
+                return;
+            }
+            LOG_INFO(m_reportingHandler,
+                     "No response after %lldms, hedging the request to URL [%s]",
+                     static_cast<long long>(hedgeDelay->count()),
+                     request->url.c_str());
+            request->Send(1);
+        });
+        if (hedgePosted)
+        {
+            request->Configure(1, connection.MakeChildConfig());
+        }
+        lock.lock();
+    }
+    request->answered.wait(lock, [&]() {
+        return isOriginalOver() && (request->response || !hedgePosted || request->done[1]);
+    });
+
+    if (!request->response)
+    {
+        // The original request can only be cancelled by a successful hedge, so its error is the one that matters
+        std::rethrow_exception(request->originalError);
+    }
+
+    std::string response = std::move(*request->response);
+    const bool hedgeWon = request->winner == 1;
+    lock.unlock();
+
+    m_requestHedger->RecordLatency(duration_cast<milliseconds>(steady_clock::now() - begin));
+    if (hedgeWon)
+    {
+        m_requestHedger->OnHedgeWon();
+    }
+    return response;
+}
+
+template <typename ConnectionManagerT>
+std::unique_ptr<VersionEntity> SFSClientImpl<ConnectionManagerT>::FetchLatestVersionInBatch(
+    const ProductRequest& productRequest,
+    const std::string& cacheKey,
+    Connection& connection) const
+{
+    // Only the lookup that sends the batch uses its connection, so the errors that only concern that connection are
+    // not handed to the other lookups of the batch
+    auto versionEntity = m_latestVersionBatcher->GetLatestVersion(
+        productRequest,
+        [&](const std::vector<ProductRequest>& requests) { return GetLatestVersionBatch(requests, connection); },
+        [&](const std::exception_ptr& error) { return IsSharedError(error, connection); });
+    StoreBatchedLatestVersion(cacheKey, *versionEntity);
+
+    return versionEntity;
+}
+
+template <typename ConnectionManagerT>
+void SFSClientImpl<ConnectionManagerT>::StoreBatchedLatestVersion(const std::string& cacheKey,
+                                                                  const VersionEntity& versionEntity) const
+{
+    // Batch responses are made of the same objects as single product responses
+    const json versionResponse = {{"ContentId",
+                                   {{"Namespace", versionEntity.contentId.nameSpace},
+                                    {"Name", versionEntity.contentId.name},
+                                    {"Version", versionEntity.contentId.version}}}};
+    StoreLatestVersion(cacheKey, versionEntity, versionResponse.dump());
+}
+
+template <typename ConnectionManagerT>
+void SFSClientImpl<ConnectionManagerT>::StoreLatestVersion(const std::string& cacheKey,
+                                                           const VersionEntity& versionEntity,
+                                                           const std::string& response) const
+{
+    if (m_latestVersionCache)
+    {
+        m_latestVersionCache->Put(cacheKey, CachedLatestVersion{versionEntity.Clone(), nullptr, {}});
+    }
+    if (m_persistentCache)
+    {
+        m_persistentCache->Put(c_latestVersionKeyPrefix + cacheKey,
+                               response,
+                               PersistentCache::Clock::now() + m_latestVersionCacheTtl);
+    }
+}
+
+template <typename ConnectionManagerT>
+std::unique_ptr<VersionEntity> SFSClientImpl<ConnectionManagerT>::GetPersistedLatestVersion(
+    const ProductRequest& productRequest,
+    const std::string& cacheKey) const
+{
+    const std::string persistentKey = c_latestVersionKeyPrefix + cacheKey;
+    const auto entry = m_persistentCache->Get(persistentKey);
+    if (!entry)
+    {
+        return nullptr;
+    }
+
+    const auto now = PersistentCache::Clock::now();
+    const bool isFresh = now < entry->expiresAt;
+    if (!isFresh && now >= entry->expiresAt + m_persistentCacheMaxStaleness)
+    {
+        return nullptr;
+    }
+
+    const auto& product = productRequest.product;
+    std::unique_ptr<VersionEntity> versionEntity;
+    try
+    {
+        versionEntity = ParseVersionResponse(entry->value, "GetLatestVersion", m_reportingHandler);
+        ValidateVersionEntity(*versionEntity, m_nameSpace, product, m_reportingHandler);
+    }
+    catch (const SFSException&)
+    {
+        LOG_WARNING(m_reportingHandler, "Ignoring the invalid latest version of [%s] stored on disk", product.c_str());
+        return nullptr;
+    }
+
+    if (isFresh)
+    {
+        LOG_INFO(m_reportingHandler,
+                 "Using latest version of [%s] stored on disk: %s",
+                 product.c_str(),
+                 versionEntity->contentId.version.c_str());
+        if (m_latestVersionCache)
+        {
+            const auto timeLeft = std::chrono::duration_cast<std::chrono::seconds>(entry->expiresAt - now);
+            m_latestVersionCache->Put(cacheKey,
+                                      CachedLatestVersion{versionEntity->Clone(), nullptr, {}},
+                                      std::chrono::steady_clock::now() + timeLeft);
+        }
+    }
+    else
+    {
+        LOG_INFO(m_reportingHandler,
+                 "Using stale latest version of [%s] stored on disk: %s. Refreshing it in the background",
+                 product.c_str(),
+                 versionEntity->contentId.version.c_str());
+        RefreshInBackground(persistentKey, [this, productRequest, cacheKey](Connection& connection) {
+            FetchLatestVersion(productRequest, cacheKey, connection);
+        });
+    }
+
     return versionEntity;
 }
-SFS_CATCH_LOG_RETHROW(m_reportingHandler)
 
 template <typename ConnectionManagerT>
 VersionEntities SFSClientImpl<ConnectionManagerT>::GetLatestVersionBatch(
@@ -199,25 +881,21 @@ try
 
     LOG_INFO(m_reportingHandler, "Requesting latest version of multiple products from URL [%s]", url.c_str());
 
-    // Creating request body
     std::unordered_set<std::string> requestedProducts;
-    json body = json::array();
-    for (const auto& [product, attributes] : productRequests)
+    for (size_t i = 0; i < productRequests.size(); ++i)
     {
-        LOG_INFO(m_reportingHandler, "Product #%zu: [%s]", body.size() + size_t{1}, product.c_str());
+        const auto& product = productRequests[i].product;
+        LOG_INFO(m_reportingHandler, "Product #%zu: [%s]", i + 1, product.c_str());
         requestedProducts.insert(product);
-
-        body.push_back({{"TargetingAttributes", attributes}, {"Product", product}});
     }
 
-    LOG_VERBOSE(m_reportingHandler, "Request body [%s]", body.dump().c_str());
+    auto& body = connection.GetRequestBodyBuffer();
+    WriteLatestVersionBatchRequestBody(productRequests, body, m_reportingHandler);
+    LOG_VERBOSE(m_reportingHandler, "Request body [%s]", body.c_str());
 
-    const std::string postResponse{connection.Post(url, body.dump())};
+    const std::string postResponse{connection.Post(url, body)};
 
-    const json versionResponse =
-        ParseServerMethodStringToJson(postResponse, "GetLatestVersionBatch", m_reportingHandler);
-
-    auto entities = ConvertLatestVersionBatchResponseToVersionEntities(versionResponse, m_reportingHandler);
+    auto entities = ParseVersionBatchResponse(postResponse, "GetLatestVersionBatch", m_reportingHandler);
     ValidateBatchVersionEntity(entities, m_nameSpace, requestedProducts, m_reportingHandler);
 
     return entities;
@@ -241,9 +919,7 @@ try
 
     const std::string getResponse{connection.Get(url)};
 
-    const json versionResponse = ParseServerMethodStringToJson(getResponse, "GetSpecificVersion", m_reportingHandler);
-
-    auto versionEntity = VersionEntity::FromJson(versionResponse, m_reportingHandler);
+    auto versionEntity = ParseVersionResponse(getResponse, "GetSpecificVersion", m_reportingHandler);
     ValidateVersionEntity(*versionEntity, m_nameSpace, product, m_reportingHandler);
 
     LOG_INFO(m_reportingHandler,
@@ -259,6 +935,46 @@ FileEntities SFSClientImpl<ConnectionManagerT>::GetDownloadInfo(const std::strin
                                                                 const std::string& version,
                                                                 Connection& connection) const
 try
+{
+    const std::string cacheKey =
+        MakeDownloadInfoCacheKey(GetBaseUrl(), m_accountId, m_instanceId, m_nameSpace, product, version);
+
+    if (m_downloadInfoCache)
+    {
+        if (auto cachedFiles = m_downloadInfoCache->Get(cacheKey))
+        {
+            LOG_INFO(m_reportingHandler,
+                     "Using cached download info of version [%s] of [%s]",
+                     version.c_str(),
+                     product.c_str());
+            return FileEntity::CloneEntities(**cachedFiles);
+        }
+    }
+
+    if (m_persistentCache)
+    {
+        if (auto persistedFiles = GetPersistedDownloadInfo(product, version, cacheKey))
+        {
+            return std::move(*persistedFiles);
+        }
+    }
+
+    // Identical concurrent lookups share a single request, and each caller gets its own copy of the result
+    const auto files = m_downloadInfoFlights.Do(
+        cacheKey,
+        [&]() {
+            return std::make_shared<const FileEntities>(FetchDownloadInfo(product, version, cacheKey, connection));
+        },
+        [&](const std::exception_ptr& error) { return IsSharedError(error, connection); });
+    return FileEntity::CloneEntities(*files);
+}
+SFS_CATCH_LOG_RETHROW(m_reportingHandler)
+
+template <typename ConnectionManagerT>
+FileEntities SFSClientImpl<ConnectionManagerT>::FetchDownloadInfo(const std::string& product,
+                                                                  const std::string& version,
+                                                                  const std::string& cacheKey,
+                                                                  Connection& connection) const
 {
     const std::string url{
         SFSUrlComponents::GetDownloadInfoUrl(GetBaseUrl(), m_instanceId, m_nameSpace, product, version)};
@@ -269,18 +985,100 @@ try
              product.c_str(),
              url.c_str());
 
-    const std::string postResponse{connection.Post(url)};
-
-    const json downloadInfoResponse =
-        ParseServerMethodStringToJson(postResponse, "GetDownloadInfo", m_reportingHandler);
+    // Download info grows with the number of files of a version, so it may be too large to be kept in memory
+    const StreamingResponse postResponse{connection.PostStreaming(url)};
 
-    auto files = FileEntity::DownloadInfoResponseToFileEntities(downloadInfoResponse, m_reportingHandler);
+    auto files = postResponse.spillFile
+                     ? ParseDownloadInfoResponse(postResponse.spillFile.get(), "GetDownloadInfo", m_reportingHandler)
+                     : ParseDownloadInfoResponse(postResponse.body, "GetDownloadInfo", m_reportingHandler);
 
     LOG_INFO(m_reportingHandler, "Received a response with %zu files", files.size());
 
+    const auto timeToLive = GetDownloadInfoTimeToLive(files, m_downloadInfoCacheTtl);
+    if (m_downloadInfoCache && timeToLive.count() > 0)
+    {
+        m_downloadInfoCache->Put(cacheKey,
+                                 std::make_shared<const FileEntities>(FileEntity::CloneEntities(files)),
+                                 std::chrono::steady_clock::now() + timeToLive);
+    }
+    if (m_persistentCache && !postResponse.spillFile)
+    {
+        m_persistentCache->Put(c_downloadInfoKeyPrefix + cacheKey,
+                               postResponse.body,
+                               PersistentCache::Clock::now() + timeToLive);
+    }
+
+    return files;
+}
+
+template <typename ConnectionManagerT>
+std::optional<FileEntities> SFSClientImpl<ConnectionManagerT>::GetPersistedDownloadInfo(
+    const std::string& product,
+    const std::string& version,
+    const std::string& cacheKey) const
+{
+    const std::string persistentKey = c_downloadInfoKeyPrefix + cacheKey;
+    const auto entry = m_persistentCache->Get(persistentKey);
+    if (!entry)
+    {
+        return std::nullopt;
+    }
+
+    const auto now = PersistentCache::Clock::now();
+    const bool isFresh = now < entry->expiresAt;
+    if (!isFresh && now >= entry->expiresAt + m_persistentCacheMaxStaleness)
+    {
+        return std::nullopt;
+    }
+
+    FileEntities files;
+    try
+    {
+        files = ParseDownloadInfoResponse(entry->value, "GetDownloadInfo", m_reportingHandler);
+    }
+    catch (const SFSException&)
+    {
+        LOG_WARNING(m_reportingHandler,
+                    "Ignoring the invalid download info of version [%s] of [%s] stored on disk",
+                    version.c_str(),
+                    product.c_str());
+        return std::nullopt;
+    }
+
+    // However stale the tolerance allows, download URLs must still work
+    const auto urlsTimeLeft = GetDownloadInfoTimeToLive(files, std::chrono::seconds::max());
+    if (urlsTimeLeft.count() <= 0)
+    {
+        return std::nullopt;
+    }
+
+    if (isFresh)
+    {
+        LOG_INFO(m_reportingHandler,
+                 "Using download info of version [%s] of [%s] stored on disk",
+                 version.c_str(),
+                 product.c_str());
+        if (m_downloadInfoCache)
+        {
+            const auto timeLeft = std::chrono::duration_cast<std::chrono::seconds>(entry->expiresAt - now);
+            m_downloadInfoCache->Put(cacheKey,
+                                     std::make_shared<const FileEntities>(FileEntity::CloneEntities(files)),
+                                     std::chrono::steady_clock::now() + timeLeft);
+        }
+    }
+    else
+    {
+        LOG_INFO(m_reportingHandler,
+                 "Using stale download info of version [%s] of [%s] stored on disk. Refreshing it in the background",
+                 version.c_str(),
+                 product.c_str());
+        RefreshInBackground(persistentKey, [this, product, version, cacheKey](Connection& connection) {
+            FetchDownloadInfo(product, version, cacheKey, connection);
+        });
+    }
+
     return files;
 }
-SFS_CATCH_LOG_RETHROW(m_reportingHandler)
 
 template <typename ConnectionManagerT>
 std::vector<Content> SFSClientImpl<ConnectionManagerT>::GetLatestDownloadInfo(const RequestParams& requestParams) const
@@ -288,31 +1086,76 @@ try
 {
     ValidateRequestParams(requestParams, m_reportingHandler);
 
-    const auto connection = MakeConnection(ConnectionConfig(requestParams));
+    const auto connection = MakeConnection(MakeConnectionConfig(requestParams));
 
-    auto versionEntity = GetLatestVersion(requestParams.productRequests[0], *connection);
-    auto contentId = VersionEntity::ToContentId(std::move(*versionEntity), m_reportingHandler);
+    std::vector<Content> contents;
+    if (requestParams.productRequests.size() == 1)
+    {
+        auto lookup = LookUpLatestVersion(requestParams.productRequests[0], *connection, true /*allowBatching*/);
+        contents.push_back(std::move(*GetContentForVersion(std::move(lookup), *connection)));
+        return contents;
+    }
 
-    const auto& product = requestParams.productRequests[0].product;
-    auto fileEntities = GetDownloadInfo(product, contentId->GetVersion(), *connection);
-    auto files = GenericFileEntity::FileEntitiesToFileVector(std::move(fileEntities), m_reportingHandler);
+    auto lookups = LookUpLatestVersions(requestParams.productRequests, *connection);
 
-    std::unique_ptr<Content> content;
-    THROW_IF_FAILED_LOG(Content::Make(std::move(contentId), std::move(files), content), m_reportingHandler);
+    // Connections are not thread-safe, so each concurrent request gets its own
+    std::vector<ConnectionConfig> childConfigs;
+    for (size_t i = 0; i < lookups.size(); ++i)
+    {
+        childConfigs.push_back(connection->MakeChildConfig());
+    }
 
-    std::vector<Content> contents;
-    contents.push_back(std::move(*content));
+    LOG_INFO(m_reportingHandler, "Getting download info for %zu products", lookups.size());
+
+    std::vector<std::unique_ptr<Content>> results(lookups.size());
+    m_executor.ParallelFor(lookups.size(), m_maxParallelRequests, [&](size_t i) {
+        const auto childConnection = MakeConnection(childConfigs[i]);
+        results[i] = GetContentForVersion(std::move(lookups[i]), *childConnection);
+    });
+
+    for (auto& content : results)
+    {
+        contents.push_back(std::move(*content));
+    }
 
     return contents;
 }
 SFS_CATCH_LOG_RETHROW(m_reportingHandler)
 
+template <typename ConnectionManagerT>
+std::unique_ptr<Content> SFSClientImpl<ConnectionManagerT>::GetContentForVersion(LatestVersionLookup&& lookup,
+                                                                                 Connection& connection) const
+{
+    auto contentId = VersionEntity::ToContentId(std::move(*lookup.versionEntity), m_reportingHandler);
+
+    FileEntities fileEntities;
+    if (lookup.staleFiles)
+    {
+        LOG_INFO(m_reportingHandler,
+                 "Using the download info cached with version [%s] of [%s]",
+                 contentId->GetVersion().c_str(),
+                 contentId->GetName().c_str());
+        fileEntities = FileEntity::CloneEntities(*lookup.staleFiles);
+    }
+    else
+    {
+        fileEntities = GetDownloadInfo(contentId->GetName(), contentId->GetVersion(), connection);
+        StoreLatestDownloadInfo(lookup.cacheKey, contentId->GetVersion(), fileEntities);
+    }
+    auto files = GenericFileEntity::FileEntitiesToFileVector(std::move(fileEntities), m_reportingHandler);
+
+    std::unique_ptr<Content> content;
+    THROW_IF_FAILED_LOG(Content::Make(std::move(contentId), std::move(files), content), m_reportingHandler);
+
+    return content;
+}
+
 template <typename ConnectionManagerT>
 std::vector<AppContent> SFSClientImpl<ConnectionManagerT>::GetLatestAppDownloadInfo(
     const RequestParams& requestParams) const
 try
 {
-    ValidateRequestParams(requestParams, m_reportingHandler);
+    ValidateAppRequestParams(requestParams, m_reportingHandler);
 
     // TODO #150: For now apps are only coming from the "storeapps" instanceId and the service has requested
     // we double check for it. In the future we should remove this check and allow the user to specify any instanceId
@@ -321,34 +1164,55 @@ try
                       m_reportingHandler,
                       "At this moment only the \"storeapps\" instanceId can send app requests");
 
-    const auto connection = MakeConnection(ConnectionConfig(requestParams));
+    const auto connection = MakeConnection(MakeConnectionConfig(requestParams));
 
-    auto versionEntity = GetLatestVersion(requestParams.productRequests[0], *connection);
+    // App versions are not looked up in batches, as batch responses only describe generic content
+    auto versionEntity =
+        LookUpLatestVersion(requestParams.productRequests[0], *connection, false /*allowBatching*/).versionEntity;
 
     auto appVersionEntity = AppVersionEntity::GetAppVersionEntityPtr(versionEntity, m_reportingHandler);
     auto contentId = AppVersionEntity::ToContentId(std::move(*appVersionEntity), m_reportingHandler);
 
-    LOG_INFO(m_reportingHandler, "Getting download info for main app content");
     const auto& product = requestParams.productRequests[0].product;
-    auto fileEntities = GetDownloadInfo(product, contentId->GetVersion(), *connection);
-    auto files = AppFileEntity::FileEntitiesToAppFileVector(std::move(fileEntities), m_reportingHandler);
 
-    std::vector<AppPrerequisiteContent> prerequisites;
+    std::vector<std::unique_ptr<ContentId>> prereqContentIds;
+    std::vector<ConnectionConfig> prereqConfigs;
     for (auto& prereq : appVersionEntity->prerequisites)
     {
-        LOG_INFO(m_reportingHandler, "Getting download info for prerequisite [%s]", prereq.contentId.name.c_str());
-        auto prereqContentId = GenericVersionEntity::ToContentId(std::move(prereq), m_reportingHandler);
+        prereqContentIds.push_back(GenericVersionEntity::ToContentId(std::move(prereq), m_reportingHandler));
+        prereqConfigs.push_back(connection->MakeChildConfig());
+    }
 
+    // The download info of the main app (index 0) and of each prerequisite (index i + 1) are retrieved concurrently.
+    // Results are stored by index so the prerequisites keep the order given by the service.
+    std::vector<AppFile> files;
+    std::vector<std::unique_ptr<AppPrerequisiteContent>> prereqContents(prereqContentIds.size());
+    m_executor.ParallelFor(prereqContentIds.size() + 1, m_maxParallelRequests, [&](size_t i) {
+        if (i == 0)
+        {
+            LOG_INFO(m_reportingHandler, "Getting download info for main app content");
+            auto fileEntities = GetDownloadInfo(product, contentId->GetVersion(), *connection);
+            files = AppFileEntity::FileEntitiesToAppFileVector(std::move(fileEntities), m_reportingHandler);
+            return;
+        }
+
+        auto& prereqContentId = prereqContentIds[i - 1];
+        LOG_INFO(m_reportingHandler, "Getting download info for prerequisite [%s]", prereqContentId->GetName().c_str());
+
+        const auto prereqConnection = MakeConnection(prereqConfigs[i - 1]);
         auto prereqFileEntities =
-            GetDownloadInfo(prereqContentId->GetName(), prereqContentId->GetVersion(), *connection);
+            GetDownloadInfo(prereqContentId->GetName(), prereqContentId->GetVersion(), *prereqConnection);
         auto prereqFiles =
             AppFileEntity::FileEntitiesToAppFileVector(std::move(prereqFileEntities), m_reportingHandler);
 
-        std::unique_ptr<AppPrerequisiteContent> prereqContent;
         THROW_IF_FAILED_LOG(
-            AppPrerequisiteContent::Make(std::move(prereqContentId), std::move(prereqFiles), prereqContent),
+            AppPrerequisiteContent::Make(std::move(prereqContentId), std::move(prereqFiles), prereqContents[i - 1]),
             m_reportingHandler);
+    });
 
+    std::vector<AppPrerequisiteContent> prerequisites;
+    for (auto& prereqContent : prereqContents)
+    {
         prerequisites.push_back(std::move(*prereqContent));
     }
 
@@ -367,12 +1231,111 @@ try
 }
 SFS_CATCH_LOG_RETHROW(m_reportingHandler)
 
+template <typename ConnectionManagerT>
+void SFSClientImpl<ConnectionManagerT>::RefreshInBackground(const std::string& key,
+                                                            std::function<void(Connection&)> refresh) const
+{
+    {
+        std::lock_guard guard(m_pendingRefreshesMutex);
+        if (!m_pendingRefreshes.insert(key).second)
+        {
+            return;
+        }
+    }
+
+    auto finishRefresh = [this, key]() {
+        std::lock_guard guard(m_pendingRefreshesMutex);
+        m_pendingRefreshes.erase(key);
+    };
+
+    try
+    {
+        m_executor.Post([this, refresh = std::move(refresh), finishRefresh]() {
+            try
+            {
+                const auto connection = MakeConnection(MakeConnectionConfig(RequestParams()));
+                refresh(*connection);
+            }
+            catch (...)
+            {
+                LOG_WARNING(m_reportingHandler, "Failed to refresh a stale cache entry in the background");
+            }
+            finishRefresh();
+        });
+    }
+    catch (...)
+    {
+        LOG_WARNING(m_reportingHandler, "Failed to schedule the refresh of a stale cache entry");
+        finishRefresh();
+    }
+}
+
+template <typename ConnectionManagerT>
+ConnectionConfig SFSClientImpl<ConnectionManagerT>::MakeConnectionConfig(const RequestParams& requestParams) const
+{
+    ConnectionConfig config(requestParams);
+    config.maxResponseSize = m_maxResponseSize;
+    config.maxSpilledResponseSize = m_maxStreamedDownloadInfoSize;
+    config.failFastWhenThrottled = m_failFastWhenThrottled;
+    config.jitterRetryDelays = m_jitterRetryDelays;
+    config.retryBudget = m_retryBudget;
+    config.circuitBreaker = m_circuitBreaker;
+    return config;
+}
+
 template <typename ConnectionManagerT>
 std::unique_ptr<Connection> SFSClientImpl<ConnectionManagerT>::MakeConnection(const ConnectionConfig& config) const
 {
     return m_connectionManager->MakeConnection(config);
 }
 
+template <typename ConnectionManagerT>
+Executor& SFSClientImpl<ConnectionManagerT>::GetExecutor() const
+{
+    return m_executor;
+}
+
+template <typename ConnectionManagerT>
+ClientStatistics SFSClientImpl<ConnectionManagerT>::GetStatistics() const noexcept
+{
+    ClientStatistics statistics;
+    if (m_latestVersionCache)
+    {
+        statistics.latestVersionCache = m_latestVersionCache->GetStatistics();
+    }
+    if (m_downloadInfoCache)
+    {
+        statistics.downloadInfoCache = m_downloadInfoCache->GetStatistics();
+    }
+    if (m_persistentCache)
+    {
+        statistics.persistentCache = m_persistentCache->GetStatistics();
+    }
+    statistics.coalescedRequests =
+        m_latestVersionFlights.GetCoalescedCalls() + m_latestVersionBatchFlights.GetCoalescedCalls() +
+        m_downloadInfoFlights.GetCoalescedCalls();
+    if (m_latestVersionBatcher)
+    {
+        statistics.latestVersionBatches = m_latestVersionBatcher->GetBatchCount();
+        statistics.batchedLatestVersionLookups = m_latestVersionBatcher->GetBatchedLookupCount();
+    }
+    if (m_retryBudget)
+    {
+        statistics.retryBudget = m_retryBudget->GetStatistics();
+    }
+    if (m_circuitBreaker)
+    {
+        statistics.circuitBreakerTrips = m_circuitBreaker->GetTripCount();
+        statistics.circuitBreakerRejections = m_circuitBreaker->GetRejectedCount();
+    }
+    if (m_requestHedger)
+    {
+        statistics.hedgedRequests = m_requestHedger->GetHedgeCount();
+        statistics.hedgeWins = m_requestHedger->GetHedgeWinCount();
+    }
+    return statistics;
+}
+
 template <typename ConnectionManagerT>
 void SFSClientImpl<ConnectionManagerT>::SetCustomBaseUrl(std::string customBaseUrl)
 {
@@ -395,4 +1358,5 @@ std::string SFSClientImpl<ConnectionManagerT>::GetBaseUrl() const
 }
 
 template class SFS::details::SFSClientImpl<CurlConnectionManager>;
+template class SFS::details::SFSClientImpl<CurlMultiConnectionManager>;
 template class SFS::details::SFSClientImpl<MockConnectionManager>;
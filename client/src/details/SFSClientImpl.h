@@ -7,15 +7,28 @@
 
 #include "ClientConfig.h"
 #include "Content.h"
+#include "Executor.h"
+#include "LatestVersionBatcher.h"
 #include "Logging.h"
+#include "LruCache.h"
+#include "PersistentCache.h"
+#include "RequestHedger.h"
 #include "Result.h"
+#include "SingleFlight.h"
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_set>
 
 namespace SFS::details
 {
+class CircuitBreaker;
+class RetryBudget;
+
 template <typename ConnectionManagerT>
 class SFSClientImpl : public SFSClientInterface
 {
@@ -29,7 +42,8 @@ class SFSClientImpl : public SFSClientInterface
 
     /**
      * @brief Retrieve combined metadata & download URLs from the latest version of specified products
-     * @note At the moment only a single product request is supported
+     * @details The versions of multiple products are resolved in a single batch request, and their download info is
+     * then retrieved concurrently. Products unknown to the service are left out of the result.
      * @param requestParams Parameters that define this request
      */
     std::vector<Content> GetLatestDownloadInfo(const RequestParams& requestParams) const override;
@@ -37,6 +51,7 @@ class SFSClientImpl : public SFSClientInterface
     /**
      * @brief Retrieve combined metadata & download URLs from the latest version of specified apps
      * @note At the moment only a single product request is supported
+     * @details The download info of the app and of its prerequisites is retrieved concurrently
      * @param requestParams Parameters that define this request
      */
     std::vector<AppContent> GetLatestAppDownloadInfo(const RequestParams& requestParams) const override;
@@ -85,6 +100,16 @@ class SFSClientImpl : public SFSClientInterface
      */
     std::unique_ptr<Connection> MakeConnection(const ConnectionConfig& config) const override;
 
+    /**
+     * @brief Returns the Executor that runs the asynchronous calls of the SFSClient
+     */
+    Executor& GetExecutor() const override;
+
+    /**
+     * @return A snapshot of the internal counters of the SFSClient
+     */
+    ClientStatistics GetStatistics() const noexcept override;
+
     //
     // Configuration methods
     //
@@ -102,12 +127,213 @@ class SFSClientImpl : public SFSClientInterface
     std::string GetBaseUrl() const;
 
   private:
+    /// @brief Latest version held by m_latestVersionCache
+    struct CachedLatestVersion
+    {
+        std::shared_ptr<const VersionEntity> versionEntity;
+
+        /// @brief Download info of the version, kept so stale hits can answer download info calls in full
+        std::shared_ptr<const FileEntities> files;
+
+        /// @brief Time after which the download URLs of @ref files can no longer be handed out
+        std::chrono::steady_clock::time_point filesExpireAt;
+    };
+
+    /// @brief Result of a latest version lookup
+    struct LatestVersionLookup
+    {
+        std::unique_ptr<VersionEntity> versionEntity;
+        std::string cacheKey;
+
+        /// @brief Download info of the version, set when it comes from a stale cache entry that also holds it
+        std::shared_ptr<const FileEntities> staleFiles;
+    };
+
+    /**
+     * @brief Retrieves the download info of the version found by @param lookup, unless the lookup already carries it
+     * @return The Content made of the version and its files
+     * @throws SFSException if the request fails
+     */
+    std::unique_ptr<Content> GetContentForVersion(LatestVersionLookup&& lookup, Connection& connection) const;
+
+    /**
+     * @brief Gets the latest version of a product from the caches, or else from the service
+     * @param allowBatching Whether the lookup can be sent as part of a batch, if batching is enabled
+     * @throws SFSException if the request fails
+     */
+    LatestVersionLookup LookUpLatestVersion(const ProductRequest& productRequest,
+                                            Connection& connection,
+                                            bool allowBatching) const;
+
+    /**
+     * @brief Gets the latest versions of several products, from the caches for those in them, and from a single batch
+     * request to the service for the others
+     * @return The lookups of the products found, in the order of @param productRequests. Products requested more than
+     * once are only returned once.
+     * @throws SFSException if the request fails
+     */
+    std::vector<LatestVersionLookup> LookUpLatestVersions(const std::vector<ProductRequest>& productRequests,
+                                                          Connection& connection) const;
+
+    /**
+     * @brief Gets the latest version of a product from the in-memory or the persistent cache, under the cache key of
+     * @param lookup, and fills @param lookup with it
+     * @return Whether a usable cached entity was found
+     */
+    bool GetCachedLatestVersion(const ProductRequest& productRequest, LatestVersionLookup& lookup) const;
+
+    /**
+     * @brief Refreshes a stale latest version, along with its download info if @param withDownloadInfo is set
+     * @throws SFSException if the request fails
+     */
+    void RefreshLatestVersion(const ProductRequest& productRequest,
+                              const std::string& cacheKey,
+                              bool withDownloadInfo,
+                              Connection& connection) const;
+
+    /**
+     * @brief Keeps @param files along with the latest version cached under @param cacheKey, if it is still
+     * @param version, so they can be returned by stale hits
+     */
+    void StoreLatestDownloadInfo(const std::string& cacheKey,
+                                 const std::string& version,
+                                 const FileEntities& files) const;
+
+    /**
+     * @brief Requests the latest version of a product to the service, and caches it under @param cacheKey
+     * @throws SFSException if the request fails
+     */
+    std::unique_ptr<VersionEntity> FetchLatestVersion(const ProductRequest& productRequest,
+                                                      const std::string& cacheKey,
+                                                      Connection& connection) const;
+
+    /**
+     * @brief Posts @param body to @param url, and sends the same request again on another connection if the first one
+     * is slow to answer, as decided by m_requestHedger
+     * @details Both requests are made on child connections of @param connection, as the one that loses is cancelled,
+     * which can not be undone. @param connection is only used directly when the request is not hedged.
+     * @return The first successful response
+     * @throws SFSException if the request fails, and its hedge as well if one was sent
+     */
+    std::string PostHedged(const std::string& url, const std::string& body, Connection& connection) const;
+
+    /**
+     * @brief Requests the latest version of a product as part of a batch, and caches it under @param cacheKey
+     * @throws SFSException if the request fails, or HttpNotFound if the service did not return the product
+     */
+    std::unique_ptr<VersionEntity> FetchLatestVersionInBatch(const ProductRequest& productRequest,
+                                                             const std::string& cacheKey,
+                                                             Connection& connection) const;
+
+    /**
+     * @brief Stores @param versionEntity in the caches under @param cacheKey, along with the @param response it was
+     * read from
+     */
+    void StoreLatestVersion(const std::string& cacheKey,
+                            const VersionEntity& versionEntity,
+                            const std::string& response) const;
+
+    /**
+     * @brief Stores @param versionEntity, which was returned in a batch response, in the caches under @param cacheKey
+     */
+    void StoreBatchedLatestVersion(const std::string& cacheKey, const VersionEntity& versionEntity) const;
+
+    /**
+     * @brief Requests the files of a product version to the service, and caches them under @param cacheKey
+     * @throws SFSException if the request fails
+     */
+    FileEntities FetchDownloadInfo(const std::string& product,
+                                   const std::string& version,
+                                   const std::string& cacheKey,
+                                   Connection& connection) const;
+
+    /**
+     * @brief Looks up the latest version stored in the persistent cache under @param cacheKey
+     * @return The stored entity if it is fresh, or if it is stale within the tolerance, in which case it is also
+     * refreshed in the background. nullptr otherwise.
+     */
+    std::unique_ptr<VersionEntity> GetPersistedLatestVersion(const ProductRequest& productRequest,
+                                                             const std::string& cacheKey) const;
+
+    /**
+     * @brief Looks up the files of a product version stored in the persistent cache under @param cacheKey
+     * @return The stored files if they are fresh, or if they are stale within the tolerance, in which case they are
+     * also refreshed in the background. std::nullopt otherwise.
+     */
+    std::optional<FileEntities> GetPersistedDownloadInfo(const std::string& product,
+                                                         const std::string& version,
+                                                         const std::string& cacheKey) const;
+
+    /**
+     * @brief Runs @param refresh from the Executor on a new connection, unless a refresh of @param key is already
+     * pending. Failures are logged and otherwise ignored.
+     */
+    void RefreshInBackground(const std::string& key, std::function<void(Connection&)> refresh) const;
+
+    /**
+     * @brief Returns the config for a new connection that makes the requests of a call with @param requestParams
+     */
+    ConnectionConfig MakeConnectionConfig(const RequestParams& requestParams) const;
+
     std::string m_accountId;
     std::string m_instanceId;
     std::string m_nameSpace;
 
     std::unique_ptr<ConnectionManagerT> m_connectionManager;
 
+    // Maximum number of requests a single call sends at the same time when it fans out
+    unsigned m_maxParallelRequests;
+
+    // Response size limits of every connection. See ClientConfig::maxResponseSize.
+    size_t m_maxResponseSize;
+    size_t m_maxStreamedDownloadInfoSize;
+
+    // See ClientConfig::failFastWhenThrottled
+    bool m_failFastWhenThrottled;
+
+    // See ClientConfig::jitterRetryDelays
+    bool m_jitterRetryDelays;
+
+    // Budget the retries of all connections are drawn from. Only set if enabled through ClientConfig::retryBudgetRatio.
+    std::shared_ptr<RetryBudget> m_retryBudget;
+
+    // Circuit breakers of the hosts requests are sent to. Only set if enabled through
+    // ClientConfig::circuitBreakerFailureThreshold.
+    std::shared_ptr<CircuitBreaker> m_circuitBreaker;
+
+    // Decides when latest version requests are hedged. Only set if enabled through
+    // ClientConfig::latestVersionHedgePercentile.
+    std::unique_ptr<RequestHedger> m_requestHedger;
+
     std::optional<std::string> m_customBaseUrl;
+
+    // Latest version lookups, keyed by request. Only set if enabled through ClientConfig::latestVersionCacheTtl.
+    std::unique_ptr<LruCache<CachedLatestVersion>> m_latestVersionCache;
+    std::chrono::seconds m_latestVersionCacheTtl{0};
+    std::chrono::seconds m_latestVersionCacheStaleWhileRevalidate{0};
+
+    // Download info of product versions. Only set if enabled through ClientConfig::downloadInfoCacheTtl.
+    std::unique_ptr<LruCache<std::shared_ptr<const FileEntities>>> m_downloadInfoCache;
+    std::chrono::seconds m_downloadInfoCacheTtl{0};
+
+    // Responses stored on disk. Only set if enabled through ClientConfig::persistentCacheFile.
+    std::unique_ptr<PersistentCache> m_persistentCache;
+    std::chrono::seconds m_persistentCacheMaxStaleness{0};
+
+    // Groups concurrent latest version lookups into batches. Only set if enabled through
+    // ClientConfig::latestVersionBatchWindow.
+    std::unique_ptr<LatestVersionBatcher> m_latestVersionBatcher;
+
+    // Requests in flight, shared by the identical requests made concurrently
+    mutable SingleFlight<VersionEntity> m_latestVersionFlights;
+    mutable SingleFlight<VersionEntities> m_latestVersionBatchFlights;
+    mutable SingleFlight<FileEntities> m_downloadInfoFlights;
+
+    // Keys of the cache entries being refreshed in the background, so that each is refreshed once at a time
+    mutable std::mutex m_pendingRefreshesMutex;
+    mutable std::unordered_set<std::string> m_pendingRefreshes;
+
+    // Declared last so that it is destroyed first: pending tasks may still use any of the members above
+    mutable Executor m_executor;
 };
 } // namespace SFS::details
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "ClientStatistics.h"
 #include "Logging.h"
 #include "ReportingHandler.h"
 #include "RequestParams.h"
@@ -22,6 +23,7 @@ namespace details
 class Connection;
 class ConnectionManager;
 struct ConnectionConfig;
+class Executor;
 
 class SFSClientInterface
 {
@@ -36,7 +38,7 @@ class SFSClientInterface
 
     /**
      * @brief Retrieve combined metadata & download URLs from the latest version of specified products
-     * @note At the moment only a single product request is supported
+     * @details Products unknown to the service are left out of the result
      * @param requestParams Parameters that define this request
      */
     virtual std::vector<Content> GetLatestDownloadInfo(const RequestParams& requestParams) const = 0;
@@ -92,6 +94,17 @@ class SFSClientInterface
      */
     virtual std::unique_ptr<Connection> MakeConnection(const ConnectionConfig& config) const = 0;
 
+    /**
+     * @brief Returns the Executor that runs the asynchronous calls of the SFSClient
+     * @note Tasks posted to it may use this object, as it only goes away after all of them have run
+     */
+    virtual Executor& GetExecutor() const = 0;
+
+    /**
+     * @return A snapshot of the internal counters of the SFSClient
+     */
+    virtual ClientStatistics GetStatistics() const noexcept = 0;
+
     const ReportingHandler& GetReportingHandler() const
     {
         return m_reportingHandler;
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace SFS::details
+{
+/**
+ * @brief Coalesces identical concurrent calls into a single one
+ * @details While a call for a key is running, other threads asking for the same key wait for it and share its result
+ * instead of making their own call. Once the call finishes, the next one for that key runs again. This class is
+ * thread-safe.
+ */
+template <typename ValueT>
+class SingleFlight
+{
+  public:
+    using ResultPtr = std::shared_ptr<const ValueT>;
+
+    SingleFlight() = default;
+
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+
+    /**
+     * @brief Calls @param fn to produce the value of @param key, unless another thread is already doing so, in which
+     * case waits for that call instead
+     * @return The result of the call, shared by every thread that waited for it. An exception thrown by @param fn is
+     * rethrown to all of them.
+     */
+    template <typename Fn>
+    ResultPtr Do(const std::string& key, Fn&& fn)
+    {
+        return Do(key, std::forward<Fn>(fn), [](const std::exception_ptr&) { return true; });
+    }
+
+    /**
+     * @brief Like Do(key, fn), but only shares the exceptions thrown by @param fn for which @param isSharedError
+     * returns true
+     * @details @param isSharedError is called by the thread that ran @param fn. Other exceptions are only rethrown to
+     * that thread, as they are specific to it, such as its call being cancelled. The threads that waited for it then
+     * make their own call, or wait for one started in the meantime.
+     */
+    template <typename Fn, typename IsSharedErrorFn>
+    ResultPtr Do(const std::string& key, Fn&& fn, IsSharedErrorFn&& isSharedError)
+    {
+        while (true)
+        {
+            std::promise<ResultPtr> promise;
+            std::shared_future<ResultPtr> pendingCall;
+            {
+                std::lock_guard guard(m_mutex);
+                if (auto it = m_calls.find(key); it != m_calls.end())
+                {
+                    pendingCall = it->second;
+                    ++m_coalescedCalls;
+                }
+                else
+                {
+                    m_calls.emplace(key, promise.get_future().share());
+                }
+            }
+
+            if (pendingCall.valid())
+            {
+                try
+                {
+                    return pendingCall.get();
+                }
+                catch (const UnsharedError&)
+                {
+                    continue;
+                }
+            }
+
+            // The key is released before the result is published, so that callers arriving later make a new call
+            try
+            {
+                ResultPtr result = fn();
+                Finish(key);
+                promise.set_value(result);
+                return result;
+            }
+            catch (...)
+            {
+                Finish(key);
+                const auto error = std::current_exception();
+                promise.set_exception(isSharedError(error) ? error : std::make_exception_ptr(UnsharedError{}));
+                throw;
+            }
+        }
+    }
+
+    /**
+     * @return Number of calls that waited for an identical one in flight instead of being made
+     */
+    uint64_t GetCoalescedCalls() const
+    {
+        return m_coalescedCalls;
+    }
+
+  private:
+    /// @brief Published instead of an exception that is not shared, so waiting threads know to make their own call
+    struct UnsharedError
+    {
+    };
+
+    void Finish(const std::string& key)
+    {
+        std::lock_guard guard(m_mutex);
+        m_calls.erase(key);
+    }
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_future<ResultPtr>> m_calls;
+    std::atomic<uint64_t> m_coalescedCalls{0};
+};
+} // namespace SFS::details
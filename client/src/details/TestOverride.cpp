@@ -24,6 +24,8 @@ std::string test::GetEnvVarNameFromOverride(TestOverride override)
         return "SFS_TEST_BASE_RETRY_DELAY_MS";
     case TestOverride::BaseUrl:
         return "SFS_TEST_OVERRIDE_BASE_URL";
+    case TestOverride::Http2PriorKnowledge:
+        return "SFS_TEST_HTTP2_PRIOR_KNOWLEDGE";
     }
     return "";
 }
@@ -18,8 +18,9 @@ bool AreTestOverridesAllowed();
 
 enum class TestOverride
 {
-    BaseRetryDelayMs, // Integer. Allows one to override the base retry delay.
-    BaseUrl,          // String. Allows one to override the base URL used for all requests
+    BaseRetryDelayMs,    // Integer. Allows one to override the base retry delay.
+    BaseUrl,             // String. Allows one to override the base URL used for all requests
+    Http2PriorKnowledge, // Integer. If non-zero, HTTP/2 is used without negotiation, which works with h2c servers
 };
 
 /**
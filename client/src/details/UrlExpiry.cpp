@@ -0,0 +1,213 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "UrlExpiry.h"
+
+#include "Util.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <string>
+
+using namespace SFS::details;
+using namespace SFS::details::util;
+using namespace std::chrono;
+
+namespace
+{
+using TimePoint = system_clock::time_point;
+
+std::string PercentDecode(std::string_view value)
+{
+    std::string decoded;
+    decoded.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        if (value[i] == '%' && i + 2 < value.size() && std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(value[i + 2])))
+        {
+            decoded += static_cast<char>(std::stoi(std::string(value.substr(i + 1, 2)), nullptr, 16));
+            i += 2;
+        }
+        else
+        {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+std::optional<int64_t> ParseInteger(std::string_view value)
+{
+    int64_t result = 0;
+    const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc() || ptr != value.data() + value.size())
+    {
+        return std::nullopt;
+    }
+    return result;
+}
+
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar. Avoids timegm(), which is not portable.
+int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+std::optional<TimePoint> MakeUtcTime(std::string_view year,
+                                     std::string_view month,
+                                     std::string_view day,
+                                     std::string_view hour = "0",
+                                     std::string_view minute = "0",
+                                     std::string_view second = "0")
+{
+    const auto y = ParseInteger(year);
+    const auto mo = ParseInteger(month);
+    const auto d = ParseInteger(day);
+    const auto h = ParseInteger(hour);
+    const auto mi = ParseInteger(minute);
+    const auto s = ParseInteger(second);
+    if (!y || !mo || !d || !h || !mi || !s || *mo < 1 || *mo > 12 || *d < 1 || *d > 31)
+    {
+        return std::nullopt;
+    }
+
+    const int64_t days = DaysFromCivil(*y, static_cast<unsigned>(*mo), static_cast<unsigned>(*d));
+    return TimePoint(seconds(days * 86400 + *h * 3600 + *mi * 60 + *s));
+}
+
+// ISO 8601 as used by Azure SAS: YYYY-MM-DD, optionally followed by Thh:mm or Thh:mm:ss, and a Z
+std::optional<TimePoint> ParseIso8601(std::string_view value)
+{
+    if (!value.empty() && value.back() == 'Z')
+    {
+        value.remove_suffix(1);
+    }
+    if (value.size() < 10 || value[4] != '-' || value[7] != '-')
+    {
+        return std::nullopt;
+    }
+    if (value.size() == 10)
+    {
+        return MakeUtcTime(value.substr(0, 4), value.substr(5, 2), value.substr(8, 2));
+    }
+    if (value[10] != 'T' || value.size() < 16 || value[13] != ':')
+    {
+        return std::nullopt;
+    }
+    if (value.size() == 16)
+    {
+        return MakeUtcTime(value.substr(0, 4),
+                           value.substr(5, 2),
+                           value.substr(8, 2),
+                           value.substr(11, 2),
+                           value.substr(14, 2));
+    }
+    if (value.size() != 19 || value[16] != ':')
+    {
+        return std::nullopt;
+    }
+    return MakeUtcTime(value.substr(0, 4),
+                       value.substr(5, 2),
+                       value.substr(8, 2),
+                       value.substr(11, 2),
+                       value.substr(14, 2),
+                       value.substr(17, 2));
+}
+
+// ISO 8601 basic format as used by AWS SigV4: YYYYMMDDThhmmssZ
+std::optional<TimePoint> ParseIso8601Basic(std::string_view value)
+{
+    if (value.size() != 16 || value[8] != 'T' || value[15] != 'Z')
+    {
+        return std::nullopt;
+    }
+    return MakeUtcTime(value.substr(0, 4),
+                       value.substr(4, 2),
+                       value.substr(6, 2),
+                       value.substr(9, 2),
+                       value.substr(11, 2),
+                       value.substr(13, 2));
+}
+
+std::optional<TimePoint> ParseEpochSeconds(std::string_view value)
+{
+    const auto epoch = ParseInteger(value);
+    if (!epoch || *epoch <= 0)
+    {
+        return std::nullopt;
+    }
+    return TimePoint(seconds(*epoch));
+}
+
+void KeepEarliest(std::optional<TimePoint>& earliest, const std::optional<TimePoint>& candidate)
+{
+    if (candidate && (!earliest || *candidate < *earliest))
+    {
+        earliest = candidate;
+    }
+}
+} // namespace
+
+std::optional<TimePoint> SFS::details::GetUrlExpiry(std::string_view url)
+{
+    const size_t queryStart = url.find('?');
+    if (queryStart == std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+
+    std::string_view query = url.substr(queryStart + 1);
+    if (const size_t fragmentStart = query.find('#'); fragmentStart != std::string_view::npos)
+    {
+        query = query.substr(0, fragmentStart);
+    }
+
+    std::optional<TimePoint> expiry;
+    std::optional<TimePoint> amzDate;
+    std::optional<int64_t> amzExpires;
+    while (!query.empty())
+    {
+        const size_t paramEnd = query.find('&');
+        const std::string_view param = query.substr(0, paramEnd);
+        query = paramEnd == std::string_view::npos ? std::string_view() : query.substr(paramEnd + 1);
+
+        const size_t equals = param.find('=');
+        if (equals == std::string_view::npos)
+        {
+            continue;
+        }
+
+        const std::string_view name = param.substr(0, equals);
+        const std::string value = PercentDecode(param.substr(equals + 1));
+        if (name == "se")
+        {
+            KeepEarliest(expiry, ParseIso8601(value));
+        }
+        else if (AreEqualI(name, "Expires") || name == "P1")
+        {
+            KeepEarliest(expiry, ParseEpochSeconds(value));
+        }
+        else if (AreEqualI(name, "X-Amz-Date"))
+        {
+            amzDate = ParseIso8601Basic(value);
+        }
+        else if (AreEqualI(name, "X-Amz-Expires"))
+        {
+            amzExpires = ParseInteger(value);
+        }
+    }
+
+    if (amzDate && amzExpires)
+    {
+        KeepEarliest(expiry, *amzDate + seconds(*amzExpires));
+    }
+
+    return expiry;
+}
@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+namespace SFS::details
+{
+/**
+ * @brief Reads the expiry time encoded in the query of a pre-signed download @param url, if any
+ * @details Recognizes the expiry parameters of the URL signing schemes used by common CDNs and storage services:
+ * "se" (Azure Storage SAS), "X-Amz-Date" with "X-Amz-Expires" (AWS SigV4), "Expires" (epoch seconds, used by
+ * CloudFront and others) and "P1" (epoch seconds, used by Microsoft delivery CDNs).
+ * @return The earliest expiry found, or std::nullopt if the URL does not encode one
+ */
+std::optional<std::chrono::system_clock::time_point> GetUrlExpiry(std::string_view url);
+} // namespace SFS::details
@@ -19,3 +19,11 @@ bool util::AreNotEqualI(std::string_view a, std::string_view b)
 {
     return !AreEqualI(a, b);
 }
+
+std::string_view util::GetHostKey(std::string_view url)
+{
+    const size_t schemeEnd = url.find("://");
+    const size_t hostStart = schemeEnd == std::string_view::npos ? 0 : schemeEnd + 3;
+    const size_t hostEnd = url.find_first_of("/?#", hostStart);
+    return url.substr(0, hostEnd);
+}
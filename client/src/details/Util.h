@@ -9,4 +9,7 @@ namespace SFS::details::util
 {
 bool AreEqualI(std::string_view a, std::string_view b);
 bool AreNotEqualI(std::string_view a, std::string_view b);
+
+/// @brief Returns the part of @param url that identifies its host: the scheme, the name and the port
+std::string_view GetHostKey(std::string_view url);
 } // namespace SFS::details::util
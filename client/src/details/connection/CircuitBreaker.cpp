@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "CircuitBreaker.h"
+
+#include "../Util.h"
+
+using namespace SFS::details;
+
+CircuitBreaker::CircuitBreaker(unsigned failureThreshold, std::chrono::milliseconds coolDown)
+    : m_failureThreshold(failureThreshold)
+    , m_coolDown(coolDown)
+{
+}
+
+bool CircuitBreaker::AllowRequest(std::string_view url, bool* isProbe)
+{
+    if (isProbe)
+    {
+        *isProbe = false;
+    }
+
+    std::lock_guard guard(m_mutex);
+    auto it = m_hosts.find(std::string(util::GetHostKey(url)));
+    if (it == m_hosts.end())
+    {
+        return true;
+    }
+
+    auto& host = it->second;
+    switch (host.state)
+    {
+    case State::Closed:
+        return true;
+    case State::Open:
+        if (std::chrono::steady_clock::now() >= host.openUntil)
+        {
+            // This request is the probe. The others are rejected until it completes.
+            host.state = State::HalfOpen;
+            if (isProbe)
+            {
+                *isProbe = true;
+            }
+            return true;
+        }
+        break;
+    case State::HalfOpen:
+        break;
+    }
+
+    ++m_rejectedCount;
+    return false;
+}
+
+void CircuitBreaker::OnSuccess(std::string_view url, bool isProbe)
+{
+    std::lock_guard guard(m_mutex);
+    auto it = m_hosts.find(std::string(util::GetHostKey(url)));
+    if (it == m_hosts.end())
+    {
+        return;
+    }
+
+    // An attempt let through before the breaker opened says nothing about the host since, only the probe does. Hosts
+    // are only tracked once they fail, so that the common case keeps the map small.
+    const State state = it->second.state;
+    if (state == State::Closed || (state == State::HalfOpen && isProbe))
+    {
+        m_hosts.erase(it);
+    }
+}
+
+void CircuitBreaker::OnFailure(std::string_view url, bool isProbe)
+{
+    std::lock_guard guard(m_mutex);
+    auto& host = m_hosts[std::string(util::GetHostKey(url))];
+    const auto now = std::chrono::steady_clock::now();
+    switch (host.state)
+    {
+    case State::Closed:
+        if (++host.consecutiveFailures >= m_failureThreshold)
+        {
+            Open(host, now);
+        }
+        break;
+    case State::HalfOpen:
+        if (isProbe)
+        {
+            Open(host, now);
+        }
+        break;
+    case State::Open:
+        // An attempt let through before the breaker opened
+        break;
+    }
+}
+
+void CircuitBreaker::OnAbandoned(std::string_view url, bool isProbe)
+{
+    std::lock_guard guard(m_mutex);
+    auto it = m_hosts.find(std::string(util::GetHostKey(url)));
+    if (isProbe && it != m_hosts.end() && it->second.state == State::HalfOpen)
+    {
+        // The probe did not tell whether the host recovered, so the next request probes it instead
+        it->second.state = State::Open;
+    }
+}
+
+uint64_t CircuitBreaker::GetTripCount() const
+{
+    std::lock_guard guard(m_mutex);
+    return m_tripCount;
+}
+
+uint64_t CircuitBreaker::GetRejectedCount() const
+{
+    std::lock_guard guard(m_mutex);
+    return m_rejectedCount;
+}
+
+void CircuitBreaker::Open(HostState& host, std::chrono::steady_clock::time_point now)
+{
+    host.state = State::Open;
+    host.openUntil = now + m_coolDown;
+    host.consecutiveFailures = 0;
+    ++m_tripCount;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace SFS::details
+{
+/**
+ * @brief Circuit breakers for the hosts requests are sent to, which stop sending requests to a failing host
+ * @details Each host starts closed and lets every request through. After @param failureThreshold consecutive failed
+ * attempts, such as 5xx responses, timeouts or connection errors, it opens and rejects requests for @param coolDown.
+ * It then turns half-open and lets a single probe request through: the breaker closes again if the probe succeeds,
+ * and opens for another cool-down if it fails. Hosts are identified by the scheme, name and port of the URLs sent to
+ * them. This class is thread-safe.
+ */
+class CircuitBreaker
+{
+  public:
+    CircuitBreaker(unsigned failureThreshold, std::chrono::milliseconds coolDown);
+
+    CircuitBreaker(const CircuitBreaker&) = delete;
+    CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+
+    /**
+     * @brief Returns whether an attempt of a request to @param url can be made
+     * @details Once a half-open breaker lets a probe through, the outcome of the probe must be reported with
+     * OnSuccess(), OnFailure() or OnAbandoned() before any other request is let through.
+     * @param isProbe If set, receives whether the attempt is the probe of a half-open breaker
+     */
+    bool AllowRequest(std::string_view url, bool* isProbe = nullptr);
+
+    /**
+     * @brief Reports that the host of @param url answered an attempt, even with an error of the request itself
+     * @details Closes a half-open breaker only if @param isProbe is set. Attempts that were let through before the
+     * breaker opened do not change an open or half-open breaker when they complete.
+     */
+    void OnSuccess(std::string_view url, bool isProbe);
+
+    /// @brief Reports that an attempt of a request to @param url failed because of the host, as OnSuccess() does
+    void OnFailure(std::string_view url, bool isProbe);
+
+    /// @brief Reports that an attempt of a request to @param url ended without telling anything about the host
+    void OnAbandoned(std::string_view url, bool isProbe);
+
+    /// @brief Number of times a breaker opened
+    uint64_t GetTripCount() const;
+
+    /// @brief Number of attempts rejected by an open breaker
+    uint64_t GetRejectedCount() const;
+
+  private:
+    enum class State
+    {
+        Closed,
+        Open,
+        HalfOpen,
+    };
+
+    struct HostState
+    {
+        State state{State::Closed};
+        unsigned consecutiveFailures{0};
+        std::chrono::steady_clock::time_point openUntil;
+    };
+
+    void Open(HostState& host, std::chrono::steady_clock::time_point now);
+
+    const unsigned m_failureThreshold;
+    const std::chrono::milliseconds m_coolDown;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, HostState> m_hosts;
+    uint64_t m_tripCount{0};
+    uint64_t m_rejectedCount{0};
+};
+} // namespace SFS::details
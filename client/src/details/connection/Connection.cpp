@@ -13,9 +13,81 @@ Connection::Connection(const ConnectionConfig& config, const ReportingHandler& h
         m_cv = std::move(CorrelationVector(*config.baseCV, m_handler));
     }
     m_maxRetries = config.maxRetries;
+    m_retryDeadline = config.retryDeadline;
+    m_failFastWhenThrottled = config.failFastWhenThrottled;
+    m_jitterRetryDelays = config.jitterRetryDelays;
+    m_retryBudget = config.retryBudget;
+    m_circuitBreaker = config.circuitBreaker;
+    m_maxResponseSize = config.maxResponseSize;
+    m_maxSpilledResponseSize = config.maxSpilledResponseSize;
 }
 
 std::string Connection::Post(const std::string& url)
 {
     return Post(url, {});
 }
+
+std::future<std::string> Connection::GetAsync(const std::string& url)
+{
+    std::promise<std::string> promise;
+    try
+    {
+        promise.set_value(Get(url));
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+    return promise.get_future();
+}
+
+std::future<std::string> Connection::PostAsync(const std::string& url, const std::string& data)
+{
+    std::promise<std::string> promise;
+    try
+    {
+        promise.set_value(Post(url, data));
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+    return promise.get_future();
+}
+
+StreamingResponse Connection::PostStreaming(const std::string& url)
+{
+    StreamingResponse response;
+    response.body = Post(url);
+    return response;
+}
+
+void Connection::Cancel()
+{
+    m_cancelled = true;
+}
+
+bool Connection::HasRetryDeadline() const
+{
+    return m_retryDeadline.has_value();
+}
+
+ConnectionConfig Connection::MakeChildConfig()
+{
+    ConnectionConfig config;
+    config.maxRetries = m_maxRetries;
+    config.retryDeadline = m_retryDeadline;
+    config.failFastWhenThrottled = m_failFastWhenThrottled;
+    config.jitterRetryDelays = m_jitterRetryDelays;
+    config.retryBudget = m_retryBudget;
+    config.circuitBreaker = m_circuitBreaker;
+    config.maxResponseSize = m_maxResponseSize;
+    config.maxSpilledResponseSize = m_maxSpilledResponseSize;
+    config.baseCV = m_cv.IncrementAndGet();
+    return config;
+}
+
+std::string& Connection::GetRequestBodyBuffer()
+{
+    return m_requestBodyBuffer;
+}
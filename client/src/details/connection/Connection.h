@@ -6,12 +6,41 @@
 #include "../CorrelationVector.h"
 #include "ConnectionConfig.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
 
 namespace SFS::details
 {
 class ReportingHandler;
 
+struct FileCloser
+{
+    void operator()(std::FILE* file) const
+    {
+        std::fclose(file);
+    }
+};
+
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+/// @brief Response of Connection::PostStreaming()
+struct StreamingResponse
+{
+    /// @brief The response body, if it was kept in memory
+    std::string body;
+
+    /**
+     * @brief Temporary file holding the response body, positioned at its start, if it was too large to be kept in
+     * memory. The file is deleted once closed.
+     */
+    FilePtr spillFile;
+};
+
 class Connection
 {
   public:
@@ -45,6 +74,56 @@ class Connection
      */
     std::string Post(const std::string& url);
 
+    /**
+     * @brief Starts a GET request to the given @param url
+     * @details Connections able to run requests in the background return before the request is done, including its
+     * retries. By default the request is performed before returning. Either way, the connection is not used for another
+     * request until it is done, and destroying the connection cancels the request.
+     * @return A future for the response body, which holds an SFSException if the request fails
+     */
+    virtual std::future<std::string> GetAsync(const std::string& url);
+
+    /**
+     * @brief Starts a POST request to the given @param url with @param data as the request body, as GetAsync() does
+     * @return A future for the response body, which holds an SFSException if the request fails
+     */
+    virtual std::future<std::string> PostAsync(const std::string& url, const std::string& data);
+
+    /**
+     * @brief Perform a POST request to the given @param url, whose response may be too large to be kept in memory
+     * @details A response over ConnectionConfig::maxResponseSize is written to a temporary file as it is received,
+     * up to ConnectionConfig::maxSpilledResponseSize, so it can then be parsed incrementally. By default the response
+     * is kept in memory, as with Post().
+     * @throws SFSException if the request fails
+     */
+    virtual StreamingResponse PostStreaming(const std::string& url);
+
+    /**
+     * @brief Cancels the request in progress, if any, and the ones made afterwards
+     * @details A retry waiting for its turn is abandoned right away. The cancelled requests fail with
+     * ConnectionCancelled. Can be called from any thread.
+     */
+    virtual void Cancel();
+
+    /**
+     * @brief Returns the config for a new connection that makes requests on behalf of this one
+     * @details The new connection keeps the settings of this one, and its correlation vector extends the next increment
+     * of this connection's, so requests made concurrently through several connections stay correlated but distinct.
+     */
+    ConnectionConfig MakeChildConfig();
+
+    /**
+     * @return Whether the retries of this connection stop at a deadline, set with ConnectionConfig::retryDeadline
+     */
+    bool HasRetryDeadline() const;
+
+    /**
+     * @brief Returns a buffer to build request bodies in
+     * @details The buffer lives as long as the connection, so building the bodies of successive requests in it reuses
+     * its allocation.
+     */
+    std::string& GetRequestBodyBuffer();
+
   protected:
     const ReportingHandler& m_handler;
 
@@ -53,5 +132,32 @@ class Connection
 
     /// @brief Expected number of retries for a web request after a failed attempt
     unsigned m_maxRetries{3};
+
+    /// @brief Point in time after which no retry is started
+    std::optional<std::chrono::steady_clock::time_point> m_retryDeadline;
+
+    /// @brief Fails requests to a host that asked with Retry-After to wait, instead of waiting for it
+    bool m_failFastWhenThrottled{false};
+
+    /// @brief Spreads the delays between retries randomly, with decorrelated jitter
+    bool m_jitterRetryDelays{false};
+
+    /// @brief Budget the retries are drawn from, if any
+    std::shared_ptr<RetryBudget> m_retryBudget;
+
+    /// @brief Circuit breakers of the hosts requests are sent to, if any
+    std::shared_ptr<CircuitBreaker> m_circuitBreaker;
+
+    /// @brief Set once Cancel() is called
+    std::atomic<bool> m_cancelled{false};
+
+    /// @brief Maximum size in bytes of a response kept in memory
+    size_t m_maxResponseSize{100000};
+
+    /// @brief Maximum size in bytes of a response written to a temporary file by PostStreaming(), or 0 if disabled
+    size_t m_maxSpilledResponseSize{0};
+
+  private:
+    std::string m_requestBodyBuffer;
 };
 } // namespace SFS::details
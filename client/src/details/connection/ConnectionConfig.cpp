@@ -10,6 +10,7 @@ using namespace SFS::details;
 
 ConnectionConfig::ConnectionConfig(const SFS::RequestParams& requestParams)
     : maxRetries(requestParams.retryOnError ? c_maxRetries : 0)
+    , retryDeadline(requestParams.retryDeadline)
     , baseCV(requestParams.baseCV)
 {
 }
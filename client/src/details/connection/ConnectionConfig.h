@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -12,6 +15,9 @@ struct RequestParams;
 
 namespace details
 {
+class CircuitBreaker;
+class RetryBudget;
+
 struct ConnectionConfig
 {
     ConnectionConfig() = default;
@@ -20,8 +26,33 @@ struct ConnectionConfig
     /// @brief Expected number of retries for a web request after a failed attempt
     unsigned maxRetries{3};
 
+    /// @brief Point in time after which no retry is started
+    std::optional<std::chrono::steady_clock::time_point> retryDeadline;
+
+    /// @brief Fails requests to a host that asked with Retry-After to wait, instead of waiting for it
+    bool failFastWhenThrottled{false};
+
+    /// @brief Spreads the delays between retries randomly, with decorrelated jitter
+    bool jitterRetryDelays{false};
+
+    /// @brief Budget the retries are drawn from, shared with other connections. Retries are not bounded if not set
+    std::shared_ptr<RetryBudget> retryBudget;
+
+    /// @brief Circuit breakers of the hosts requests are sent to, shared with other connections. Not used if not set
+    std::shared_ptr<CircuitBreaker> circuitBreaker;
+
     /// @brief The correlation vector to use for requests
     std::optional<std::string> baseCV;
+
+    /// @brief Maximum size in bytes of a response kept in memory. Larger responses fail, unless they can be spilled
+    size_t maxResponseSize{100000};
+
+    /**
+     * @brief Maximum size in bytes of a response received through Connection::PostStreaming(), which writes responses
+     * over maxResponseSize to a temporary file instead of failing
+     * @details Set to 0 to fail those responses as well.
+     */
+    size_t maxSpilledResponseSize{0};
 };
 } // namespace details
 } // namespace SFS
@@ -7,7 +7,9 @@
 
 using namespace SFS::details;
 
-ConnectionManager::ConnectionManager(const ReportingHandler& handler) : m_handler(handler)
+ConnectionManager::ConnectionManager(const ReportingHandler& handler, const ConnectionManagerConfig& config)
+    : m_handler(handler)
+    , m_config(config)
 {
 }
 
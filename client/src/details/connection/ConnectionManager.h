@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "ConnectionManagerConfig.h"
+
 #include <memory>
 
 namespace SFS::details
@@ -14,7 +16,7 @@ struct ConnectionConfig;
 class ConnectionManager
 {
   public:
-    ConnectionManager(const ReportingHandler& handler);
+    ConnectionManager(const ReportingHandler& handler, const ConnectionManagerConfig& config = {});
     virtual ~ConnectionManager();
 
     ConnectionManager(const ConnectionManager&) = delete;
@@ -24,5 +26,6 @@ class ConnectionManager
 
   protected:
     const ReportingHandler& m_handler;
+    const ConnectionManagerConfig m_config;
 };
 } // namespace SFS::details
@@ -0,0 +1,16 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "ConnectionManagerConfig.h"
+
+#include "ClientConfig.h"
+
+using namespace SFS;
+using namespace SFS::details;
+
+ConnectionManagerConfig::ConnectionManagerConfig(const ClientConfig& clientConfig)
+    : maxIdleConnections(clientConfig.maxIdleConnections)
+    , idleConnectionTimeout(clientConfig.idleConnectionTimeout)
+    , useHttp2(clientConfig.useHttp2)
+{
+}
@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+
+namespace SFS
+{
+struct ClientConfig;
+
+namespace details
+{
+struct ConnectionManagerConfig
+{
+    ConnectionManagerConfig() = default;
+    explicit ConnectionManagerConfig(const ClientConfig& clientConfig);
+
+    /// @brief Maximum number of idle connections kept alive to be reused by later requests
+    unsigned maxIdleConnections{4};
+
+    /// @brief Time an idle connection can be kept before it is discarded
+    std::chrono::seconds idleConnectionTimeout{60};
+
+    /// @brief Multiplexes concurrent requests over HTTP/2 connections. Only used by the CurlMultiConnectionManager
+    bool useHttp2{false};
+};
+} // namespace details
+} // namespace SFS
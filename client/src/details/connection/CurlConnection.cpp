@@ -6,14 +6,24 @@
 #include "../ErrorHandling.h"
 #include "../ReportingHandler.h"
 #include "../TestOverride.h"
+#include "CircuitBreaker.h"
+#include "CurlHandlePool.h"
+#include "CurlHeaderList.h"
+#include "CurlMultiEngine.h"
 #include "HttpHeader.h"
+#include "RetryAfterGate.h"
+#include "RetryBudget.h"
 
 #include <curl/curl.h>
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <cstdio>
 #include <cstring>
+#include <future>
 #include <optional>
-#include <thread>
+#include <random>
 
 #define THROW_IF_CURL_ERROR(curlCall, error)                                                                           \
     do                                                                                                                 \
@@ -26,36 +36,138 @@
 #define THROW_IF_CURL_SETUP_ERROR(curlCall) THROW_IF_CURL_ERROR(curlCall, ConnectionSetupFailed)
 #define THROW_IF_CURL_UNEXPECTED_ERROR(curlCall) THROW_IF_CURL_ERROR(curlCall, ConnectionUnexpectedError)
 
-// Setting a hard limit of 100k characters for the response to avoid rogue servers sending huge amounts of data
-#define MAX_RESPONSE_CHARACTERS 100000
-
 using namespace SFS;
 using namespace SFS::details;
 using namespace std::chrono_literals;
 
 namespace
 {
-// Curl callback for writing data to a std::string. Must return the number of bytes written.
+// Destination of a response body. The body is kept in the read buffer up to the in-memory limit, which guards against
+// rogue servers sending huge amounts of data. Past that limit, the body is moved to a temporary file if the request
+// allows it, up to a limit of its own.
+class ResponseSink
+{
+  public:
+    ResponseSink(std::string& readBuffer, FilePtr& spillFile, size_t maxSize, size_t maxSpilledSize)
+        : m_readBuffer(readBuffer)
+        , m_spillFile(spillFile)
+        , m_maxSize(maxSize)
+        , m_maxSpilledSize(maxSpilledSize)
+    {
+    }
+
+    // Discards the data of a previous attempt of the request
+    void Reset()
+    {
+        m_readBuffer.clear();
+        m_spillFile.reset();
+        m_spilledSize = 0;
+    }
+
+    // Prepares for a body of @param size bytes. Returns false if it is over the limits.
+    bool Expect(uint64_t size)
+    {
+        if (size <= m_maxSize)
+        {
+            m_readBuffer.reserve(static_cast<size_t>(size));
+            return true;
+        }
+        return size <= m_maxSpilledSize;
+    }
+
+    // Returns false if the data would go over the limits or could not be written
+    bool Append(const char* data, size_t size)
+    {
+        if (!m_spillFile && m_readBuffer.length() + size <= m_maxSize)
+        {
+            m_readBuffer.append(data, size);
+            return true;
+        }
+
+        if (m_spilledSize + m_readBuffer.length() + size > m_maxSpilledSize)
+        {
+            return false;
+        }
+
+        if (!m_spillFile)
+        {
+            m_spillFile.reset(std::tmpfile());
+            if (!m_spillFile || !Write(m_readBuffer.data(), m_readBuffer.length()))
+            {
+                return false;
+            }
+            m_readBuffer.clear();
+        }
+        return Write(data, size);
+    }
+
+  private:
+    bool Write(const char* data, size_t size)
+    {
+        if (std::fwrite(data, 1, size, m_spillFile.get()) != size)
+        {
+            return false;
+        }
+        m_spilledSize += size;
+        return true;
+    }
+
+    std::string& m_readBuffer;
+    FilePtr& m_spillFile;
+    size_t m_maxSize;
+    size_t m_maxSpilledSize;
+    size_t m_spilledSize{0};
+};
+
+// Curl callback for writing data to a ResponseSink. Must return the number of bytes written.
 // This callback may be called multiple times for a single request, and will keep appending
 // to userData until the request is complete. The data received is not null-terminated.
 // For SFS, this data will likely be a JSON string.
 size_t WriteCallback(char* contents, size_t sizeInBytes, size_t numElements, void* userData)
 {
-    auto readBufferPtr = static_cast<std::string*>(userData);
-    if (readBufferPtr)
+    auto sink = static_cast<ResponseSink*>(userData);
+    const size_t totalSize = sizeInBytes * numElements;
+
+    // Checking final response size to avoid unexpected amounts of data
+    if (!sink || !sink->Append(contents, totalSize))
     {
-        size_t totalSize = sizeInBytes * numElements;
+        return CURL_WRITEFUNC_ERROR;
+    }
+    return totalSize;
+}
 
-        // Checking final response size to avoid unexpected amounts of data
-        if ((readBufferPtr->length() + totalSize) > MAX_RESPONSE_CHARACTERS)
-        {
-            return CURL_WRITEFUNC_ERROR;
-        }
+// Curl callback for each header line of the response. Must return the number of bytes handled.
+// When the response announces its size with Content-Length, the read buffer is reserved for it so the body is appended
+// without reallocations, and a response over the limit is rejected before its body is received. For a compressed
+// response, Content-Length is the compressed size, which the decompressed body can only exceed.
+size_t HeaderCallback(char* contents, size_t sizeInBytes, size_t numElements, void* userData)
+{
+    const size_t totalSize = sizeInBytes * numElements;
+    auto sink = static_cast<ResponseSink*>(userData);
+    const auto value = GetHeaderValue(std::string_view(contents, totalSize), HttpHeader::ContentLength);
+    if (!sink || !value)
+    {
+        return totalSize;
+    }
 
-        readBufferPtr->append(contents, totalSize);
+    // A malformed value is left for curl to deal with
+    uint64_t contentLength = 0;
+    const char* end = value->data() + value->size();
+    const auto [ptr, error] = std::from_chars(value->data(), end, contentLength);
+    if (error != std::errc() || ptr != end)
+    {
         return totalSize;
     }
-    return CURL_WRITEFUNC_ERROR;
+
+    return sink->Expect(contentLength) ? totalSize : 0;
+}
+
+// Curl callback called periodically during a transfer. Returning non-zero aborts the transfer with
+// CURLE_ABORTED_BY_CALLBACK, which is done once the connection is cancelled.
+int ProgressCallback(void* userData, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    const auto cancelled = static_cast<const std::atomic<bool>*>(userData);
+    return cancelled && *cancelled ? 1 : 0;
 }
 
 struct CurlErrorBuffer
@@ -203,6 +315,87 @@ std::optional<std::string> GetResponseHeader(CURL* handle,
     return std::nullopt;
 }
 
+// Reports the outcome of an attempt to a circuit breaker, if any. An attempt that ends without an outcome, such as
+// when it is cancelled or fails on the client side, is reported as abandoned, so that a probe let through by a
+// half-open breaker is always accounted for.
+class CircuitBreakerAttempt
+{
+  public:
+    CircuitBreakerAttempt(CircuitBreaker* breaker, std::string_view url, bool isProbe)
+        : m_breaker(breaker)
+        , m_url(url)
+        , m_isProbe(isProbe)
+    {
+    }
+
+    ~CircuitBreakerAttempt()
+    {
+        if (m_breaker && !m_isReported)
+        {
+            m_breaker->OnAbandoned(m_url, m_isProbe);
+        }
+    }
+
+    CircuitBreakerAttempt(const CircuitBreakerAttempt&) = delete;
+    CircuitBreakerAttempt& operator=(const CircuitBreakerAttempt&) = delete;
+
+    void OnSuccess()
+    {
+        if (m_breaker)
+        {
+            m_breaker->OnSuccess(m_url, m_isProbe);
+            m_isReported = true;
+        }
+    }
+
+    void OnFailure()
+    {
+        if (m_breaker)
+        {
+            m_breaker->OnFailure(m_url, m_isProbe);
+            m_isReported = true;
+        }
+    }
+
+  private:
+    CircuitBreaker* m_breaker;
+    std::string_view m_url;
+
+    // Whether the attempt is the probe of a half-open breaker, the only one whose outcome can close or reopen it
+    bool m_isProbe;
+    bool m_isReported{false};
+};
+
+// Whether @param curlCode shows the host could not be reached or did not answer. Errors of the client itself, such as
+// a response going over the size limits or a cancelled transfer, say nothing about the host.
+bool IsHostFailure(CURLcode curlCode)
+{
+    switch (curlCode)
+    {
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SSL_CONNECT_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_HTTP2:
+    case CURLE_HTTP2_STREAM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Returns a delay drawn uniformly between @param min and @param max
+std::chrono::milliseconds GetRandomDelay(std::chrono::milliseconds min, std::chrono::milliseconds max)
+{
+    thread_local std::mt19937_64 s_generator{std::random_device{}()};
+    std::uniform_int_distribution<long long> distribution(min.count(), max.count());
+    return std::chrono::milliseconds{distribution(s_generator)};
+}
+
 std::chrono::milliseconds ParseRetryAfterValue(const std::string& retryAfter, const ReportingHandler& reportingHandler)
 {
     LOG_VERBOSE(reportingHandler, "Parsing Retry-After value [%s]", retryAfter.c_str());
@@ -241,41 +434,60 @@ std::chrono::milliseconds ParseRetryAfterValue(const std::string& retryAfter, co
 }
 } // namespace
 
-namespace SFS::details
+// State of a request across its attempts. The engine keeps using it from its thread between the attempts of an
+// asynchronous request, so it lives in the connection until the next request.
+struct CurlConnection::Request
 {
-struct CurlHeaderList
-{
-  public:
-    CurlHeaderList() = default;
-
-    ~CurlHeaderList()
+    Request(CurlConnection& connection, const std::string& url)
+        : url(url)
+        , cv(connection.m_cv.IncrementAndGet())
+        , errorBuffer(connection.m_handle, connection.m_handler)
+        , sink(connection.m_responseBuffer,
+               connection.m_spillFile,
+               connection.m_maxResponseSize,
+               connection.m_isStreaming ? connection.m_maxSpilledResponseSize : 0)
     {
-        curl_slist_free_all(m_slist);
     }
 
-    /**
-     * @throws SFSException if the header cannot be added to the list.
-     */
-    void Add(HttpHeader header, const std::string& value)
-    {
-        const std::string data = ToString(header) + ": " + value;
-        const auto ret = curl_slist_append(m_slist, data.c_str());
-        if (!ret)
-        {
-            throw SFSException(Result::ConnectionSetupFailed, "Failed to add header " + data + " to CurlHeaderList");
-        }
-        m_slist = ret;
-    }
+    const std::string url;
+    const std::string cv;
+
+    // Body of an asynchronous POST request, which has to outlive the call that made it
+    std::string body;
+
+    // Setting up error buffer where error messages get written - this gets unset in the destructor
+    CurlErrorBuffer errorBuffer;
 
-    struct curl_slist* m_slist{nullptr};
+    // The read buffer keeps its capacity from one request to the next, so it only grows when a response is the
+    // largest yet
+    ResponseSink sink;
+
+    unsigned attempt{0};
+    std::chrono::steady_clock::time_point startTime{};
+    CURLcode result{CURLE_OK};
+    std::optional<CircuitBreakerAttempt> breakerAttempt;
+    std::promise<std::string> promise;
 };
-} // namespace SFS::details
 
-CurlConnection::CurlConnection(const ConnectionConfig& config, const ReportingHandler& handler)
+CurlConnection::CurlConnection(const ConnectionConfig& config,
+                               const ReportingHandler& handler,
+                               CurlHandlePool* handlePool,
+                               CurlMultiEngine* multiEngine)
     : Connection(config, handler)
+    , m_headers(std::make_unique<CurlHeaderList>())
+    , m_handlePool(handlePool)
+    , m_multiEngine(multiEngine)
 {
-    m_handle = curl_easy_init();
-    THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed, m_handle, m_handler, "Failed to init curl connection");
+    if (m_handlePool)
+    {
+        // Handles from the pool come in their default state, so the setup below applies to them as well
+        m_handle = m_handlePool->Acquire();
+    }
+    else
+    {
+        m_handle = curl_easy_init();
+        THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed, m_handle, m_handler, "Failed to init curl connection");
+    }
 
     // Turning timeout signals off to avoid issues with threads
     // See https://curl.se/libcurl/c/threadsafe.html
@@ -284,6 +496,44 @@ CurlConnection::CurlConnection(const ConnectionConfig& config, const ReportingHa
                           m_handler,
                           "Failed to set up curl");
 
+    // Download info is highly repetitive, so compressed responses save most of the bytes on the wire. An empty value
+    // accepts every encoding curl was built with, such as gzip and brotli, and curl decompresses the response before
+    // handing it to WriteCallback, so the size limits apply to the decompressed body.
+    THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed,
+                          curl_easy_setopt(m_handle, CURLOPT_ACCEPT_ENCODING, "") == CURLE_OK,
+                          m_handler,
+                          "Failed to set up curl");
+
+    // Lets Cancel() abort a transfer in flight
+    THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed,
+                          curl_easy_setopt(m_handle, CURLOPT_XFERINFOFUNCTION, ProgressCallback) == CURLE_OK &&
+                              curl_easy_setopt(m_handle, CURLOPT_XFERINFODATA, &m_cancelled) == CURLE_OK &&
+                              curl_easy_setopt(m_handle, CURLOPT_NOPROGRESS, 0L) == CURLE_OK,
+                          m_handler,
+                          "Failed to set up curl");
+
+    if (m_multiEngine && m_multiEngine->IsHttp2Enabled())
+    {
+        // HTTP/2 is negotiated in the TLS handshake, and plain http:// URLs stay on HTTP/1.1. Tests can ask for HTTP/2
+        // without negotiation to use a local h2c server.
+        long httpVersion = CURL_HTTP_VERSION_2TLS;
+        if (test::GetTestOverrideAsInt(test::TestOverride::Http2PriorKnowledge).value_or(0) != 0)
+        {
+            httpVersion = CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+        }
+        THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed,
+                              curl_easy_setopt(m_handle, CURLOPT_HTTP_VERSION, httpVersion) == CURLE_OK,
+                              m_handler,
+                              "Failed to set up curl");
+
+        // A transfer to a host whose connection is still being set up waits for it, so that it is multiplexed over it
+        // instead of opening a connection of its own
+        THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed,
+                              curl_easy_setopt(m_handle, CURLOPT_PIPEWAIT, 1L) == CURLE_OK,
+                              m_handler,
+                              "Failed to set up curl");
+    }
+
     // TODO #40: Allow passing user agent in the header
     // TODO #41: Pass AAD token in the header if it is available
     // TODO #42: Cert pinning with service
@@ -291,7 +541,17 @@ CurlConnection::CurlConnection(const ConnectionConfig& config, const ReportingHa
 
 CurlConnection::~CurlConnection()
 {
-    if (m_handle)
+    // The engine lets go of the handle, the request and this connection before any of them is freed, so the handle is
+    // not driven by the engine once it is back in the pool. The request unsets the error buffer, which needs the
+    // handle.
+    WaitForEngineRequest(true /*cancel*/);
+    m_asyncRequest.reset();
+
+    if (m_handlePool)
+    {
+        m_handlePool->Release(m_handle);
+    }
+    else if (m_handle)
     {
         curl_easy_cleanup(m_handle);
     }
@@ -301,80 +561,312 @@ std::string CurlConnection::Get(const std::string& url)
 {
     THROW_CODE_IF_LOG(InvalidArg, url.empty(), m_handler, "url cannot be empty");
 
-    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HTTPGET, 1L));
-    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HTTPHEADER, nullptr));
+    SetUpGet();
+    return CurlPerform(url, *m_headers);
+}
+
+std::future<std::string> CurlConnection::GetAsync(const std::string& url)
+{
+    if (!m_multiEngine)
+    {
+        return Connection::GetAsync(url);
+    }
+
+    THROW_CODE_IF_LOG(InvalidArg, url.empty(), m_handler, "url cannot be empty");
 
-    CurlHeaderList headers;
-    return CurlPerform(url, headers);
+    WaitForEngineRequest(false /*cancel*/);
+    m_asyncRequest.reset();
+    SetUpGet();
+    m_asyncRequest = std::make_unique<Request>(*this, url);
+    return StartRequest(*m_asyncRequest, *m_headers);
 }
 
 std::string CurlConnection::Post(const std::string& url, const std::string& data)
 {
     THROW_CODE_IF_LOG(InvalidArg, url.empty(), m_handler, "url cannot be empty");
 
-    CurlHeaderList headerList;
-    headerList.Add(HttpHeader::ContentType, "application/json");
+    // The body outlives the transfer, as CurlPerform() only returns once the transfer is done, and a handle is reset
+    // before another connection can use it
+    SetUpPost(data);
+    return CurlPerform(url, *m_headers);
+}
+
+std::future<std::string> CurlConnection::PostAsync(const std::string& url, const std::string& data)
+{
+    if (!m_multiEngine)
+    {
+        return Connection::PostAsync(url, data);
+    }
+
+    THROW_CODE_IF_LOG(InvalidArg, url.empty(), m_handler, "url cannot be empty");
+
+    // The request keeps a copy of the body, as the one of the caller may be gone before the transfer is done
+    WaitForEngineRequest(false /*cancel*/);
+    m_asyncRequest.reset();
+    m_asyncRequest = std::make_unique<Request>(*this, url);
+    m_asyncRequest->body = data;
+    SetUpPost(m_asyncRequest->body);
+    return StartRequest(*m_asyncRequest, *m_headers);
+}
+
+StreamingResponse CurlConnection::PostStreaming(const std::string& url)
+{
+    // The response is only allowed to spill to a file for the duration of this request
+    m_isStreaming = true;
+    StreamingResponse response;
+    try
+    {
+        response.body = Post(url, {});
+    }
+    catch (...)
+    {
+        m_isStreaming = false;
+        m_spillFile.reset();
+        throw;
+    }
+    m_isStreaming = false;
+
+    if (m_spillFile)
+    {
+        LOG_VERBOSE(m_handler, "Response is over the in-memory limit and was written to a temporary file");
+        THROW_CODE_IF_LOG(ConnectionUnexpectedError,
+                          std::fflush(m_spillFile.get()) != 0,
+                          m_handler,
+                          "Failed to write the response to a temporary file");
+        std::rewind(m_spillFile.get());
+        response.spillFile = std::move(m_spillFile);
+    }
+    return response;
+}
+
+void CurlConnection::SetUpGet()
+{
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HTTPGET, 1L));
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HTTPHEADER, nullptr));
 
+    m_headers->Clear();
+}
+
+void CurlConnection::SetUpPost(const std::string& data)
+{
+    // curl sends the body from our memory instead of copying it, so @param data must outlive the transfer
     THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_POST, 1L));
-    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_COPYPOSTFIELDS, data.c_str()));
+    THROW_IF_CURL_SETUP_ERROR(
+        curl_easy_setopt(m_handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(data.size())));
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_POSTFIELDS, data.c_str()));
 
-    CurlHeaderList headers;
-    headers.Add(HttpHeader::ContentType, "application/json");
-    return CurlPerform(url, headers);
+    m_headers->Clear();
+    m_headers->Add(HttpHeader::ContentType, "application/json");
 }
 
 std::string CurlConnection::CurlPerform(const std::string& url, CurlHeaderList& headers)
 {
-    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_URL, url.c_str()));
+    WaitForEngineRequest(false /*cancel*/);
+    m_asyncRequest.reset();
+    Request request(*this, url);
+    if (m_multiEngine)
+    {
+        // The engine goes through all the attempts, and the calling thread only waits for the outcome
+        return StartRequest(request, headers).get();
+    }
 
-    const std::string cv = m_cv.IncrementAndGet();
-    headers.Add(HttpHeader::MSCV, cv);
-    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HTTPHEADER, headers.m_slist));
+    BeginRequest(request, headers);
+    while (true)
+    {
+        const auto startTime = PrepareAttempt(request);
 
-    // Setting up error buffer where error messages get written - this gets unset in the destructor
-    CurlErrorBuffer errorBuffer(m_handle, m_handler);
+        // The transfer runs in the calling thread, which waits for the start time in a way that Cancel() interrupts
+        request.result = CURLE_ABORTED_BY_CALLBACK;
+        std::unique_lock lock(m_cancelMutex);
+        if (!m_cancelCondition.wait_until(lock, startTime, [this]() { return m_cancelled.load(); }))
+        {
+            lock.unlock();
+            request.result = curl_easy_perform(m_handle);
+        }
+        else
+        {
+            lock.unlock();
+        }
+
+        if (CompleteAttempt(request))
+        {
+            // Copied out in a single allocation of the exact size, so the buffer keeps its capacity
+            return m_responseBuffer;
+        }
+    }
+}
+
+void CurlConnection::BeginRequest(Request& request, CurlHeaderList& headers)
+{
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_URL, request.url.c_str()));
+
+    headers.Add(HttpHeader::MSCV, request.cv);
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HTTPHEADER, headers.Get()));
 
-    std::string readBuffer;
     THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_WRITEFUNCTION, WriteCallback));
-    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_WRITEDATA, &readBuffer));
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_WRITEDATA, &request.sink));
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HEADERFUNCTION, HeaderCallback));
+    THROW_IF_CURL_SETUP_ERROR(curl_easy_setopt(m_handle, CURLOPT_HEADERDATA, &request.sink));
 
-    // Retry the connection a specified number of times
-    const unsigned totalAttempts = 1 + m_maxRetries;
-    for (unsigned i = 0; i < totalAttempts; i++)
+    m_lastRetryDelay = {};
+    if (m_retryBudget)
     {
-        const unsigned attempt = i + 1;
-        LOG_INFO(m_handler, "Request attempt %u out of %u (cv: %s)", attempt, totalAttempts, cv.c_str());
-        const bool lastAttempt = attempt == totalAttempts;
+        m_retryBudget->OnRequest();
+    }
+}
 
-        // Clear the buffer before each attempt
-        readBuffer.clear();
+std::future<std::string> CurlConnection::StartRequest(Request& request, CurlHeaderList& headers)
+{
+    auto future = request.promise.get_future();
+    try
+    {
+        BeginRequest(request, headers);
 
-        // Perform the request
-        const auto result = curl_easy_perform(m_handle);
-        if (result != CURLE_OK)
+        // Set before the first attempt is submitted, as the engine may be done with it right away
         {
-            THROW_LOG(CurlCodeToResult(result, errorBuffer.Get()), m_handler);
+            std::lock_guard guard(m_engineRequestMutex);
+            m_engineRequestInFlight = true;
         }
+        SubmitAttempt(request);
+    }
+    catch (...)
+    {
+        request.promise.set_exception(std::current_exception());
+        EndEngineRequest();
+    }
+    return future;
+}
 
-        // Check request status to stop or retry
-        long httpCode = 0;
-        THROW_IF_CURL_UNEXPECTED_ERROR(curl_easy_getinfo(m_handle, CURLINFO_RESPONSE_CODE, &httpCode));
+void CurlConnection::SubmitAttempt(Request& request)
+{
+    // The transfer waits for its start time in the timer queue of the engine, and the engine thread submits the next
+    // attempt once it completes, so no thread waits while the request is retried
+    const auto startTime = PrepareAttempt(request);
+    m_multiEngine->Submit(m_handle, startTime, &m_cancelled, [this, &request](CURLcode result) {
+        request.result = result;
+        OnAttemptDone(request);
+    });
+}
 
-        if (IsSuccessfulSFSHttpCode(httpCode))
+void CurlConnection::OnAttemptDone(Request& request)
+{
+    try
+    {
+        if (!CompleteAttempt(request))
         {
-            break;
+            SubmitAttempt(request);
+            return;
         }
+    }
+    catch (...)
+    {
+        // The request may be destroyed as soon as its future is ready, so the promise is moved out first
+        auto promise = std::move(request.promise);
+        promise.set_exception(std::current_exception());
+        EndEngineRequest();
+        return;
+    }
 
-        const Result httpResult = HttpCodeToResult(httpCode);
-        if (!CanRetryRequest(lastAttempt, httpCode))
+    // Copied out in a single allocation of the exact size, so the buffer keeps its capacity
+    auto promise = std::move(request.promise);
+    promise.set_value(m_responseBuffer);
+    EndEngineRequest();
+}
+
+void CurlConnection::EndEngineRequest()
+{
+    // Notified under the lock, as a waiting destructor frees the condition variable as soon as it can take the lock
+    std::lock_guard guard(m_engineRequestMutex);
+    m_engineRequestInFlight = false;
+    m_engineRequestDone.notify_all();
+}
+
+void CurlConnection::WaitForEngineRequest(bool cancel)
+{
+    std::unique_lock lock(m_engineRequestMutex);
+    if (!m_engineRequestInFlight)
+    {
+        return;
+    }
+
+    if (cancel)
+    {
+        // The engine aborts the transfer, whether it is waiting to start or in flight, and the request then fails
+        lock.unlock();
+        Cancel();
+        lock.lock();
+    }
+    m_engineRequestDone.wait(lock, [this]() { return !m_engineRequestInFlight; });
+}
+
+std::chrono::steady_clock::time_point CurlConnection::PrepareAttempt(Request& request)
+{
+    // Retry the connection a specified number of times. The first attempt starts right away.
+    const unsigned totalAttempts = 1 + m_maxRetries;
+    ++request.attempt;
+    LOG_INFO(m_handler, "Request attempt %u out of %u (cv: %s)", request.attempt, totalAttempts, request.cv.c_str());
+
+    // Clear the buffer before each attempt
+    request.sink.Reset();
+
+    // The attempt starts once the host accepts requests again if it asked to wait
+    request.startTime = ApplyRetryAfterGate(request.url, request.startTime, request.attempt > 1);
+
+    // A host that keeps failing is left alone for a while, instead of every request going through all its retries
+    request.breakerAttempt.reset();
+    bool isProbe = false;
+    THROW_CODE_IF_LOG(HttpServiceNotAvailable,
+                      m_circuitBreaker && !m_circuitBreaker->AllowRequest(request.url, &isProbe),
+                      m_handler,
+                      "Request not sent as the circuit breaker of the host is open after repeated failures");
+    request.breakerAttempt.emplace(m_circuitBreaker.get(), request.url, isProbe);
+    return request.startTime;
+}
+
+bool CurlConnection::CompleteAttempt(Request& request)
+{
+    if (request.result != CURLE_OK)
+    {
+        THROW_CODE_IF_LOG(ConnectionCancelled,
+                          request.result == CURLE_ABORTED_BY_CALLBACK && m_cancelled,
+                          m_handler,
+                          "Request was cancelled");
+        if (IsHostFailure(request.result))
         {
-            THROW_LOG(httpResult, m_handler);
+            request.breakerAttempt->OnFailure();
         }
+        THROW_LOG(CurlCodeToResult(request.result, request.errorBuffer.Get()), m_handler);
+    }
 
-        ProcessRetry(attempt, httpResult);
+    long httpCode = 0;
+    THROW_IF_CURL_UNEXPECTED_ERROR(curl_easy_getinfo(m_handle, CURLINFO_RESPONSE_CODE, &httpCode));
+
+    // Any other answer, including 429, shows the host is up
+    if (httpCode >= 500)
+    {
+        request.breakerAttempt->OnFailure();
+    }
+    else
+    {
+        request.breakerAttempt->OnSuccess();
+    }
+
+    // Check request status to stop or retry
+    if (IsSuccessfulSFSHttpCode(httpCode))
+    {
+        return true;
+    }
+
+    const Result httpResult = HttpCodeToResult(httpCode);
+    const auto retryAfter = ProcessRetryAfter(request.url, httpCode);
+    const bool lastAttempt = request.attempt == 1 + m_maxRetries;
+    if (!CanRetryRequest(lastAttempt, httpCode))
+    {
+        THROW_LOG(httpResult, m_handler);
     }
 
-    return readBuffer;
+    request.startTime = ProcessRetry(static_cast<int>(request.attempt), httpResult, retryAfter);
+    return false;
 }
 
 bool CurlConnection::CanRetryRequest(bool lastAttempt, long httpCode)
@@ -394,15 +886,63 @@ bool CurlConnection::CanRetryRequest(bool lastAttempt, long httpCode)
     return true;
 }
 
-void CurlConnection::ProcessRetry(int attempt, const Result& httpResult)
+std::optional<std::chrono::milliseconds> CurlConnection::ProcessRetryAfter(const std::string& url, long httpCode)
+{
+    if (!IsRetriableHttpError(httpCode))
+    {
+        return std::nullopt;
+    }
+
+    const std::optional<std::string> retryAfter = GetResponseHeader(m_handle, HttpHeader::RetryAfter, m_handler);
+    if (!retryAfter)
+    {
+        return std::nullopt;
+    }
+
+    // Requests made by other calls to the same host are held back as well, so they do not hit it again in the meantime
+    const std::chrono::milliseconds retryDelay = ParseRetryAfterValue(*retryAfter, m_handler);
+    RetryAfterGate::GetInstance().Close(url, std::chrono::steady_clock::now() + retryDelay);
+    return retryDelay;
+}
+
+std::chrono::steady_clock::time_point CurlConnection::ApplyRetryAfterGate(
+    const std::string& url,
+    std::chrono::steady_clock::time_point startTime,
+    bool isRetry)
+{
+    const auto reopenTime = RetryAfterGate::GetInstance().GetReopenTime(url);
+    if (!reopenTime || *reopenTime <= startTime)
+    {
+        return startTime;
+    }
+
+    // A retry of the request that was told to wait keeps waiting, as it would have without the gate
+    THROW_CODE_IF_LOG(HttpTooManyRequests,
+                      !isRetry && m_failFastWhenThrottled,
+                      m_handler,
+                      "The host asked with Retry-After not to be sent requests yet");
+    THROW_CODE_IF_LOG(HttpTooManyRequests,
+                      m_retryDeadline && *reopenTime > *m_retryDeadline,
+                      m_handler,
+                      "The host asked with Retry-After not to be sent requests until after the deadline");
+
+    const auto delay = std::chrono::ceil<std::chrono::milliseconds>(*reopenTime - std::chrono::steady_clock::now());
+    LOG_INFO(m_handler,
+             "Waiting %lld ms for the host to accept requests again, as asked with Retry-After",
+             static_cast<long long>(delay.count()));
+    return *reopenTime;
+}
+
+std::chrono::steady_clock::time_point CurlConnection::ProcessRetry(
+    int attempt,
+    const Result& httpResult,
+    std::optional<std::chrono::milliseconds> retryAfter)
 {
     // Wait before retrying. Prefer the Retry-After information if available
     std::chrono::milliseconds retryDelay{0};
-    const std::optional<std::string> retryAfter = GetResponseHeader(m_handle, HttpHeader::RetryAfter, m_handler);
     if (retryAfter)
     {
-        // TODO #93: Enforce Retry-After value across calls to avoid caller spamming server
-        retryDelay = ParseRetryAfterValue(*retryAfter, m_handler);
+        retryDelay = *retryAfter;
     }
     else
     {
@@ -417,10 +957,52 @@ void CurlConnection::ProcessRetry(int attempt, const Result& httpResult)
             baseRetryDelay = std::chrono::milliseconds{*override};
         }
 
-        retryDelay = baseRetryDelay * (1 << (attempt - 1));
+        if (m_jitterRetryDelays)
+        {
+            // Decorrelated jitter: each delay is drawn between the base and three times the previous delay, so clients
+            // throttled together drift apart. It is capped by the longest delay of the exponential back-off.
+            const auto maxRetryDelay = baseRetryDelay * (1 << (m_maxRetries - 1));
+            const auto previousDelay = std::max(m_lastRetryDelay, baseRetryDelay);
+            retryDelay = std::min(GetRandomDelay(baseRetryDelay, previousDelay * 3), maxRetryDelay);
+        }
+        else
+        {
+            retryDelay = baseRetryDelay * (1 << (attempt - 1));
+        }
     }
+    m_lastRetryDelay = retryDelay;
 
     LOG_IF_FAILED(httpResult, m_handler);
-    LOG_INFO(m_handler, "Sleeping for %lld ms", static_cast<long long>(retryDelay.count()));
-    std::this_thread::sleep_for(retryDelay);
+
+    const auto startTime = std::chrono::steady_clock::now() + retryDelay;
+    if (m_retryDeadline && startTime > *m_retryDeadline)
+    {
+        LOG_INFO(m_handler, "No retry as the next attempt would start after the deadline");
+        THROW_LOG(httpResult, m_handler);
+    }
+
+    if (m_retryBudget && !m_retryBudget->TryRetry())
+    {
+        LOG_INFO(m_handler, "No retry as the retry budget is exhausted");
+        THROW_LOG(httpResult, m_handler);
+    }
+
+    LOG_INFO(m_handler, "Retrying in %lld ms", static_cast<long long>(retryDelay.count()));
+    return startTime;
+}
+
+void CurlConnection::Cancel()
+{
+    Connection::Cancel();
+
+    // Taking the lock ensures a thread about to wait sees the flag, or is already waiting and gets notified
+    {
+        std::lock_guard guard(m_cancelMutex);
+    }
+    m_cancelCondition.notify_all();
+
+    if (m_multiEngine)
+    {
+        m_multiEngine->Wakeup();
+    }
 }
@@ -5,6 +5,12 @@
 
 #include "Connection.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 
 // Forward declaration
@@ -16,13 +22,24 @@ class Result;
 
 namespace details
 {
+class CurlHandlePool;
 struct CurlHeaderList;
+class CurlMultiEngine;
 class ReportingHandler;
 
 class CurlConnection : public Connection
 {
   public:
-    CurlConnection(const ConnectionConfig& config, const ReportingHandler& handler);
+    /**
+     * @param handlePool Optional pool from which the curl handle is taken and to which it is returned on destruction.
+     * If not set, the connection owns a handle of its own. The pool must outlive the connection.
+     * @param multiEngine Optional engine that drives the transfers of this connection from its own thread. If not set,
+     * transfers run in the calling thread. The engine must outlive the connection.
+     */
+    CurlConnection(const ConnectionConfig& config,
+                   const ReportingHandler& handler,
+                   CurlHandlePool* handlePool = nullptr,
+                   CurlMultiEngine* multiEngine = nullptr);
     ~CurlConnection() override;
 
     /**
@@ -32,6 +49,16 @@ class CurlConnection : public Connection
      */
     std::string Get(const std::string& url) override;
 
+    /**
+     * @brief Starts a GET request to the given @param url
+     * @details With a multi engine, the request goes through all of its attempts in the engine thread, including the
+     * waits before retries, so no thread is blocked until the future is waited on. Otherwise, the request is performed
+     * before returning. Destroying the connection cancels a request still in flight, and waits for the engine to let go
+     * of it. A new request made on the connection waits for the previous one to be done.
+     * @return A future for the response body, which holds an SFSException if the request fails
+     */
+    std::future<std::string> GetAsync(const std::string& url) override;
+
     /**
      * @brief Perform a POST request to the given @param url with @param data as the request body
      * @return The response body
@@ -39,16 +66,112 @@ class CurlConnection : public Connection
      */
     std::string Post(const std::string& url, const std::string& data) override;
 
+    /**
+     * @brief Starts a POST request to the given @param url with @param data as the request body, as GetAsync() does
+     * @return A future for the response body, which holds an SFSException if the request fails
+     */
+    std::future<std::string> PostAsync(const std::string& url, const std::string& data) override;
+
+    /**
+     * @brief Perform a POST request to the given @param url, writing a response over the in-memory limit to a
+     * temporary file
+     * @throws SFSException if the request fails
+     */
+    StreamingResponse PostStreaming(const std::string& url) override;
+
+    /**
+     * @brief Cancels the request in progress, if any, and the ones made afterwards
+     * @details A retry waiting for its start time is abandoned right away, and a transfer in flight is aborted.
+     */
+    void Cancel() override;
+
   private:
+    struct Request;
+
+    void SetUpGet();
+    void SetUpPost(const std::string& data);
+
+    /**
+     * @brief Sets up the handle for @param request, which is sent with @param headers
+     */
+    void BeginRequest(Request& request, CurlHeaderList& headers);
+
+    /**
+     * @brief Begins @param request and submits its first attempt to the multi engine
+     * @return A future for the response body, which also holds the errors of setting up the request
+     */
+    std::future<std::string> StartRequest(Request& request, CurlHeaderList& headers);
+
+    /**
+     * @brief Submits the next attempt of @param request to the multi engine, which calls OnAttemptDone() once it is
+     * done
+     */
+    void SubmitAttempt(Request& request);
+
+    /**
+     * @brief Called from the engine thread when an attempt of @param request is done. Either submits the next attempt
+     * or completes the promise of the request.
+     */
+    void OnAttemptDone(Request& request);
+
+    /**
+     * @brief Marks the request in the multi engine as done, once its promise is set and it is no longer used
+     */
+    void EndEngineRequest();
+
+    /**
+     * @brief Waits for the request in the multi engine, if any, to be done, after cancelling it if @param cancel is set
+     */
+    void WaitForEngineRequest(bool cancel);
+
+    /**
+     * @brief Prepares the next attempt of @param request
+     * @return The time at which the attempt starts
+     * @throws SFSException if the attempt cannot be made, such as when the circuit breaker of the host is open
+     */
+    std::chrono::steady_clock::time_point PrepareAttempt(Request& request);
+
+    /**
+     * @brief Handles the outcome of the attempt of @param request that just ended
+     * @details The outcome of the attempt is reported to the circuit breaker of the connection, if any.
+     * @return true if the request succeeded, false if it is to be retried at the start time of the request
+     * @throws SFSException if the transfer fails, the connection is cancelled, or the request cannot be retried
+     */
+    bool CompleteAttempt(Request& request);
+
     /**
      * @brief Perform checks that the request can be retried
      */
     bool CanRetryRequest(bool lastAttempt, long httpCode);
 
     /**
-     * @brief Process retry and perform wait logic before retrying the request
+     * @brief Process retry and compute when the request is retried
+     * @param retryAfter Delay asked by the Retry-After header of the response, if any
+     * @return The time at which the next attempt starts
+     * @throws SFSException with @param httpResult if the next attempt would start after the retry deadline
+     */
+    std::chrono::steady_clock::time_point ProcessRetry(int attempt,
+                                                       const Result& httpResult,
+                                                       std::optional<std::chrono::milliseconds> retryAfter);
+
+    /**
+     * @brief Reads the Retry-After header of a retriable error response to a request to @param url
+     * @details The RetryAfterGate of the host is closed for that long, so that other requests to it wait as well.
+     * @return The delay asked by the header, if any
      */
-    void ProcessRetry(int attempt, const Result& httpResult);
+    std::optional<std::chrono::milliseconds> ProcessRetryAfter(const std::string& url, long httpCode);
+
+    /**
+     * @brief Delays an attempt of a request to @param url until the RetryAfterGate of its host reopens
+     * @param startTime Time at which the attempt would start otherwise
+     * @param isRetry Whether the attempt retries the request, which is never failed fast
+     * @return The time at which the attempt starts
+     * @throws SFSException with HttpTooManyRequests if the request fails fast when throttled, or if the gate reopens
+     * after the retry deadline
+     */
+    std::chrono::steady_clock::time_point ApplyRetryAfterGate(const std::string& url,
+                                                              std::chrono::steady_clock::time_point startTime,
+                                                              bool isRetry);
 
   protected:
     /**
@@ -59,6 +182,38 @@ class CurlConnection : public Connection
     virtual std::string CurlPerform(const std::string& url, CurlHeaderList& headers);
 
     CURL* m_handle;
+
+  private:
+    // Headers of the current request. The list is reused so that its memory is only allocated once per connection.
+    std::unique_ptr<CurlHeaderList> m_headers;
+
+    // Body of the current response. The buffer is reused so that it is only reallocated for larger responses.
+    std::string m_responseBuffer;
+
+    // Temporary file the body of the current response was moved to once it went over the in-memory limit. Only used
+    // while a PostStreaming() request is in progress.
+    FilePtr m_spillFile;
+    bool m_isStreaming{false};
+
+    CurlHandlePool* m_handlePool;
+    CurlMultiEngine* m_multiEngine;
+
+    // Delay before the previous retry of the current request, from which the next one is drawn with jitter
+    std::chrono::milliseconds m_lastRetryDelay{0};
+
+    // Request started by GetAsync() or PostAsync(). It is kept until the next request, as the engine uses it until the
+    // request is done.
+    std::unique_ptr<Request> m_asyncRequest;
+
+    // Wakes up a retry waiting in the calling thread when the connection is cancelled
+    std::mutex m_cancelMutex;
+    std::condition_variable m_cancelCondition;
+
+    // Whether the multi engine is going through a request of this connection, which uses the handle, the request and
+    // this connection until it is done
+    bool m_engineRequestInFlight{false};
+    std::mutex m_engineRequestMutex;
+    std::condition_variable m_engineRequestDone;
 };
 } // namespace details
 } // namespace SFS
@@ -5,6 +5,8 @@
 
 #include "../ErrorHandling.h"
 #include "CurlConnection.h"
+#include "CurlHandlePool.h"
+#include "CurlShare.h"
 
 #include <curl/curl.h>
 
@@ -33,21 +35,31 @@ void CheckCurlFeatures(const ReportingHandler& handler)
 }
 } // namespace
 
-CurlConnectionManager::CurlConnectionManager(const ReportingHandler& handler) : ConnectionManager(handler)
+CurlConnectionManager::CurlConnectionManager(const ReportingHandler& handler, const ConnectionManagerConfig& config)
+    : ConnectionManager(handler, config)
 {
     THROW_CODE_IF_NOT_LOG(HttpUnexpected,
                           curl_global_init(CURL_GLOBAL_ALL) == CURLE_OK,
                           m_handler,
                           "Curl failed to initialize");
     CheckCurlFeatures(m_handler);
+
+    m_share = std::make_unique<CurlShare>(m_handler);
+    m_handlePool = std::make_unique<CurlHandlePool>(m_handler,
+                                                    m_config.maxIdleConnections,
+                                                    m_config.idleConnectionTimeout,
+                                                    m_share.get());
 }
 
 CurlConnectionManager::~CurlConnectionManager()
 {
+    // Pooled handles must be cleaned up before the share they are attached to, and both before curl is uninitialized
+    m_handlePool.reset();
+    m_share.reset();
     curl_global_cleanup();
 }
 
 std::unique_ptr<Connection> CurlConnectionManager::MakeConnection(const ConnectionConfig& config)
 {
-    return std::make_unique<CurlConnection>(config, m_handler);
+    return std::make_unique<CurlConnection>(config, m_handler, m_handlePool.get());
 }
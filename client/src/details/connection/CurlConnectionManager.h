@@ -10,15 +10,28 @@
 namespace SFS::details
 {
 class Connection;
+class CurlHandlePool;
+class CurlShare;
 class ReportingHandler;
 struct ConnectionConfig;
 
 class CurlConnectionManager : public ConnectionManager
 {
   public:
-    CurlConnectionManager(const ReportingHandler& handler);
+    CurlConnectionManager(const ReportingHandler& handler, const ConnectionManagerConfig& config = {});
     ~CurlConnectionManager() override;
 
+    /**
+     * @brief Returns a new CurlConnection. Its curl handle is taken from a pool of idle handles when possible, so
+     * the connection can reuse a live connection left open by a previous request. All handles share the DNS cache
+     * and the TLS session cache of this manager.
+     * @note The returned connection must not outlive this object
+     */
     std::unique_ptr<Connection> MakeConnection(const ConnectionConfig& config) override;
+
+  protected:
+    // The share must be declared before the pool, as it has to outlive the handles in the pool
+    std::unique_ptr<CurlShare> m_share;
+    std::unique_ptr<CurlHandlePool> m_handlePool;
 };
 } // namespace SFS::details
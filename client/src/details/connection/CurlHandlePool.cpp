@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "CurlHandlePool.h"
+
+#include "../ErrorHandling.h"
+#include "../ReportingHandler.h"
+#include "CurlShare.h"
+
+#include <curl/curl.h>
+
+using namespace SFS;
+using namespace SFS::details;
+
+namespace
+{
+void CleanupHandles(const std::vector<CURL*>& handles)
+{
+    for (CURL* handle : handles)
+    {
+        curl_easy_cleanup(handle);
+    }
+}
+} // namespace
+
+CurlHandlePool::CurlHandlePool(const ReportingHandler& handler,
+                               unsigned maxIdleHandles,
+                               std::chrono::seconds idleTimeout,
+                               CurlShare* share)
+    : m_handler(handler)
+    , m_maxIdleHandles(maxIdleHandles)
+    , m_idleTimeout(idleTimeout)
+    , m_share(share)
+{
+    m_idleHandles.reserve(m_maxIdleHandles);
+}
+
+CurlHandlePool::~CurlHandlePool()
+{
+    for (const auto& idle : m_idleHandles)
+    {
+        curl_easy_cleanup(idle.handle);
+    }
+}
+
+CURL* CurlHandlePool::Acquire()
+{
+    CURL* handle = nullptr;
+    std::vector<CURL*> expired;
+    {
+        std::lock_guard guard(m_mutex);
+        CollectExpiredHandles(Clock::now(), expired);
+
+        // Prefer the most recently released handle, as its connections are the most likely to still be alive
+        if (!m_idleHandles.empty())
+        {
+            handle = m_idleHandles.back().handle;
+            m_idleHandles.pop_back();
+        }
+    }
+
+    // Closing connections may involve network activity, so it is done outside of the lock
+    CleanupHandles(expired);
+
+    if (handle)
+    {
+        LOG_VERBOSE(m_handler, "Reusing pooled curl handle");
+    }
+    else
+    {
+        handle = curl_easy_init();
+        THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed, handle, m_handler, "Failed to init curl connection");
+    }
+
+    if (m_share)
+    {
+        const CURLcode code = curl_easy_setopt(handle, CURLOPT_SHARE, m_share->GetHandle());
+        if (code != CURLE_OK)
+        {
+            const std::string message = "Failed to attach curl share: " + std::string(curl_easy_strerror(code));
+            curl_easy_cleanup(handle);
+            THROW_LOG(Result(Result::ConnectionSetupFailed, message), m_handler);
+        }
+    }
+
+    return handle;
+}
+
+void CurlHandlePool::Release(CURL* handle)
+{
+    if (!handle)
+    {
+        return;
+    }
+
+    // Resetting clears all options, including pointers to buffers owned by the previous connection, but keeps the
+    // live connections, the DNS cache and the TLS session cache of the handle
+    curl_easy_reset(handle);
+
+    std::vector<CURL*> expired;
+    {
+        std::lock_guard guard(m_mutex);
+        const auto now = Clock::now();
+        CollectExpiredHandles(now, expired);
+
+        if (m_idleHandles.size() < m_maxIdleHandles)
+        {
+            m_idleHandles.push_back({handle, now});
+            handle = nullptr;
+        }
+    }
+
+    CleanupHandles(expired);
+    if (handle)
+    {
+        curl_easy_cleanup(handle);
+    }
+}
+
+size_t CurlHandlePool::GetIdleCount()
+{
+    std::lock_guard guard(m_mutex);
+    return m_idleHandles.size();
+}
+
+void CurlHandlePool::CollectExpiredHandles(Clock::time_point now, std::vector<CURL*>& expired)
+{
+    // Handles are ordered by release time, so the expired ones are all at the front
+    auto it = m_idleHandles.begin();
+    while (it != m_idleHandles.end() && now - it->releaseTime >= m_idleTimeout)
+    {
+        expired.push_back(it->handle);
+        ++it;
+    }
+    m_idleHandles.erase(m_idleHandles.begin(), it);
+}
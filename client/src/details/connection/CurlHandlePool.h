@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// Forward declaration
+typedef void CURL;
+
+namespace SFS::details
+{
+class CurlShare;
+class ReportingHandler;
+
+/**
+ * @brief Keeps a bounded set of idle curl easy handles so they can be reused by later connections
+ * @details A curl easy handle keeps its connection cache alive after a transfer, so handing a released handle to the
+ * next connection allows it to reuse a live TCP/TLS connection to the same host instead of performing a new handshake.
+ * Handles are reset when released, so each connection starts from default options. Idle handles are discarded once
+ * they have been unused for longer than the idle timeout. This class is thread-safe.
+ */
+class CurlHandlePool
+{
+  public:
+    /**
+     * @param share Optional share attached to every handle handed out by the pool. It must outlive the pool.
+     */
+    CurlHandlePool(const ReportingHandler& handler,
+                   unsigned maxIdleHandles,
+                   std::chrono::seconds idleTimeout,
+                   CurlShare* share = nullptr);
+    ~CurlHandlePool();
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+    /**
+     * @brief Returns a handle in its default state, reusing an idle one if available
+     * @throws SFSException if a new handle cannot be created
+     */
+    CURL* Acquire();
+
+    /**
+     * @brief Returns a handle to the pool. The handle is destroyed if the pool is already full
+     */
+    void Release(CURL* handle);
+
+    /**
+     * @return The number of idle handles currently kept by the pool
+     */
+    size_t GetIdleCount();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct IdleHandle
+    {
+        CURL* handle;
+        Clock::time_point releaseTime;
+    };
+
+    /**
+     * @brief Moves the handles that have been idle for too long from the pool to @param expired
+     * @note Must be called with m_mutex held
+     */
+    void CollectExpiredHandles(Clock::time_point now, std::vector<CURL*>& expired);
+
+    const ReportingHandler& m_handler;
+    const unsigned m_maxIdleHandles;
+    const std::chrono::seconds m_idleTimeout;
+    CurlShare* m_share;
+
+    // Ordered from the least to the most recently released handle
+    std::vector<IdleHandle> m_idleHandles;
+    std::mutex m_mutex;
+};
+} // namespace SFS::details
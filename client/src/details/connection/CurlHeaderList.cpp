@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "CurlHeaderList.h"
+
+using namespace SFS::details;
+
+void CurlHeaderList::Clear()
+{
+    m_size = 0;
+}
+
+void CurlHeaderList::Add(HttpHeader header, std::string_view value)
+{
+    if (m_size == m_lines.size())
+    {
+        m_lines.emplace_back();
+    }
+
+    auto& line = m_lines[m_size++];
+    line.clear();
+    line += ToString(header);
+    line += ": ";
+    line += value;
+}
+
+curl_slist* CurlHeaderList::Get()
+{
+    if (m_size == 0)
+    {
+        return nullptr;
+    }
+
+    // The nodes are linked here rather than in Add(), as adding lines may move them
+    m_nodes.resize(m_size);
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        m_nodes[i].data = m_lines[i].data();
+        m_nodes[i].next = i + 1 < m_size ? &m_nodes[i + 1] : nullptr;
+    }
+    return m_nodes.data();
+}
+
+size_t CurlHeaderList::Size() const
+{
+    return m_size;
+}
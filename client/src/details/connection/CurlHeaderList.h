@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "HttpHeader.h"
+
+#include <curl/curl.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SFS::details
+{
+/**
+ * @brief List of request headers in the form curl expects, meant to be reused across the requests of a connection
+ * @details The nodes and strings of the list are owned by this object instead of being allocated by
+ * curl_slist_append(), which curl allows since it only reads the list. Clearing the list keeps them, so the headers of
+ * the next request are written into the memory of the previous ones.
+ */
+struct CurlHeaderList
+{
+  public:
+    /// @brief Removes all headers, keeping their memory for the next ones
+    void Clear();
+
+    void Add(HttpHeader header, std::string_view value);
+
+    /**
+     * @brief Returns the list to pass to CURLOPT_HTTPHEADER, or nullptr if it is empty
+     * @details The list stays valid until this object is changed or destroyed.
+     */
+    curl_slist* Get();
+
+    size_t Size() const;
+
+  private:
+    std::vector<std::string> m_lines;
+    std::vector<curl_slist> m_nodes;
+
+    // Number of lines in use. The ones after it are kept for their memory.
+    size_t m_size{0};
+};
+} // namespace SFS::details
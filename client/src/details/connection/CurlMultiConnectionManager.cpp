@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "CurlMultiConnectionManager.h"
+
+#include "CurlConnection.h"
+#include "CurlHandlePool.h"
+#include "CurlMultiEngine.h"
+
+using namespace SFS;
+using namespace SFS::details;
+
+CurlMultiConnectionManager::CurlMultiConnectionManager(const ReportingHandler& handler,
+                                                       const ConnectionManagerConfig& config)
+    : CurlConnectionManager(handler, config)
+{
+    m_engine = std::make_unique<CurlMultiEngine>(m_handler, m_config.useHttp2);
+}
+
+CurlMultiConnectionManager::~CurlMultiConnectionManager()
+{
+    // The engine holds a connection cache of its own, which has to be torn down before curl is uninitialized by the
+    // base class destructor
+    m_engine.reset();
+}
+
+std::unique_ptr<Connection> CurlMultiConnectionManager::MakeConnection(const ConnectionConfig& config)
+{
+    return std::make_unique<CurlConnection>(config, m_handler, m_handlePool.get(), m_engine.get());
+}
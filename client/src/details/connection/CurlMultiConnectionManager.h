@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CurlConnectionManager.h"
+
+#include <memory>
+
+namespace SFS::details
+{
+class CurlMultiEngine;
+
+/**
+ * @brief Event-driven variant of the CurlConnectionManager
+ * @details All connections made by this manager hand their transfers to a single CurlMultiEngine, so a single
+ * background thread drives every request in flight, no matter how many threads issue them. Calling threads block until
+ * their own transfer completes.
+ */
+class CurlMultiConnectionManager : public CurlConnectionManager
+{
+  public:
+    CurlMultiConnectionManager(const ReportingHandler& handler, const ConnectionManagerConfig& config = {});
+    ~CurlMultiConnectionManager() override;
+
+    /**
+     * @brief Returns a new CurlConnection whose transfers are driven by the engine of this manager
+     * @note The returned connection must not outlive this object
+     */
+    std::unique_ptr<Connection> MakeConnection(const ConnectionConfig& config) override;
+
+  protected:
+    std::unique_ptr<CurlMultiEngine> m_engine;
+};
+} // namespace SFS::details
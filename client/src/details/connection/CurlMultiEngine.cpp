@@ -0,0 +1,282 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "CurlMultiEngine.h"
+
+#include "../ErrorHandling.h"
+#include "../ReportingHandler.h"
+
+#include <algorithm>
+
+using namespace SFS;
+using namespace SFS::details;
+
+// Upper bound for how long the engine thread waits for socket activity before checking for new work. New transfers
+// and shutdown wake the thread up immediately, and the wait is shortened for delayed transfers that are due sooner, so
+// this only matters for curl's own internal timers.
+constexpr int c_pollTimeoutMs = 1000;
+
+CurlMultiEngine::CurlMultiEngine(const ReportingHandler& handler, bool useHttp2) : m_handler(handler)
+{
+    m_multi = curl_multi_init();
+    THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed, m_multi, m_handler, "Failed to init curl multi handle");
+
+    if (useHttp2)
+    {
+        if (!(curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2))
+        {
+            LOG_WARNING(m_handler, "Curl was not built with HTTP/2 support, requests will use HTTP/1.1");
+        }
+        else if (curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX) != CURLM_OK)
+        {
+            LOG_WARNING(m_handler, "Failed to enable HTTP/2 multiplexing, requests will use HTTP/1.1");
+        }
+        else
+        {
+            m_isHttp2Enabled = true;
+        }
+    }
+
+    m_thread = std::thread([this]() { Run(); });
+}
+
+CurlMultiEngine::~CurlMultiEngine()
+{
+    m_stopping = true;
+    curl_multi_wakeup(m_multi);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    AbortTransfers();
+    curl_multi_cleanup(m_multi);
+}
+
+std::future<CURLcode> CurlMultiEngine::Submit(CURL* handle,
+                                              std::chrono::steady_clock::time_point startTime,
+                                              const std::atomic<bool>* cancelled)
+{
+    // std::function requires a copyable callable, so the move-only promise is shared instead
+    auto promise = std::make_shared<std::promise<CURLcode>>();
+    auto future = promise->get_future();
+    Submit(handle, startTime, cancelled, [promise](CURLcode result) { promise->set_value(result); });
+    return future;
+}
+
+void CurlMultiEngine::Submit(CURL* handle,
+                             std::chrono::steady_clock::time_point startTime,
+                             const std::atomic<bool>* cancelled,
+                             CompletionFn onComplete)
+{
+    {
+        std::lock_guard guard(m_pendingMutex);
+        m_pendingTransfers.push_back({handle, std::move(onComplete), startTime, cancelled});
+    }
+
+    curl_multi_wakeup(m_multi);
+}
+
+CURLcode CurlMultiEngine::Perform(CURL* handle)
+{
+    return Submit(handle).get();
+}
+
+bool CurlMultiEngine::IsHttp2Enabled() const
+{
+    return m_isHttp2Enabled;
+}
+
+void CurlMultiEngine::Wakeup()
+{
+    curl_multi_wakeup(m_multi);
+}
+
+void CurlMultiEngine::Run()
+{
+    while (!m_stopping)
+    {
+        AddPendingTransfers();
+        StartDueTransfers();
+        AbortCancelledTransfers();
+
+        int runningTransfers = 0;
+        const CURLMcode performCode = curl_multi_perform(m_multi, &runningTransfers);
+        if (performCode != CURLM_OK)
+        {
+            LOG_ERROR(m_handler, "curl_multi_perform failed: %s", curl_multi_strerror(performCode));
+        }
+
+        CompleteFinishedTransfers();
+
+        const CURLMcode pollCode = curl_multi_poll(m_multi, nullptr, 0, GetPollTimeoutMs(), nullptr);
+        if (pollCode != CURLM_OK)
+        {
+            LOG_ERROR(m_handler, "curl_multi_poll failed: %s", curl_multi_strerror(pollCode));
+        }
+    }
+}
+
+void CurlMultiEngine::AddPendingTransfers()
+{
+    std::vector<PendingTransfer> pendingTransfers;
+    {
+        std::lock_guard guard(m_pendingMutex);
+        pendingTransfers.swap(m_pendingTransfers);
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& transfer : pendingTransfers)
+    {
+        if (transfer.cancelled && *transfer.cancelled)
+        {
+            transfer.onComplete(CURLE_ABORTED_BY_CALLBACK);
+        }
+        else if (transfer.startTime > now)
+        {
+            m_delayedTransfers.emplace(transfer.startTime, std::move(transfer));
+        }
+        else
+        {
+            StartTransfer(transfer.handle, std::move(transfer.onComplete), transfer.cancelled);
+        }
+    }
+}
+
+void CurlMultiEngine::StartDueTransfers()
+{
+    // Callbacks may submit new transfers, which only join the timer queue in the next round, so the queue does not
+    // change while it is walked
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = m_delayedTransfers.begin(); it != m_delayedTransfers.end();)
+    {
+        auto& transfer = it->second;
+        if (transfer.cancelled && *transfer.cancelled)
+        {
+            transfer.onComplete(CURLE_ABORTED_BY_CALLBACK);
+        }
+        else if (it->first <= now)
+        {
+            StartTransfer(transfer.handle, std::move(transfer.onComplete), transfer.cancelled);
+        }
+        else
+        {
+            ++it;
+            continue;
+        }
+        it = m_delayedTransfers.erase(it);
+    }
+}
+
+void CurlMultiEngine::StartTransfer(CURL* handle, CompletionFn onComplete, const std::atomic<bool>* cancelled)
+{
+    const CURLMcode code = curl_multi_add_handle(m_multi, handle);
+    if (code != CURLM_OK)
+    {
+        LOG_ERROR(m_handler, "Failed to add transfer to curl multi handle: %s", curl_multi_strerror(code));
+        onComplete(CURLE_FAILED_INIT);
+        return;
+    }
+    m_activeTransfers.emplace(handle, ActiveTransfer{std::move(onComplete), cancelled});
+}
+
+void CurlMultiEngine::AbortCancelledTransfers()
+{
+    // The progress callback of a transfer only sees the cancellation once curl calls it, which can take a while for a
+    // transfer waiting on the network, so cancelled transfers are taken out of the multi handle right away
+    std::vector<CompletionFn> abortedCallbacks;
+    for (auto it = m_activeTransfers.begin(); it != m_activeTransfers.end();)
+    {
+        if (it->second.cancelled && *it->second.cancelled)
+        {
+            curl_multi_remove_handle(m_multi, it->first);
+            abortedCallbacks.push_back(std::move(it->second.onComplete));
+            it = m_activeTransfers.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // The callbacks run once the map is no longer walked, as they may submit transfers
+    for (auto& onComplete : abortedCallbacks)
+    {
+        onComplete(CURLE_ABORTED_BY_CALLBACK);
+    }
+}
+
+int CurlMultiEngine::GetPollTimeoutMs() const
+{
+    if (m_delayedTransfers.empty())
+    {
+        return c_pollTimeoutMs;
+    }
+
+    // Rounded up, so the thread does not wake up just before the next transfer is due
+    const auto untilNextStart = std::chrono::ceil<std::chrono::milliseconds>(m_delayedTransfers.begin()->first -
+                                                                             std::chrono::steady_clock::now());
+    return static_cast<int>(std::clamp<long long>(untilNextStart.count(), 0, c_pollTimeoutMs));
+}
+
+void CurlMultiEngine::CompleteFinishedTransfers()
+{
+    int messagesLeft = 0;
+    while (CURLMsg* message = curl_multi_info_read(m_multi, &messagesLeft))
+    {
+        if (message->msg != CURLMSG_DONE)
+        {
+            continue;
+        }
+
+        CURL* handle = message->easy_handle;
+        const CURLcode result = message->data.result;
+
+        // The handle must leave the multi handle before its owner can use it again
+        curl_multi_remove_handle(m_multi, handle);
+
+        // The callback is taken out first, as it may submit the next transfer of the same handle
+        if (auto it = m_activeTransfers.find(handle); it != m_activeTransfers.end())
+        {
+            auto onComplete = std::move(it->second.onComplete);
+            m_activeTransfers.erase(it);
+            onComplete(result);
+        }
+    }
+}
+
+void CurlMultiEngine::AbortTransfers()
+{
+    auto activeTransfers = std::move(m_activeTransfers);
+    m_activeTransfers.clear();
+    for (auto& [handle, transfer] : activeTransfers)
+    {
+        curl_multi_remove_handle(m_multi, handle);
+        transfer.onComplete(CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    auto delayedTransfers = std::move(m_delayedTransfers);
+    m_delayedTransfers.clear();
+    for (auto& [startTime, transfer] : delayedTransfers)
+    {
+        transfer.onComplete(CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    // The callbacks run without the lock, as they may submit transfers, which are then aborted in turn
+    while (true)
+    {
+        std::vector<PendingTransfer> pendingTransfers;
+        {
+            std::lock_guard guard(m_pendingMutex);
+            pendingTransfers.swap(m_pendingTransfers);
+        }
+        if (pendingTransfers.empty())
+        {
+            break;
+        }
+        for (auto& transfer : pendingTransfers)
+        {
+            transfer.onComplete(CURLE_ABORTED_BY_CALLBACK);
+        }
+    }
+}
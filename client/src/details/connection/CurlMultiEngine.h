@@ -0,0 +1,132 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace SFS::details
+{
+class ReportingHandler;
+
+/**
+ * @brief Event-driven transfer engine built on a curl multi handle
+ * @details A single background thread drives all transfers submitted to the engine, so many transfers can be in
+ * flight at the same time without a thread per transfer. Handles added to the engine also share the connection cache
+ * of the multi handle, which is only ever accessed from the engine thread. Transfers can be submitted to start at a
+ * later time, such as retries waiting for their back-off, in which case they wait in a timer queue of the engine.
+ * Completion callbacks can submit the next transfer of a handle, so a request can go through all of its retries without
+ * any thread waiting for it. A handle must not be used by its owner while its transfer is in flight. This class is
+ * thread-safe.
+ */
+class CurlMultiEngine
+{
+  public:
+    using CompletionFn = std::function<void(CURLcode)>;
+
+    /**
+     * @param useHttp2 Multiplexes the transfers to the same host over a single HTTP/2 connection. Ignored with a
+     * warning if curl was built without HTTP/2 support.
+     * @throws SFSException if the multi handle cannot be set up
+     */
+    CurlMultiEngine(const ReportingHandler& handler, bool useHttp2 = false);
+
+    /**
+     * @brief Stops the engine thread. Transfers still in flight are aborted.
+     */
+    ~CurlMultiEngine();
+
+    CurlMultiEngine(const CurlMultiEngine&) = delete;
+    CurlMultiEngine& operator=(const CurlMultiEngine&) = delete;
+
+    /**
+     * @brief Submits the transfer set up in @param handle to the engine
+     * @param startTime The transfer waits in the engine until this time is reached before it starts
+     * @param cancelled If set, the transfer is aborted with CURLE_ABORTED_BY_CALLBACK when it becomes true, whether it
+     * is still waiting to start or already in flight. Call Wakeup() after setting it so that the engine notices it. It
+     * must outlive the transfer.
+     * @return A future that receives the result of the transfer once it completes
+     */
+    std::future<CURLcode> Submit(CURL* handle,
+                                 std::chrono::steady_clock::time_point startTime = {},
+                                 const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * @brief Submits the transfer set up in @param handle to the engine, as Submit() does
+     * @param onComplete Called from the engine thread with the result of the transfer once it completes. It must not
+     * throw nor block, and may submit another transfer, such as the retry of the one that completed.
+     */
+    void Submit(CURL* handle,
+                std::chrono::steady_clock::time_point startTime,
+                const std::atomic<bool>* cancelled,
+                CompletionFn onComplete);
+
+    /**
+     * @brief Submits the transfer set up in @param handle and blocks until it completes
+     * @details The calling thread only waits, the transfer itself is driven by the engine thread
+     * @return The result of the transfer
+     */
+    CURLcode Perform(CURL* handle);
+
+    /**
+     * @brief Whether transfers are multiplexed over HTTP/2, in which case their handles must ask for HTTP/2
+     */
+    bool IsHttp2Enabled() const;
+
+    /**
+     * @brief Wakes the engine thread up, so that it checks its waiting transfers for cancellation
+     */
+    void Wakeup();
+
+  private:
+    void Run();
+    void AddPendingTransfers();
+    void StartDueTransfers();
+    void StartTransfer(CURL* handle, CompletionFn onComplete, const std::atomic<bool>* cancelled);
+    void AbortCancelledTransfers();
+    int GetPollTimeoutMs() const;
+    void CompleteFinishedTransfers();
+    void AbortTransfers();
+
+    const ReportingHandler& m_handler;
+    CURLM* m_multi{nullptr};
+    bool m_isHttp2Enabled{false};
+
+    struct PendingTransfer
+    {
+        CURL* handle;
+        CompletionFn onComplete;
+        std::chrono::steady_clock::time_point startTime;
+        const std::atomic<bool>* cancelled;
+    };
+
+    // Transfers submitted by other threads, waiting to be added to the multi handle by the engine thread
+    std::vector<PendingTransfer> m_pendingTransfers;
+    std::mutex m_pendingMutex;
+
+    // Transfers waiting for their start time, ordered by it. Only accessed from the engine thread.
+    std::multimap<std::chrono::steady_clock::time_point, PendingTransfer> m_delayedTransfers;
+
+    struct ActiveTransfer
+    {
+        CompletionFn onComplete;
+        const std::atomic<bool>* cancelled;
+    };
+
+    // Transfers in flight. Only accessed from the engine thread.
+    std::unordered_map<CURL*, ActiveTransfer> m_activeTransfers;
+
+    std::atomic<bool> m_stopping{false};
+    std::thread m_thread;
+};
+} // namespace SFS::details
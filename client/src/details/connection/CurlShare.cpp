@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "CurlShare.h"
+
+#include "../ErrorHandling.h"
+#include "../ReportingHandler.h"
+
+#include <curl/curl.h>
+
+#include <mutex>
+
+#define THROW_IF_CURL_SHARE_ERROR(curlCall)                                                                            \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        auto __curlShCode = (curlCall);                                                                                \
+        std::string __message = "Curl share error: " + std::string(curl_share_strerror(__curlShCode));                 \
+        THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed, __curlShCode == CURLSHE_OK, m_handler, std::move(__message));    \
+    } while ((void)0, 0)
+
+using namespace SFS;
+using namespace SFS::details;
+
+namespace SFS::details
+{
+struct CurlShareLocks
+{
+    // One mutex per kind of shared data, so that different kinds can be accessed concurrently
+    std::mutex mutexes[CURL_LOCK_DATA_LAST];
+};
+} // namespace SFS::details
+
+namespace
+{
+std::mutex& GetMutex(void* userPtr, curl_lock_data data)
+{
+    auto& mutexes = static_cast<CurlShareLocks*>(userPtr)->mutexes;
+
+    // Out of range values are not expected, but they still get a valid mutex
+    return mutexes[(data >= 0 && data < CURL_LOCK_DATA_LAST) ? data : CURL_LOCK_DATA_NONE];
+}
+
+void LockCallback(CURL*, curl_lock_data data, curl_lock_access, void* userPtr)
+{
+    GetMutex(userPtr, data).lock();
+}
+
+void UnlockCallback(CURL*, curl_lock_data data, void* userPtr)
+{
+    GetMutex(userPtr, data).unlock();
+}
+} // namespace
+
+CurlShare::CurlShare(const ReportingHandler& handler)
+    : m_handler(handler)
+    , m_locks(std::make_unique<CurlShareLocks>())
+{
+    m_share = curl_share_init();
+    THROW_CODE_IF_NOT_LOG(ConnectionSetupFailed, m_share, m_handler, "Failed to init curl share");
+
+    try
+    {
+        THROW_IF_CURL_SHARE_ERROR(curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, LockCallback));
+        THROW_IF_CURL_SHARE_ERROR(curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, UnlockCallback));
+        THROW_IF_CURL_SHARE_ERROR(curl_share_setopt(m_share, CURLSHOPT_USERDATA, m_locks.get()));
+
+        THROW_IF_CURL_SHARE_ERROR(curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS));
+        THROW_IF_CURL_SHARE_ERROR(curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION));
+
+        // The connection cache (CURL_LOCK_DATA_CONNECT) is not shared: curl does not support using shared connections
+        // from concurrent threads. Connections are instead reused by handing idle handles to later connections.
+    }
+    catch (...)
+    {
+        curl_share_cleanup(m_share);
+        throw;
+    }
+}
+
+CurlShare::~CurlShare()
+{
+    if (m_share)
+    {
+        const CURLSHcode code = curl_share_cleanup(m_share);
+        if (code != CURLSHE_OK)
+        {
+            LOG_ERROR(m_handler, "Failed to clean up curl share: %s", curl_share_strerror(code));
+        }
+    }
+}
+
+CURLSH* CurlShare::GetHandle() const
+{
+    return m_share;
+}
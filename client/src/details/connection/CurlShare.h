@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+
+// Forward declaration
+typedef void CURLSH;
+
+namespace SFS::details
+{
+class ReportingHandler;
+struct CurlShareLocks;
+
+/**
+ * @brief Owns a curl share object that lets curl handles share their DNS cache and TLS session cache
+ * @details Handles attached to the same share can reuse name resolutions and resume TLS sessions established by any
+ * other attached handle, even while they are used concurrently from different threads. Access to the shared data is
+ * serialized through the lock callbacks registered in the share.
+ * The share must outlive all handles attached to it.
+ */
+class CurlShare
+{
+  public:
+    /**
+     * @throws SFSException if the share cannot be set up
+     */
+    CurlShare(const ReportingHandler& handler);
+    ~CurlShare();
+
+    CurlShare(const CurlShare&) = delete;
+    CurlShare& operator=(const CurlShare&) = delete;
+
+    CURLSH* GetHandle() const;
+
+  private:
+    const ReportingHandler& m_handler;
+    std::unique_ptr<CurlShareLocks> m_locks;
+    CURLSH* m_share{nullptr};
+};
+} // namespace SFS::details
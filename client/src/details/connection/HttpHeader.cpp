@@ -3,12 +3,19 @@
 
 #include "HttpHeader.h"
 
+#include "../Util.h"
+
 #include <correlation_vector/correlation_vector.h>
 
+using namespace SFS::details;
+using namespace SFS::details::util;
+
 std::string SFS::details::ToString(HttpHeader header)
 {
     switch (header)
     {
+    case HttpHeader::ContentLength:
+        return "Content-Length";
     case HttpHeader::ContentType:
         return "Content-Type";
     case HttpHeader::MSCV:
@@ -19,3 +26,22 @@ std::string SFS::details::ToString(HttpHeader header)
 
     return "";
 }
+
+std::optional<std::string_view> SFS::details::GetHeaderValue(std::string_view line, HttpHeader header)
+{
+    const auto colon = line.find(':');
+    if (colon == std::string_view::npos || AreNotEqualI(line.substr(0, colon), ToString(header)))
+    {
+        return std::nullopt;
+    }
+
+    constexpr std::string_view whitespace = " \t\r\n";
+    auto value = line.substr(colon + 1);
+    const auto begin = value.find_first_not_of(whitespace);
+    if (begin == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    value = value.substr(begin);
+    return value.substr(0, value.find_last_not_of(whitespace) + 1);
+}
@@ -3,16 +3,25 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
+#include <string_view>
 
 namespace SFS::details
 {
 enum class HttpHeader
 {
+    ContentLength,
     ContentType,
     MSCV,
     RetryAfter,
 };
 
 std::string ToString(HttpHeader header);
+
+/**
+ * @brief Returns the value of @param header if @param line, a raw header line received from the server, is that header
+ * @details Header names are compared case-insensitively, and the whitespace around the value is trimmed.
+ */
+std::optional<std::string_view> GetHeaderValue(std::string_view line, HttpHeader header);
 } // namespace SFS::details
@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "RetryAfterGate.h"
+
+#include "../Util.h"
+
+#include <mutex>
+
+using namespace SFS::details;
+
+RetryAfterGate& RetryAfterGate::GetInstance()
+{
+    static RetryAfterGate s_gate;
+    return s_gate;
+}
+
+void RetryAfterGate::Close(std::string_view url, std::chrono::steady_clock::time_point reopenTime)
+{
+    std::unique_lock lock(m_mutex);
+    RemoveExpired(std::chrono::steady_clock::now());
+
+    auto [it, inserted] = m_reopenTimes.try_emplace(std::string(util::GetHostKey(url)), reopenTime);
+    if (!inserted && it->second < reopenTime)
+    {
+        it->second = reopenTime;
+    }
+    m_closedCount = m_reopenTimes.size();
+}
+
+std::optional<std::chrono::steady_clock::time_point> RetryAfterGate::GetReopenTime(std::string_view url)
+{
+    if (m_closedCount == 0)
+    {
+        return std::nullopt;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::shared_lock lock(m_mutex);
+        const auto it = m_reopenTimes.find(std::string(util::GetHostKey(url)));
+        if (it == m_reopenTimes.end())
+        {
+            return std::nullopt;
+        }
+        if (it->second > now)
+        {
+            return it->second;
+        }
+    }
+
+    // The gate of this host has reopened, so it no longer needs to be looked up
+    std::unique_lock lock(m_mutex);
+    RemoveExpired(now);
+    m_closedCount = m_reopenTimes.size();
+    return std::nullopt;
+}
+
+void RetryAfterGate::RemoveExpired(std::chrono::steady_clock::time_point now)
+{
+    for (auto it = m_reopenTimes.begin(); it != m_reopenTimes.end();)
+    {
+        it = it->second <= now ? m_reopenTimes.erase(it) : std::next(it);
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace SFS::details
+{
+/**
+ * @brief Record of the hosts that asked, through a Retry-After header, not to be sent requests until a given time
+ * @details Hosts are identified by the scheme, name and port of the URLs sent to them. While no host is closed, which
+ * is the common case, a lookup is a single atomic load. This class is thread-safe.
+ */
+class RetryAfterGate
+{
+  public:
+    /**
+     * @brief Returns the gate shared by all connections of the process
+     * @details Sharing it across connections and SFSClient instances keeps a request made after another one was told
+     * to retry later from reaching the host before it is allowed to.
+     */
+    static RetryAfterGate& GetInstance();
+
+    /**
+     * @brief Closes the gate of the host of @param url until @param reopenTime
+     * @details A gate that is already closed until a later time is left as is.
+     */
+    void Close(std::string_view url, std::chrono::steady_clock::time_point reopenTime);
+
+    /**
+     * @brief Returns the time at which the gate of the host of @param url reopens, or std::nullopt if it is open
+     */
+    std::optional<std::chrono::steady_clock::time_point> GetReopenTime(std::string_view url);
+
+  private:
+    void RemoveExpired(std::chrono::steady_clock::time_point now);
+
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_reopenTimes;
+    std::shared_mutex m_mutex;
+
+    // Number of entries in m_reopenTimes, read without taking the lock
+    std::atomic<size_t> m_closedCount{0};
+};
+} // namespace SFS::details
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "RetryBudget.h"
+
+#include <algorithm>
+
+using namespace SFS;
+using namespace SFS::details;
+
+RetryBudget::RetryBudget(double ratio, unsigned maxTokens)
+    : m_ratio(ratio)
+    , m_maxTokens(static_cast<double>(maxTokens))
+    , m_tokens(m_maxTokens)
+{
+}
+
+void RetryBudget::OnRequest()
+{
+    std::lock_guard guard(m_mutex);
+    m_tokens = std::min(m_tokens + m_ratio, m_maxTokens);
+}
+
+bool RetryBudget::TryRetry()
+{
+    std::lock_guard guard(m_mutex);
+    if (m_tokens < 1.0)
+    {
+        ++m_rejectedRetries;
+        return false;
+    }
+
+    m_tokens -= 1.0;
+    ++m_retries;
+    return true;
+}
+
+RetryBudgetStatistics RetryBudget::GetStatistics() const
+{
+    std::lock_guard guard(m_mutex);
+    RetryBudgetStatistics statistics;
+    statistics.availableRetries = m_tokens;
+    statistics.retries = m_retries;
+    statistics.rejectedRetries = m_rejectedRetries;
+    return statistics;
+}
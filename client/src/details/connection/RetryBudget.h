@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "ClientStatistics.h"
+
+#include <cstdint>
+#include <mutex>
+
+namespace SFS::details
+{
+/**
+ * @brief Token bucket that bounds the retries of a set of connections to a fraction of their requests
+ * @details Every request adds @param ratio of a token to the bucket, and every retry takes a whole one, so that over
+ * time retries can not exceed that fraction of the requests. The bucket starts full and holds at most
+ * @param maxTokens, which allows for bursts of retries after a quiet period. This class is thread-safe.
+ */
+class RetryBudget
+{
+  public:
+    RetryBudget(double ratio, unsigned maxTokens);
+
+    RetryBudget(const RetryBudget&) = delete;
+    RetryBudget& operator=(const RetryBudget&) = delete;
+
+    /// @brief Records a request, which adds to the budget
+    void OnRequest();
+
+    /**
+     * @brief Takes a retry from the budget
+     * @return False if the budget is exhausted, in which case the retry must not be made
+     */
+    bool TryRetry();
+
+    RetryBudgetStatistics GetStatistics() const;
+
+  private:
+    const double m_ratio;
+    const double m_maxTokens;
+
+    mutable std::mutex m_mutex;
+    double m_tokens;
+    uint64_t m_retries{0};
+    uint64_t m_rejectedRetries{0};
+};
+} // namespace SFS::details
@@ -7,7 +7,8 @@
 
 using namespace SFS::details;
 
-MockConnectionManager::MockConnectionManager(const ReportingHandler& handler) : ConnectionManager(handler)
+MockConnectionManager::MockConnectionManager(const ReportingHandler& handler, const ConnectionManagerConfig& config)
+    : ConnectionManager(handler, config)
 {
 }
 
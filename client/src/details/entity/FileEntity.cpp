@@ -197,11 +197,27 @@ FileEntities FileEntity::DownloadInfoResponseToFileEntities(const nlohmann::json
     return tmp;
 }
 
+FileEntities FileEntity::CloneEntities(const FileEntities& entities)
+{
+    FileEntities tmp;
+    tmp.reserve(entities.size());
+    for (const auto& entity : entities)
+    {
+        tmp.push_back(entity->Clone());
+    }
+    return tmp;
+}
+
 ContentType GenericFileEntity::GetContentType() const
 {
     return ContentType::Generic;
 }
 
+std::unique_ptr<FileEntity> GenericFileEntity::Clone() const
+{
+    return std::make_unique<GenericFileEntity>(*this);
+}
+
 std::unique_ptr<File> GenericFileEntity::ToFile(FileEntity&& entity, const ReportingHandler& handler)
 {
     ValidateContentType(entity.GetContentType(), ContentType::Generic, handler);
@@ -235,6 +251,11 @@ ContentType AppFileEntity::GetContentType() const
     return ContentType::App;
 }
 
+std::unique_ptr<FileEntity> AppFileEntity::Clone() const
+{
+    return std::make_unique<AppFileEntity>(*this);
+}
+
 std::unique_ptr<AppFile> AppFileEntity::ToAppFile(FileEntity&& entity, const ReportingHandler& handler)
 {
     ValidateContentType(entity.GetContentType(), ContentType::App, handler);
@@ -33,6 +33,11 @@ struct FileEntity
 
     virtual ContentType GetContentType() const = 0;
 
+    /**
+     * @brief Returns a deep copy of this entity, keeping its dynamic type
+     */
+    virtual std::unique_ptr<FileEntity> Clone() const = 0;
+
     std::string fileId;
     std::string url;
     uint64_t sizeInBytes;
@@ -40,11 +45,13 @@ struct FileEntity
 
     static std::unique_ptr<FileEntity> FromJson(const nlohmann::json& file, const ReportingHandler& handler);
     static FileEntities DownloadInfoResponseToFileEntities(const nlohmann::json& data, const ReportingHandler& handler);
+    static FileEntities CloneEntities(const FileEntities& entities);
 };
 
 struct GenericFileEntity : public FileEntity
 {
     ContentType GetContentType() const override;
+    std::unique_ptr<FileEntity> Clone() const override;
 
     static std::unique_ptr<File> ToFile(FileEntity&& entity, const ReportingHandler& handler);
     static std::vector<File> FileEntitiesToFileVector(FileEntities&& entities, const ReportingHandler& handler);
@@ -59,6 +66,7 @@ struct ApplicabilityDetailsEntity
 struct AppFileEntity : public FileEntity
 {
     ContentType GetContentType() const override;
+    std::unique_ptr<FileEntity> Clone() const override;
 
     std::string fileMoniker;
     ApplicabilityDetailsEntity applicabilityDetails;
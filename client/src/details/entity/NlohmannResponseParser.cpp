@@ -0,0 +1,790 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "ResponseParser.h"
+
+#include "../ErrorHandling.h"
+#include "../ReportingHandler.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace SFS;
+using namespace SFS::details;
+using json = nlohmann::json;
+
+namespace
+{
+enum class JsonKind
+{
+    Null,
+    Boolean,
+    Integer,
+    Unsigned,
+    Float,
+    String,
+    Binary,
+    Object,
+    Array
+};
+
+struct StringField
+{
+    bool isPresent{false};
+    bool isString{false};
+    std::string value;
+
+    void Set(JsonKind kind, std::string* str)
+    {
+        isPresent = true;
+        isString = kind == JsonKind::String;
+        value = isString ? std::move(*str) : std::string();
+    }
+};
+
+struct StringArrayField
+{
+    bool isPresent{false};
+    bool isArray{false};
+    bool hasNonStringElement{false};
+    std::vector<std::string> values;
+
+    void Set(JsonKind kind)
+    {
+        isPresent = true;
+        isArray = kind == JsonKind::Array;
+        hasNonStringElement = false;
+        values.clear();
+    }
+
+    void Add(JsonKind kind, std::string* str)
+    {
+        if (kind == JsonKind::String)
+        {
+            values.push_back(std::move(*str));
+        }
+        else
+        {
+            hasNonStringElement = true;
+        }
+    }
+};
+
+std::optional<std::string> CheckStringField(const StringField& field, const std::string& name)
+{
+    if (!field.isPresent)
+    {
+        return "Missing " + name + " in response";
+    }
+    if (!field.isString)
+    {
+        return name + " is not a string";
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> CheckStringArrayField(const StringArrayField& field, const std::string& name)
+{
+    if (!field.isPresent)
+    {
+        return "Missing " + name + " in response";
+    }
+    if (!field.isArray)
+    {
+        return name + " is not an array";
+    }
+    if (field.hasNonStringElement)
+    {
+        return name + " array value is not a string";
+    }
+    return std::nullopt;
+}
+
+struct ContentIdFields
+{
+    StringField nameSpace;
+    StringField name;
+    StringField version;
+
+    void Set(const std::string& key, JsonKind kind, std::string* str)
+    {
+        if (key == "Namespace")
+        {
+            nameSpace.Set(kind, str);
+        }
+        else if (key == "Name")
+        {
+            name.Set(kind, str);
+        }
+        else if (key == "Version")
+        {
+            version.Set(kind, str);
+        }
+    }
+
+    std::optional<std::string> Check(const std::string& prefix) const
+    {
+        if (auto error = CheckStringField(nameSpace, prefix + ".Namespace"))
+        {
+            return error;
+        }
+        if (auto error = CheckStringField(name, prefix + ".Name"))
+        {
+            return error;
+        }
+        return CheckStringField(version, prefix + ".Version");
+    }
+
+    ContentIdEntity ToEntity()
+    {
+        return {std::move(nameSpace.value), std::move(name.value), std::move(version.value)};
+    }
+};
+
+/**
+ * @brief Base of the SAX handlers, which keeps track of where in the document each parsed value is
+ * @details Derived handlers see every value through OnValue(), including the start of objects and arrays, and the end
+ * of objects and arrays through OnEnd(). Depth() is the number of containers around the value, and KeyAt(level) is the
+ * key being read in the object at that level, 0 being the outermost container.
+ * A response that is valid JSON but not a valid entity is recorded with Fail(), and parsing goes on so that syntax
+ * errors further in the document still take precedence, as they do when the whole document is parsed first.
+ */
+class SaxHandler : public nlohmann::json_sax<json>
+{
+  public:
+    bool null() override
+    {
+        return Value(JsonKind::Null);
+    }
+
+    bool boolean(bool) override
+    {
+        return Value(JsonKind::Boolean);
+    }
+
+    bool number_integer(number_integer_t) override
+    {
+        return Value(JsonKind::Integer);
+    }
+
+    bool number_unsigned(number_unsigned_t value) override
+    {
+        return Value(JsonKind::Unsigned, nullptr, value);
+    }
+
+    bool number_float(number_float_t, const string_t&) override
+    {
+        return Value(JsonKind::Float);
+    }
+
+    bool string(string_t& value) override
+    {
+        return Value(JsonKind::String, &value);
+    }
+
+    bool binary(binary_t&) override
+    {
+        return Value(JsonKind::Binary);
+    }
+
+    bool start_object(std::size_t) override
+    {
+        Value(JsonKind::Object);
+        m_levels.emplace_back();
+        return true;
+    }
+
+    bool key(string_t& key) override
+    {
+        m_levels.back() = std::move(key);
+        return true;
+    }
+
+    bool end_object() override
+    {
+        m_levels.pop_back();
+        End(JsonKind::Object);
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        Value(JsonKind::Array);
+        m_levels.emplace_back();
+        return true;
+    }
+
+    bool end_array() override
+    {
+        m_levels.pop_back();
+        End(JsonKind::Array);
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override
+    {
+        m_parseError = ex.what();
+        return false;
+    }
+
+    void Parse(std::string_view data, std::string_view method, const ReportingHandler& handler)
+    {
+        json::sax_parse(data.begin(), data.end(), this);
+        CheckResult(method, handler);
+    }
+
+    // The file is read as the parser goes, so its contents are never in memory all at once
+    void Parse(std::FILE* file, std::string_view method, const ReportingHandler& handler)
+    {
+        json::sax_parse(file, this);
+        CheckResult(method, handler);
+    }
+
+  protected:
+    virtual void OnValue(JsonKind kind, std::string* str, uint64_t number) = 0;
+    virtual void OnEnd(JsonKind kind) = 0;
+
+    // Called once the whole document was parsed, if it is valid so far
+    virtual void OnFinish()
+    {
+    }
+
+    size_t Depth() const
+    {
+        return m_levels.size();
+    }
+
+    const std::string& KeyAt(size_t level) const
+    {
+        return m_levels[level];
+    }
+
+    bool HasFailed() const
+    {
+        return m_error.has_value();
+    }
+
+    void Fail(std::string message)
+    {
+        if (!m_error)
+        {
+            m_error = std::move(message);
+        }
+    }
+
+  private:
+    void CheckResult(std::string_view method, const ReportingHandler& handler)
+    {
+        if (m_parseError)
+        {
+            THROW_LOG(Result(Result::ServiceInvalidResponse,
+                             "(" + std::string(method) + ") JSON Parsing error: " + *m_parseError),
+                      handler);
+        }
+        if (!m_error)
+        {
+            OnFinish();
+        }
+        if (m_error)
+        {
+            THROW_LOG(Result(Result::ServiceInvalidResponse, *m_error), handler);
+        }
+    }
+
+    bool Value(JsonKind kind, std::string* str = nullptr, uint64_t number = 0)
+    {
+        if (!HasFailed())
+        {
+            OnValue(kind, str, number);
+        }
+        return true;
+    }
+
+    void End(JsonKind kind)
+    {
+        if (!HasFailed())
+        {
+            OnEnd(kind);
+        }
+    }
+
+    // Key being read in each open container. Arrays have no keys, so theirs stay empty.
+    std::vector<std::string> m_levels;
+
+    std::optional<std::string> m_parseError;
+    std::optional<std::string> m_error;
+};
+
+/**
+ * @brief Reads version entities, either a single one or an array of them
+ * @details The expected formats are described in VersionEntity::FromJson()
+ */
+class VersionSaxHandler : public SaxHandler
+{
+  public:
+    explicit VersionSaxHandler(bool isBatch) : m_isBatch(isBatch), m_entityDepth(isBatch ? 1 : 0)
+    {
+    }
+
+    VersionEntities TakeEntities()
+    {
+        return std::move(m_entities);
+    }
+
+  protected:
+    void OnValue(JsonKind kind, std::string* str, uint64_t) override
+    {
+        const size_t depth = Depth();
+        if (m_isBatch && depth == 0)
+        {
+            if (kind != JsonKind::Array)
+            {
+                Fail("Response is not a JSON array");
+            }
+            return;
+        }
+
+        if (depth == m_entityDepth)
+        {
+            if (kind != JsonKind::Object)
+            {
+                Fail("Response is not a JSON object");
+            }
+            m_version = {};
+        }
+        else if (depth == m_entityDepth + 1)
+        {
+            const auto& key = KeyAt(m_entityDepth);
+            if (key == "ContentId")
+            {
+                m_version.isContentIdPresent = true;
+                m_version.isContentIdObject = kind == JsonKind::Object;
+                m_version.contentId = {};
+            }
+            else if (key == "UpdateId")
+            {
+                m_version.updateId.Set(kind, str);
+            }
+            else if (key == "Prerequisites")
+            {
+                m_version.arePrerequisitesPresent = true;
+                m_version.arePrerequisitesArray = kind == JsonKind::Array;
+                m_version.prerequisites.clear();
+            }
+        }
+        else if (depth == m_entityDepth + 2)
+        {
+            if (KeyAt(m_entityDepth) == "ContentId" && m_version.isContentIdObject)
+            {
+                m_version.contentId.Set(KeyAt(m_entityDepth + 1), kind, str);
+            }
+            else if (KeyAt(m_entityDepth) == "Prerequisites" && m_version.arePrerequisitesArray)
+            {
+                m_version.prerequisites.push_back({kind == JsonKind::Object, {}});
+            }
+        }
+        else if (depth == m_entityDepth + 3)
+        {
+            if (KeyAt(m_entityDepth) == "Prerequisites" && m_version.arePrerequisitesArray &&
+                m_version.prerequisites.back().isObject)
+            {
+                m_version.prerequisites.back().contentId.Set(KeyAt(m_entityDepth + 2), kind, str);
+            }
+        }
+    }
+
+    void OnFinish() override
+    {
+        if (m_isBatch && m_entities.empty())
+        {
+            Fail("Response does not have the expected size");
+        }
+    }
+
+    void OnEnd(JsonKind kind) override
+    {
+        if (Depth() != m_entityDepth || kind != JsonKind::Object)
+        {
+            return;
+        }
+
+        if (auto error = CheckVersion())
+        {
+            Fail(std::move(*error));
+            return;
+        }
+        m_entities.push_back(MakeEntity());
+    }
+
+  private:
+    struct Prerequisite
+    {
+        bool isObject{false};
+        ContentIdFields contentId;
+    };
+
+    struct Version
+    {
+        bool isContentIdPresent{false};
+        bool isContentIdObject{false};
+        ContentIdFields contentId;
+        StringField updateId;
+        bool arePrerequisitesPresent{false};
+        bool arePrerequisitesArray{false};
+        std::vector<Prerequisite> prerequisites;
+    };
+
+    std::optional<std::string> CheckVersion() const
+    {
+        if (!m_version.isContentIdPresent)
+        {
+            return "Missing ContentId in response";
+        }
+        if (!m_version.isContentIdObject)
+        {
+            return "ContentId is not a JSON object";
+        }
+        if (auto error = m_version.contentId.Check("ContentId"))
+        {
+            return error;
+        }
+
+        // Only app entities have an update id, and their prerequisites are ignored otherwise
+        if (!m_version.updateId.isPresent)
+        {
+            return std::nullopt;
+        }
+        if (!m_version.updateId.isString)
+        {
+            return "UpdateId is not a string";
+        }
+        if (!m_version.arePrerequisitesPresent)
+        {
+            return "Missing Prerequisites in response";
+        }
+        if (!m_version.arePrerequisitesArray)
+        {
+            return "Prerequisites is not an array";
+        }
+        for (const auto& prereq : m_version.prerequisites)
+        {
+            if (!prereq.isObject)
+            {
+                return "Prerequisite element is not a JSON object";
+            }
+            if (auto error = prereq.contentId.Check("Prerequisite"))
+            {
+                return error;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::unique_ptr<VersionEntity> MakeEntity()
+    {
+        if (!m_version.updateId.isPresent)
+        {
+            auto entity = std::make_unique<GenericVersionEntity>();
+            entity->contentId = m_version.contentId.ToEntity();
+            return entity;
+        }
+
+        auto entity = std::make_unique<AppVersionEntity>();
+        entity->contentId = m_version.contentId.ToEntity();
+        entity->updateId = std::move(m_version.updateId.value);
+        for (auto& prereq : m_version.prerequisites)
+        {
+            GenericVersionEntity prereqEntity;
+            prereqEntity.contentId = prereq.contentId.ToEntity();
+            entity->prerequisites.push_back(std::move(prereqEntity));
+        }
+        return entity;
+    }
+
+    const bool m_isBatch;
+
+    // Depth of the version objects, which are inside an array in a batch response
+    const size_t m_entityDepth;
+
+    Version m_version;
+    VersionEntities m_entities;
+};
+
+/**
+ * @brief Reads an array of file entities
+ * @details The expected format of each file is described in FileEntity::FromJson()
+ */
+class DownloadInfoSaxHandler : public SaxHandler
+{
+  public:
+    FileEntities TakeEntities()
+    {
+        return std::move(m_entities);
+    }
+
+  protected:
+    void OnValue(JsonKind kind, std::string* str, uint64_t number) override
+    {
+        const size_t depth = Depth();
+        if (depth == 0)
+        {
+            if (kind != JsonKind::Array)
+            {
+                Fail("Response is not a JSON array");
+            }
+        }
+        else if (depth == 1)
+        {
+            if (kind != JsonKind::Object)
+            {
+                Fail("Array element is not a JSON object");
+            }
+            m_file = {};
+        }
+        else if (depth == 2)
+        {
+            SetFileField(KeyAt(1), kind, str, number);
+        }
+        else if (depth == 3)
+        {
+            if (KeyAt(1) == "Hashes" && m_file.areHashesObject)
+            {
+                if (kind == JsonKind::String)
+                {
+                    m_file.hashes[KeyAt(2)] = std::move(*str);
+                }
+                else
+                {
+                    m_file.hasNonStringHash = true;
+                }
+            }
+            else if (KeyAt(1) == "ApplicabilityDetails" && m_file.areDetailsObject)
+            {
+                if (auto field = GetDetailsField(KeyAt(2)))
+                {
+                    field->Set(kind);
+                }
+            }
+        }
+        else if (depth == 4)
+        {
+            if (KeyAt(1) == "ApplicabilityDetails" && m_file.areDetailsObject)
+            {
+                if (auto field = GetDetailsField(KeyAt(2)); field && field->isArray)
+                {
+                    field->Add(kind, str);
+                }
+            }
+        }
+    }
+
+    void OnEnd(JsonKind kind) override
+    {
+        if (Depth() != 1 || kind != JsonKind::Object)
+        {
+            return;
+        }
+
+        if (auto error = CheckFile())
+        {
+            Fail(std::move(*error));
+            return;
+        }
+        m_entities.push_back(MakeEntity());
+    }
+
+  private:
+    struct File
+    {
+        StringField fileId;
+        StringField url;
+        bool isSizePresent{false};
+        bool isSizeUnsigned{false};
+        uint64_t sizeInBytes{0};
+        bool areHashesPresent{false};
+        bool areHashesObject{false};
+        bool hasNonStringHash{false};
+        std::unordered_map<std::string, std::string> hashes;
+        StringField fileMoniker;
+        bool areDetailsPresent{false};
+        bool areDetailsObject{false};
+        StringArrayField architectures;
+        StringArrayField platformApplicabilityForPackage;
+    };
+
+    void SetFileField(const std::string& key, JsonKind kind, std::string* str, uint64_t number)
+    {
+        if (key == "FileId")
+        {
+            m_file.fileId.Set(kind, str);
+        }
+        else if (key == "Url")
+        {
+            m_file.url.Set(kind, str);
+        }
+        else if (key == "SizeInBytes")
+        {
+            m_file.isSizePresent = true;
+            m_file.isSizeUnsigned = kind == JsonKind::Unsigned;
+            m_file.sizeInBytes = number;
+        }
+        else if (key == "Hashes")
+        {
+            m_file.areHashesPresent = true;
+            m_file.areHashesObject = kind == JsonKind::Object;
+            m_file.hasNonStringHash = false;
+            m_file.hashes.clear();
+        }
+        else if (key == "FileMoniker")
+        {
+            m_file.fileMoniker.Set(kind, str);
+        }
+        else if (key == "ApplicabilityDetails")
+        {
+            m_file.areDetailsPresent = true;
+            m_file.areDetailsObject = kind == JsonKind::Object;
+            m_file.architectures = {};
+            m_file.platformApplicabilityForPackage = {};
+        }
+    }
+
+    StringArrayField* GetDetailsField(const std::string& key)
+    {
+        if (key == "Architectures")
+        {
+            return &m_file.architectures;
+        }
+        if (key == "PlatformApplicabilityForPackage")
+        {
+            return &m_file.platformApplicabilityForPackage;
+        }
+        return nullptr;
+    }
+
+    std::optional<std::string> CheckFile() const
+    {
+        if (auto error = CheckStringField(m_file.fileId, "File.FileId"))
+        {
+            return error;
+        }
+        if (auto error = CheckStringField(m_file.url, "File.Url"))
+        {
+            return error;
+        }
+        if (!m_file.isSizePresent)
+        {
+            return "Missing File.SizeInBytes in response";
+        }
+        if (!m_file.isSizeUnsigned)
+        {
+            return "File.SizeInBytes is not an unsigned number";
+        }
+        if (!m_file.areHashesPresent)
+        {
+            return "Missing File.Hashes in response";
+        }
+        if (!m_file.areHashesObject)
+        {
+            return "File.Hashes is not an object";
+        }
+        if (m_file.hasNonStringHash)
+        {
+            return "File.Hashes object value is not a string";
+        }
+
+        // Only app entities have a file moniker, and their applicability details are ignored otherwise
+        if (!m_file.fileMoniker.isPresent)
+        {
+            return std::nullopt;
+        }
+        if (!m_file.fileMoniker.isString)
+        {
+            return "File.FileMoniker is not a string";
+        }
+        if (!m_file.areDetailsPresent)
+        {
+            return "Missing File.ApplicabilityDetails in response";
+        }
+        if (!m_file.areDetailsObject)
+        {
+            return "File.ApplicabilityDetails is not an object";
+        }
+        if (auto error =
+                CheckStringArrayField(m_file.architectures, "File.ApplicabilityDetails.Architectures"))
+        {
+            return error;
+        }
+        return CheckStringArrayField(m_file.platformApplicabilityForPackage,
+                                     "File.ApplicabilityDetails.PlatformApplicabilityForPackage");
+    }
+
+    std::unique_ptr<FileEntity> MakeEntity()
+    {
+        std::unique_ptr<FileEntity> entity;
+        if (m_file.fileMoniker.isPresent)
+        {
+            auto appEntity = std::make_unique<AppFileEntity>();
+            appEntity->fileMoniker = std::move(m_file.fileMoniker.value);
+            appEntity->applicabilityDetails.architectures = std::move(m_file.architectures.values);
+            appEntity->applicabilityDetails.platformApplicabilityForPackage =
+                std::move(m_file.platformApplicabilityForPackage.values);
+            entity = std::move(appEntity);
+        }
+        else
+        {
+            entity = std::make_unique<GenericFileEntity>();
+        }
+
+        entity->fileId = std::move(m_file.fileId.value);
+        entity->url = std::move(m_file.url.value);
+        entity->sizeInBytes = m_file.sizeInBytes;
+        entity->hashes = std::move(m_file.hashes);
+        return entity;
+    }
+
+    File m_file;
+    FileEntities m_entities;
+};
+} // namespace
+
+std::unique_ptr<VersionEntity> SFS::details::ParseVersionResponse(std::string_view data,
+                                                                  std::string_view method,
+                                                                  const ReportingHandler& handler)
+{
+    VersionSaxHandler sax(false /*isBatch*/);
+    sax.Parse(data, method, handler);
+    auto entities = sax.TakeEntities();
+    return std::move(entities.front());
+}
+
+VersionEntities SFS::details::ParseVersionBatchResponse(std::string_view data,
+                                                        std::string_view method,
+                                                        const ReportingHandler& handler)
+{
+    VersionSaxHandler sax(true /*isBatch*/);
+    sax.Parse(data, method, handler);
+    return sax.TakeEntities();
+}
+
+FileEntities SFS::details::ParseDownloadInfoResponse(std::string_view data,
+                                                     std::string_view method,
+                                                     const ReportingHandler& handler)
+{
+    DownloadInfoSaxHandler sax;
+    sax.Parse(data, method, handler);
+    return sax.TakeEntities();
+}
+
+FileEntities SFS::details::ParseDownloadInfoResponse(std::FILE* file,
+                                                     std::string_view method,
+                                                     const ReportingHandler& handler)
+{
+    DownloadInfoSaxHandler sax;
+    sax.Parse(file, method, handler);
+    return sax.TakeEntities();
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "FileEntity.h"
+#include "VersionEntity.h"
+
+#include <cstdio>
+#include <memory>
+#include <string_view>
+
+// Parsers that read the responses of the service straight into entities. They validate responses the same way as the
+// FromJson() methods of the entities, although the details of JSON syntax errors depend on the library used.
+//
+// The JSON library behind them is chosen at build time by the SFS_USE_SIMDJSON CMake option:
+// - NlohmannResponseParser.cpp uses the SAX parser of nlohmann/json, so no JSON document is built in between.
+// - SimdjsonResponseParser.cpp uses simdjson, which is several times faster on large responses.
+
+namespace SFS::details
+{
+class ReportingHandler;
+
+/**
+ * @brief Parses the response of a latest version or specific version request
+ * @param method Name of the request, used in error messages
+ * @throws SFSException with ServiceInvalidResponse if @param data is not valid JSON or does not describe a version
+ */
+std::unique_ptr<VersionEntity> ParseVersionResponse(std::string_view data,
+                                                    std::string_view method,
+                                                    const ReportingHandler& handler);
+
+/**
+ * @brief Parses the response of a latest version batch request
+ * @param method Name of the request, used in error messages
+ * @throws SFSException with ServiceInvalidResponse if @param data is not valid JSON or is not a non-empty array of
+ * versions
+ */
+VersionEntities ParseVersionBatchResponse(std::string_view data,
+                                          std::string_view method,
+                                          const ReportingHandler& handler);
+
+/**
+ * @brief Parses the response of a download info request
+ * @param method Name of the request, used in error messages
+ * @throws SFSException with ServiceInvalidResponse if @param data is not valid JSON or is not an array of files
+ */
+FileEntities ParseDownloadInfoResponse(std::string_view data, std::string_view method, const ReportingHandler& handler);
+
+/**
+ * @brief Parses the response of a download info request read from @param file, for responses too large to be kept in
+ * memory
+ * @details With nlohmann/json the file is read incrementally, so only the resulting entities are kept in memory. The
+ * simdjson backend needs the whole document in memory, so it reads the file into a buffer first.
+ * @param method Name of the request, used in error messages
+ * @throws SFSException with ServiceInvalidResponse if the contents of @param file are not valid JSON or are not an
+ * array of files
+ */
+FileEntities ParseDownloadInfoResponse(std::FILE* file, std::string_view method, const ReportingHandler& handler);
+} // namespace SFS::details
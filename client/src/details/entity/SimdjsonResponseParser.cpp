@@ -0,0 +1,295 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "ResponseParser.h"
+
+#include "../ErrorHandling.h"
+#include "../ReportingHandler.h"
+
+#include <simdjson.h>
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define THROW_INVALID_RESPONSE_IF_NOT(condition, message, handler)                                                     \
+    THROW_CODE_IF_NOT_LOG(ServiceInvalidResponse, condition, handler, message)
+
+using namespace SFS;
+using namespace SFS::details;
+using simdjson::SUCCESS;
+using simdjson::dom::array;
+using simdjson::dom::element;
+using simdjson::dom::object;
+
+namespace
+{
+/**
+ * @brief Parses @param data into a document that stays valid until the next call on the same thread
+ * @details Each thread reuses its parser, so that the buffers of the parser are only allocated again for a response
+ * larger than all the previous ones.
+ */
+element ParseDocument(std::string_view data, std::string_view method, const ReportingHandler& handler)
+{
+    thread_local simdjson::dom::parser parser;
+
+    element document;
+    if (const auto error = parser.parse(data.data(), data.size()).get(document); error != SUCCESS)
+    {
+        THROW_LOG(Result(Result::ServiceInvalidResponse,
+                         "(" + std::string(method) + ") JSON Parsing error: " + simdjson::error_message(error)),
+                  handler);
+    }
+    return document;
+}
+
+// Looks @param key up the way nlohmann::json does, where the last of duplicate keys wins
+bool FindField(const object& data, std::string_view key, element& value)
+{
+    bool isFound = false;
+    for (const auto& field : data)
+    {
+        if (field.key == key)
+        {
+            value = field.value;
+            isFound = true;
+        }
+    }
+    return isFound;
+}
+
+std::string GetString(const object& data,
+                      std::string_view key,
+                      const std::string& name,
+                      const ReportingHandler& handler)
+{
+    element value;
+    THROW_INVALID_RESPONSE_IF_NOT(FindField(data, key, value), "Missing " + name + " in response", handler);
+
+    std::string_view str;
+    THROW_INVALID_RESPONSE_IF_NOT(value.get(str) == SUCCESS, name + " is not a string", handler);
+    return std::string(str);
+}
+
+std::vector<std::string> GetStringArray(const object& data,
+                                        std::string_view key,
+                                        const std::string& name,
+                                        const ReportingHandler& handler)
+{
+    element value;
+    THROW_INVALID_RESPONSE_IF_NOT(FindField(data, key, value), "Missing " + name + " in response", handler);
+
+    array values;
+    THROW_INVALID_RESPONSE_IF_NOT(value.get(values) == SUCCESS, name + " is not an array", handler);
+
+    std::vector<std::string> tmp;
+    for (const auto& item : values)
+    {
+        std::string_view str;
+        THROW_INVALID_RESPONSE_IF_NOT(item.get(str) == SUCCESS, name + " array value is not a string", handler);
+        tmp.emplace_back(str);
+    }
+    return tmp;
+}
+
+ContentIdEntity ToContentIdEntity(const object& data, const std::string& prefix, const ReportingHandler& handler)
+{
+    ContentIdEntity tmp;
+    tmp.nameSpace = GetString(data, "Namespace", prefix + ".Namespace", handler);
+    tmp.name = GetString(data, "Name", prefix + ".Name", handler);
+    tmp.version = GetString(data, "Version", prefix + ".Version", handler);
+    return tmp;
+}
+
+// The expected format is described in VersionEntity::FromJson()
+std::unique_ptr<VersionEntity> ToVersionEntity(const element& data, const ReportingHandler& handler)
+{
+    object version;
+    THROW_INVALID_RESPONSE_IF_NOT(data.get(version) == SUCCESS, "Response is not a JSON object", handler);
+
+    element contentIdValue;
+    THROW_INVALID_RESPONSE_IF_NOT(FindField(version, "ContentId", contentIdValue),
+                                  "Missing ContentId in response",
+                                  handler);
+    object contentId;
+    THROW_INVALID_RESPONSE_IF_NOT(contentIdValue.get(contentId) == SUCCESS, "ContentId is not a JSON object", handler);
+
+    element updateIdValue;
+    if (!FindField(version, "UpdateId", updateIdValue))
+    {
+        auto tmp = std::make_unique<GenericVersionEntity>();
+        tmp->contentId = ToContentIdEntity(contentId, "ContentId", handler);
+        return tmp;
+    }
+
+    auto tmp = std::make_unique<AppVersionEntity>();
+    tmp->contentId = ToContentIdEntity(contentId, "ContentId", handler);
+
+    std::string_view updateId;
+    THROW_INVALID_RESPONSE_IF_NOT(updateIdValue.get(updateId) == SUCCESS, "UpdateId is not a string", handler);
+    tmp->updateId = updateId;
+
+    element prerequisitesValue;
+    THROW_INVALID_RESPONSE_IF_NOT(FindField(version, "Prerequisites", prerequisitesValue),
+                                  "Missing Prerequisites in response",
+                                  handler);
+    array prerequisites;
+    THROW_INVALID_RESPONSE_IF_NOT(prerequisitesValue.get(prerequisites) == SUCCESS,
+                                  "Prerequisites is not an array",
+                                  handler);
+
+    for (const auto& prereqValue : prerequisites)
+    {
+        object prereq;
+        THROW_INVALID_RESPONSE_IF_NOT(prereqValue.get(prereq) == SUCCESS,
+                                      "Prerequisite element is not a JSON object",
+                                      handler);
+
+        GenericVersionEntity prereqEntity;
+        prereqEntity.contentId = ToContentIdEntity(prereq, "Prerequisite", handler);
+        tmp->prerequisites.push_back(std::move(prereqEntity));
+    }
+    return tmp;
+}
+
+// The expected format is described in FileEntity::FromJson()
+std::unique_ptr<FileEntity> ToFileEntity(const object& file, const ReportingHandler& handler)
+{
+    std::unique_ptr<FileEntity> tmp;
+    element fileMonikerValue;
+    const bool isAppEntity = FindField(file, "FileMoniker", fileMonikerValue);
+    if (isAppEntity)
+    {
+        tmp = std::make_unique<AppFileEntity>();
+    }
+    else
+    {
+        tmp = std::make_unique<GenericFileEntity>();
+    }
+
+    tmp->fileId = GetString(file, "FileId", "File.FileId", handler);
+    tmp->url = GetString(file, "Url", "File.Url", handler);
+
+    element sizeValue;
+    THROW_INVALID_RESPONSE_IF_NOT(FindField(file, "SizeInBytes", sizeValue),
+                                  "Missing File.SizeInBytes in response",
+                                  handler);
+    THROW_INVALID_RESPONSE_IF_NOT(sizeValue.get(tmp->sizeInBytes) == SUCCESS,
+                                  "File.SizeInBytes is not an unsigned number",
+                                  handler);
+
+    element hashesValue;
+    THROW_INVALID_RESPONSE_IF_NOT(FindField(file, "Hashes", hashesValue), "Missing File.Hashes in response", handler);
+    object hashes;
+    THROW_INVALID_RESPONSE_IF_NOT(hashesValue.get(hashes) == SUCCESS, "File.Hashes is not an object", handler);
+
+    // Duplicate hash types are resolved before validating values, like nlohmann::json does when parsing
+    std::unordered_map<std::string_view, element> hashValues;
+    for (const auto& [hashType, hashValue] : hashes)
+    {
+        hashValues[hashType] = hashValue;
+    }
+    for (const auto& [hashType, hashValue] : hashValues)
+    {
+        std::string_view str;
+        THROW_INVALID_RESPONSE_IF_NOT(hashValue.get(str) == SUCCESS,
+                                      "File.Hashes object value is not a string",
+                                      handler);
+        tmp->hashes[std::string(hashType)] = str;
+    }
+
+    if (isAppEntity)
+    {
+        auto appEntity = dynamic_cast<AppFileEntity*>(tmp.get());
+
+        std::string_view fileMoniker;
+        THROW_INVALID_RESPONSE_IF_NOT(fileMonikerValue.get(fileMoniker) == SUCCESS,
+                                      "File.FileMoniker is not a string",
+                                      handler);
+        appEntity->fileMoniker = fileMoniker;
+
+        element detailsValue;
+        THROW_INVALID_RESPONSE_IF_NOT(FindField(file, "ApplicabilityDetails", detailsValue),
+                                      "Missing File.ApplicabilityDetails in response",
+                                      handler);
+        object details;
+        THROW_INVALID_RESPONSE_IF_NOT(detailsValue.get(details) == SUCCESS,
+                                      "File.ApplicabilityDetails is not an object",
+                                      handler);
+
+        appEntity->applicabilityDetails.architectures =
+            GetStringArray(details, "Architectures", "File.ApplicabilityDetails.Architectures", handler);
+        appEntity->applicabilityDetails.platformApplicabilityForPackage =
+            GetStringArray(details,
+                           "PlatformApplicabilityForPackage",
+                           "File.ApplicabilityDetails.PlatformApplicabilityForPackage",
+                           handler);
+    }
+
+    return tmp;
+}
+} // namespace
+
+std::unique_ptr<VersionEntity> SFS::details::ParseVersionResponse(std::string_view data,
+                                                                  std::string_view method,
+                                                                  const ReportingHandler& handler)
+{
+    return ToVersionEntity(ParseDocument(data, method, handler), handler);
+}
+
+VersionEntities SFS::details::ParseVersionBatchResponse(std::string_view data,
+                                                        std::string_view method,
+                                                        const ReportingHandler& handler)
+{
+    array versions;
+    THROW_INVALID_RESPONSE_IF_NOT(ParseDocument(data, method, handler).get(versions) == SUCCESS,
+                                  "Response is not a JSON array",
+                                  handler);
+    THROW_INVALID_RESPONSE_IF_NOT(versions.begin() != versions.end(),
+                                  "Response does not have the expected size",
+                                  handler);
+
+    VersionEntities tmp;
+    for (const auto& version : versions)
+    {
+        tmp.push_back(ToVersionEntity(version, handler));
+    }
+    return tmp;
+}
+
+FileEntities SFS::details::ParseDownloadInfoResponse(std::string_view data,
+                                                     std::string_view method,
+                                                     const ReportingHandler& handler)
+{
+    array files;
+    THROW_INVALID_RESPONSE_IF_NOT(ParseDocument(data, method, handler).get(files) == SUCCESS,
+                                  "Response is not a JSON array",
+                                  handler);
+
+    FileEntities tmp;
+    for (const auto& fileValue : files)
+    {
+        object file;
+        THROW_INVALID_RESPONSE_IF_NOT(fileValue.get(file) == SUCCESS, "Array element is not a JSON object", handler);
+        tmp.push_back(ToFileEntity(file, handler));
+    }
+    return tmp;
+}
+
+FileEntities SFS::details::ParseDownloadInfoResponse(std::FILE* file,
+                                                     std::string_view method,
+                                                     const ReportingHandler& handler)
+{
+    // simdjson only parses whole documents, so the response is read back into memory
+    std::string data;
+    char chunk[64 * 1024];
+    size_t size = 0;
+    while ((size = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        data.append(chunk, size);
+    }
+    THROW_CODE_IF_LOG(Unexpected, std::ferror(file), handler, "Failed to read the response back from its file");
+
+    return ParseDownloadInfoResponse(std::string_view(data), method, handler);
+}
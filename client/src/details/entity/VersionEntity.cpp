@@ -127,11 +127,21 @@ ContentType GenericVersionEntity::GetContentType() const
     return ContentType::Generic;
 }
 
+std::unique_ptr<VersionEntity> GenericVersionEntity::Clone() const
+{
+    return std::make_unique<GenericVersionEntity>(*this);
+}
+
 ContentType AppVersionEntity::GetContentType() const
 {
     return ContentType::App;
 }
 
+std::unique_ptr<VersionEntity> AppVersionEntity::Clone() const
+{
+    return std::make_unique<AppVersionEntity>(*this);
+}
+
 AppVersionEntity* AppVersionEntity::GetAppVersionEntityPtr(std::unique_ptr<VersionEntity>& versionEntity,
                                                            const ReportingHandler& handler)
 {
@@ -34,6 +34,11 @@ struct VersionEntity
 
     virtual ContentType GetContentType() const = 0;
 
+    /**
+     * @brief Returns a deep copy of this entity, keeping its dynamic type
+     */
+    virtual std::unique_ptr<VersionEntity> Clone() const = 0;
+
     ContentIdEntity contentId;
 
     static std::unique_ptr<VersionEntity> FromJson(const nlohmann::json& data, const ReportingHandler& handler);
@@ -43,11 +48,13 @@ struct VersionEntity
 struct GenericVersionEntity : public VersionEntity
 {
     ContentType GetContentType() const override;
+    std::unique_ptr<VersionEntity> Clone() const override;
 };
 
 struct AppVersionEntity : public VersionEntity
 {
     ContentType GetContentType() const override;
+    std::unique_ptr<VersionEntity> Clone() const override;
 
     std::string updateId;
     std::vector<GenericVersionEntity> prerequisites;
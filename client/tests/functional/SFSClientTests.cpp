@@ -7,8 +7,11 @@
 #include "sfsclient/SFSClient.h"
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
 #include <chrono>
+#include <queue>
+#include <thread>
 
 #define TEST(...) TEST_CASE("[Functional][SFSClientTests] " __VA_ARGS__)
 
@@ -91,9 +94,12 @@ TEST("Testing SFSClient::GetLatestDownloadInfo()")
     test::MockWebServer server;
     ScopedTestOverride override(TestOverride::BaseUrl, server.GetBaseUrl());
 
+    // Both transfer modes must behave the same way
+    ClientConfig clientConfig{"testAccountId", c_instanceId, c_namespace, LogCallbackToTest};
+    clientConfig.useBackgroundTransferThread = GENERATE(false, true);
+
     std::unique_ptr<SFSClient> sfsClient;
-    REQUIRE(SFSClient::Make({"testAccountId", c_instanceId, c_namespace, LogCallbackToTest}, sfsClient) ==
-            Result::Success);
+    REQUIRE(SFSClient::Make(clientConfig, sfsClient) == Result::Success);
     REQUIRE(sfsClient != nullptr);
 
     server.RegisterProduct(c_productName, c_version);
@@ -143,6 +149,58 @@ TEST("Testing SFSClient::GetLatestDownloadInfo()")
             CheckMockContent(contents[0], c_nextVersion);
         }
     }
+
+    SECTION("Multiple product request")
+    {
+        const std::string product2 = c_productName + "2";
+        const std::string product3 = c_productName + "3";
+        server.RegisterProduct(product2, c_nextVersion);
+        server.RegisterProduct(product3, c_version);
+
+        RequestParams params;
+        params.baseCV = "aaaaaaaaaaaaaaaa.1";
+
+        SECTION("All products are returned in the order of the request")
+        {
+            params.productRequests = {{product3, {}}, {c_productName, {{"attr1", "value"}}}, {product2, {}}};
+            REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+            REQUIRE(contents.size() == 3);
+            CheckContentId(contents[0].GetContentId(), product3, c_version);
+            CheckContentId(contents[1].GetContentId(), c_productName, c_version);
+            CheckContentId(contents[2].GetContentId(), product2, c_nextVersion);
+            for (const auto& content : contents)
+            {
+                const auto& files = content.GetFiles();
+                REQUIRE(files.size() == 2);
+                REQUIRE(files[0].GetFileId() == (content.GetContentId().GetName() + ".json"));
+                REQUIRE(files[1].GetFileId() == (content.GetContentId().GetName() + ".bin"));
+            }
+        }
+
+        SECTION("Repeated products are only returned once")
+        {
+            params.productRequests = {{c_productName, {}}, {product2, {}}, {c_productName, {}}};
+            REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+            REQUIRE(contents.size() == 2);
+            CheckContentId(contents[0].GetContentId(), c_productName, c_version);
+            CheckContentId(contents[1].GetContentId(), product2, c_nextVersion);
+        }
+
+        SECTION("Unknown products are left out")
+        {
+            params.productRequests = {{"badName", {}}, {product2, {}}};
+            REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+            REQUIRE(contents.size() == 1);
+            CheckContentId(contents[0].GetContentId(), product2, c_nextVersion);
+        }
+
+        SECTION("No known products")
+        {
+            params.productRequests = {{"badName", {}}, {"badName2", {}}};
+            REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::HttpNotFound);
+            REQUIRE(contents.empty());
+        }
+    }
 }
 
 TEST("Testing SFSClient::GetLatestAppDownloadInfo()")
@@ -160,9 +218,12 @@ TEST("Testing SFSClient::GetLatestAppDownloadInfo()")
     const std::string prereq2 = "prereq2";
     const std::string prereq2Version = "2.0";
 
+    // Prerequisites are retrieved either one at a time or concurrently, and must come back in the same order
+    ClientConfig clientConfig{"testAccountId", "storeapps", c_namespace, LogCallbackToTest};
+    clientConfig.maxParallelRequestsPerCall = GENERATE(1u, 8u);
+
     std::unique_ptr<SFSClient> sfsClient;
-    REQUIRE(SFSClient::Make({"testAccountId", "storeapps", c_namespace, LogCallbackToTest}, sfsClient) ==
-            Result::Success);
+    REQUIRE(SFSClient::Make(clientConfig, sfsClient) == Result::Success);
     REQUIRE(sfsClient != nullptr);
 
     SECTION("App products")
@@ -228,6 +289,16 @@ TEST("Testing SFSClient::GetLatestAppDownloadInfo()")
         {
             CheckApp({{prereq1, prereq1Version}, {prereq2, prereq2Version}});
         }
+
+        SECTION("Many prereqs")
+        {
+            std::vector<MockPrerequisite> mockPrereqs;
+            for (int i = 0; i < 10; ++i)
+            {
+                mockPrereqs.push_back({"prereq" + std::to_string(i), std::to_string(i) + ".0"});
+            }
+            CheckApp(mockPrereqs);
+        }
     }
 
     SECTION("Non-app products")
@@ -246,6 +317,250 @@ TEST("Testing SFSClient::GetLatestAppDownloadInfo()")
     }
 }
 
+TEST("Testing SFSClient async API")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        return;
+    }
+
+    test::MockWebServer server;
+    ScopedTestOverride override(TestOverride::BaseUrl, server.GetBaseUrl());
+
+    ClientConfig clientConfig{"testAccountId", c_instanceId, c_namespace, LogCallbackToTest};
+    clientConfig.maxAsyncThreads = 2;
+    clientConfig.useBackgroundTransferThread = GENERATE(false, true);
+
+    std::unique_ptr<SFSClient> sfsClient;
+    REQUIRE(SFSClient::Make(clientConfig, sfsClient) == Result::Success);
+    REQUIRE(sfsClient != nullptr);
+
+    // More products than async threads, so some calls wait in the queue
+    const int productCount = 6;
+    for (int i = 0; i < productCount; ++i)
+    {
+        server.RegisterProduct(c_productName + std::to_string(i), c_version);
+    }
+
+    std::vector<std::future<AsyncResult<std::vector<Content>>>> futures(productCount);
+    for (int i = 0; i < productCount; ++i)
+    {
+        RequestParams params;
+        params.productRequests = {{c_productName + std::to_string(i), {}}};
+        REQUIRE(sfsClient->GetLatestDownloadInfoAsync(params, futures[i]) == Result::Success);
+    }
+
+    RequestParams badParams;
+    badParams.productRequests = {{"badName", {}}};
+    std::future<AsyncResult<std::vector<Content>>> badFuture;
+    REQUIRE(sfsClient->GetLatestDownloadInfoAsync(badParams, badFuture) == Result::Success);
+
+    for (int i = 0; i < productCount; ++i)
+    {
+        auto result = futures[i].get();
+        REQUIRE(result.result == Result::Success);
+        REQUIRE(result.value.size() == 1);
+        CheckContentId(result.value[0].GetContentId(), c_productName + std::to_string(i), c_version);
+    }
+
+    auto badResult = badFuture.get();
+    REQUIRE(badResult.result == Result::HttpNotFound);
+    REQUIRE(badResult.value.empty());
+}
+
+TEST("Testing SFSClient stale-while-revalidate cache")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        return;
+    }
+
+    test::MockWebServer server;
+    ScopedTestOverride override(TestOverride::BaseUrl, server.GetBaseUrl());
+
+    ClientConfig clientConfig{"testAccountId", c_instanceId, c_namespace, LogCallbackToTest};
+    clientConfig.latestVersionCacheTtl = 1s;
+    clientConfig.latestVersionCacheStaleWhileRevalidate = 1h;
+    clientConfig.downloadInfoCacheTtl = 1h;
+
+    std::unique_ptr<SFSClient> sfsClient;
+    REQUIRE(SFSClient::Make(clientConfig, sfsClient) == Result::Success);
+
+    server.RegisterProduct(c_productName, c_version);
+
+    RequestParams params;
+    params.productRequests = {{c_productName, {}}};
+
+    std::vector<Content> contents;
+    REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+    REQUIRE(contents.size() == 1);
+    CheckMockContent(contents[0], c_version);
+
+    // Once expired, the cached version is returned right away while the new one is fetched in the background
+    server.RegisterProduct(c_productName, c_nextVersion);
+    std::this_thread::sleep_for(1100ms);
+
+    REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+    REQUIRE(contents.size() == 1);
+    CheckMockContent(contents[0], c_version);
+    REQUIRE(sfsClient->GetStatistics().latestVersionCache.staleHits == 1);
+
+    // The download info of the stale version is cached along with it, so it is not looked up again
+    REQUIRE(sfsClient->GetStatistics().downloadInfoCache.hits == 0);
+
+    const auto deadline = steady_clock::now() + 10s;
+    do
+    {
+        std::this_thread::sleep_for(10ms);
+        REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+        REQUIRE(contents.size() == 1);
+    } while (contents[0].GetContentId().GetVersion() != c_nextVersion && steady_clock::now() < deadline);
+
+    CheckMockContent(contents[0], c_nextVersion);
+}
+
+TEST("Testing SFSClient caches the latest versions of multiple products")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        return;
+    }
+
+    test::MockWebServer server;
+    ScopedTestOverride override(TestOverride::BaseUrl, server.GetBaseUrl());
+
+    ClientConfig clientConfig{"testAccountId", c_instanceId, c_namespace, LogCallbackToTest};
+    clientConfig.latestVersionCacheTtl = 1h;
+
+    std::unique_ptr<SFSClient> sfsClient;
+    REQUIRE(SFSClient::Make(clientConfig, sfsClient) == Result::Success);
+
+    const std::string product1 = c_productName + "1";
+    const std::string product2 = c_productName + "2";
+    const std::string product3 = c_productName + "3";
+    server.RegisterProduct(product1, c_version);
+    server.RegisterProduct(product2, c_version);
+    server.RegisterProduct(product3, c_version);
+
+    RequestParams params;
+    params.productRequests = {{product1, {}}, {product2, {}}};
+
+    std::vector<Content> contents;
+    REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+    REQUIRE(contents.size() == 2);
+    REQUIRE(sfsClient->GetStatistics().latestVersionCache.misses == 2);
+
+    // Cached products are not part of the batch request anymore, so newer versions are not seen yet
+    server.RegisterProduct(product1, c_nextVersion);
+    server.RegisterProduct(product3, c_nextVersion);
+    params.productRequests = {{product1, {}}, {product3, {}}};
+    REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+    REQUIRE(contents.size() == 2);
+    CheckContentId(contents[0].GetContentId(), product1, c_version);
+    CheckContentId(contents[1].GetContentId(), product3, c_nextVersion);
+
+    const auto statistics = sfsClient->GetStatistics().latestVersionCache;
+    REQUIRE(statistics.hits == 1);
+    REQUIRE(statistics.misses == 3);
+
+    INFO("Single product lookups use the versions cached by multiple product lookups");
+    params.productRequests = {{product2, {}}};
+    REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+    REQUIRE(sfsClient->GetStatistics().latestVersionCache.hits == 2);
+}
+
+TEST("Testing SFSClient latest version batching")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        return;
+    }
+
+    test::MockWebServer server;
+    ScopedTestOverride override(TestOverride::BaseUrl, server.GetBaseUrl());
+
+    const int productCount = 4;
+    ClientConfig clientConfig{"testAccountId", c_instanceId, c_namespace, LogCallbackToTest};
+    clientConfig.latestVersionBatchWindow = 10s;
+    clientConfig.latestVersionBatchMaxSize = productCount + 1;
+    clientConfig.maxAsyncThreads = productCount + 1;
+    clientConfig.useBackgroundTransferThread = GENERATE(false, true);
+
+    std::unique_ptr<SFSClient> sfsClient;
+    REQUIRE(SFSClient::Make(clientConfig, sfsClient) == Result::Success);
+
+    for (int i = 0; i < productCount; ++i)
+    {
+        server.RegisterProduct(c_productName + std::to_string(i), c_version);
+    }
+
+    // Together with the unknown product, the lookups fill a batch, which is sent without waiting for the window
+    std::vector<std::future<AsyncResult<std::vector<Content>>>> futures(productCount + 1);
+    for (int i = 0; i <= productCount; ++i)
+    {
+        RequestParams params;
+        params.productRequests = {{i < productCount ? c_productName + std::to_string(i) : "badName", {}}};
+        REQUIRE(sfsClient->GetLatestDownloadInfoAsync(params, futures[i]) == Result::Success);
+    }
+
+    for (int i = 0; i < productCount; ++i)
+    {
+        auto result = futures[i].get();
+        REQUIRE(result.result == Result::Success);
+        REQUIRE(result.value.size() == 1);
+        CheckContentId(result.value[0].GetContentId(), c_productName + std::to_string(i), c_version);
+    }
+    REQUIRE(futures[productCount].get().result == Result::HttpNotFound);
+
+    const auto statistics = sfsClient->GetStatistics();
+    REQUIRE(statistics.latestVersionBatches == 1);
+    REQUIRE(statistics.batchedLatestVersionLookups == productCount + 1);
+}
+
+TEST("Testing SFSClient hedged latest version lookups")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        return;
+    }
+
+    test::MockWebServer server;
+    ScopedTestOverride override(TestOverride::BaseUrl, server.GetBaseUrl());
+
+    ClientConfig clientConfig{"testAccountId", c_instanceId, c_namespace, LogCallbackToTest};
+    clientConfig.latestVersionHedgePercentile = 1.0;
+    clientConfig.latestVersionHedgeMaxRate = 1.0;
+    clientConfig.useBackgroundTransferThread = GENERATE(false, true);
+
+    std::unique_ptr<SFSClient> sfsClient;
+    REQUIRE(SFSClient::Make(clientConfig, sfsClient) == Result::Success);
+
+    server.RegisterProduct(c_productName, c_version);
+
+    RequestParams params;
+    params.productRequests = {{c_productName, {}}};
+
+    // Lookups are only hedged once the latencies of 20 of them are known
+    std::vector<Content> contents;
+    for (int i = 0; i < 20; ++i)
+    {
+        REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+    }
+    REQUIRE(sfsClient->GetStatistics().hedgedRequests == 0);
+
+    // The hedge of the slow lookup answers first, and the call does not wait for the slow request to be aborted
+    server.SetResponseDelays(std::queue<milliseconds>({2s}));
+    const auto begin = steady_clock::now();
+    REQUIRE(sfsClient->GetLatestDownloadInfo(params, contents) == Result::Success);
+    REQUIRE(steady_clock::now() - begin < 1s);
+    REQUIRE(contents.size() == 1);
+    CheckMockContent(contents[0], c_version);
+
+    const auto statistics = sfsClient->GetStatistics();
+    REQUIRE(statistics.hedgedRequests == 1);
+    REQUIRE(statistics.hedgeWins == 1);
+}
+
 TEST("Testing SFSClient retry behavior")
 {
     if (!AreTestOverridesAllowed())
@@ -270,6 +585,8 @@ TEST("Testing SFSClient retry behavior")
         INFO("Sets the retry delay to 50ms to speed up the test");
         ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 50);
 
+        // Without jitter, so that the delays are exact
+        clientConfig.jitterRetryDelays = false;
         REQUIRE(SFSClient::Make(clientConfig, sfsClient));
         REQUIRE(sfsClient != nullptr);
 
@@ -334,6 +651,8 @@ TEST("Testing SFSClient retry behavior")
         INFO("Sets the retry delay to 200ms to speed up the test");
         ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 200);
 
+        // Without jitter, so that the delays are exact
+        clientConfig.jitterRetryDelays = false;
         REQUIRE(SFSClient::Make(clientConfig, sfsClient));
         REQUIRE(sfsClient != nullptr);
 
@@ -1,15 +1,19 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 
+#include "../../mock/MockHttp2Server.h"
 #include "../../mock/MockWebServer.h"
 #include "../../util/SFSExceptionMatcher.h"
 #include "../../util/TestHelper.h"
 #include "ReportingHandler.h"
 #include "SFSUrlComponents.h"
 #include "TestOverride.h"
+#include "connection/CircuitBreaker.h"
 #include "connection/CurlConnection.h"
 #include "connection/CurlConnectionManager.h"
+#include "connection/CurlMultiConnectionManager.h"
 #include "connection/HttpHeader.h"
+#include "connection/RetryBudget.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
@@ -17,7 +21,10 @@
 #include <nlohmann/json.hpp>
 
 #include <chrono>
+#include <cstdio>
+#include <future>
 #include <sstream>
+#include <thread>
 
 #define TEST(...) TEST_CASE("[Functional][CurlConnectionTests] " __VA_ARGS__)
 
@@ -71,6 +78,30 @@ class CurlConnectionTimeoutManager : public CurlConnectionManager
     }
 };
 
+class CurlConnectionWithInfo : public CurlConnection
+{
+  public:
+    using CurlConnection::CurlConnection;
+
+    long GetNumConnects() const
+    {
+        long numConnects = -1;
+        curl_easy_getinfo(m_handle, CURLINFO_NUM_CONNECTS, &numConnects);
+        return numConnects;
+    }
+};
+
+class CurlConnectionWithInfoManager : public CurlConnectionManager
+{
+  public:
+    using CurlConnectionManager::CurlConnectionManager;
+
+    std::unique_ptr<Connection> MakeConnection(const ConnectionConfig& config) override
+    {
+        return std::make_unique<CurlConnectionWithInfo>(config, m_handler, m_handlePool.get());
+    }
+};
+
 std::string TimestampToHttpDateString(std::chrono::time_point<std::chrono::system_clock> time)
 {
     auto timer = system_clock::to_time_t(time);
@@ -277,6 +308,239 @@ TEST("Testing CurlConnection works from a second ConnectionManager")
     }
 }
 
+TEST("Testing connections are reused across requests")
+{
+    test::MockWebServer server;
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string url = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                    c_instanceId,
+                                                                    c_namespace,
+                                                                    c_productName,
+                                                                    c_version);
+
+    auto RunGetAndCountConnects = [&](CurlConnectionManager& connectionManager) -> long {
+        auto connection = connectionManager.MakeConnection({});
+        REQUIRE_NOTHROW(connection->Get(url));
+        return dynamic_cast<CurlConnectionWithInfo&>(*connection).GetNumConnects();
+    };
+
+    SECTION("A new connection reuses the server connection left by a previous one")
+    {
+        CurlConnectionWithInfoManager connectionManager(handler);
+
+        INFO("First request opens a new connection");
+        REQUIRE(RunGetAndCountConnects(connectionManager) == 1);
+
+        INFO("Next requests reuse it");
+        REQUIRE(RunGetAndCountConnects(connectionManager) == 0);
+        REQUIRE(RunGetAndCountConnects(connectionManager) == 0);
+    }
+
+    SECTION("Pooling can be disabled")
+    {
+        ConnectionManagerConfig config;
+        config.maxIdleConnections = 0;
+        CurlConnectionWithInfoManager connectionManager(handler, config);
+
+        REQUIRE(RunGetAndCountConnects(connectionManager) == 1);
+        REQUIRE(RunGetAndCountConnects(connectionManager) == 1);
+    }
+
+    REQUIRE(server.Stop() == Result::Success);
+}
+
+TEST("Testing concurrent connections from the same manager")
+{
+    test::MockWebServer server;
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+    CurlConnectionManager connectionManager(handler);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string url = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                    c_instanceId,
+                                                                    c_namespace,
+                                                                    c_productName,
+                                                                    c_version);
+
+    // Connections share the DNS and TLS session caches of the manager while running on different threads
+    const int threadCount = 8;
+    std::vector<std::thread> threads;
+    std::vector<Result::Code> results(threadCount, Result::NotSet);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            try
+            {
+                auto connection = connectionManager.MakeConnection({});
+                for (int j = 0; j < 5; ++j)
+                {
+                    connection->Get(url);
+                }
+                results[i] = Result::Success;
+            }
+            catch (const SFSException& e)
+            {
+                results[i] = e.GetResult().GetCode();
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& result : results)
+    {
+        REQUIRE(result == Result::Success);
+    }
+
+    REQUIRE(server.Stop() == Result::Success);
+}
+
+TEST("Testing concurrent connections from a CurlMultiConnectionManager")
+{
+    test::MockWebServer server;
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+    CurlMultiConnectionManager connectionManager(handler);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string getUrl = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                       c_instanceId,
+                                                                       c_namespace,
+                                                                       c_productName,
+                                                                       c_version);
+    const std::string postUrl =
+        SFSUrlComponents::GetLatestVersionBatchUrl(server.GetBaseUrl(), c_instanceId, c_namespace);
+    const std::string body = json({{{"TargetingAttributes", {}}, {"Product", c_productName}}}).dump();
+
+    // All transfers are driven by the single engine thread of the manager, while the calling threads wait on them
+    const int threadCount = 8;
+    std::vector<std::thread> threads;
+    std::vector<Result::Code> results(threadCount, Result::NotSet);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            try
+            {
+                auto connection = connectionManager.MakeConnection({});
+                for (int j = 0; j < 5; ++j)
+                {
+                    const json getResponse = json::parse(connection->Get(getUrl));
+                    const json postResponse = json::parse(connection->Post(postUrl, body));
+                    if (getResponse["ContentId"]["Version"] != c_version ||
+                        postResponse[0]["ContentId"]["Version"] != c_version)
+                    {
+                        results[i] = Result::ServiceInvalidResponse;
+                        return;
+                    }
+                }
+                results[i] = Result::Success;
+            }
+            catch (const SFSException& e)
+            {
+                results[i] = e.GetResult().GetCode();
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& result : results)
+    {
+        REQUIRE(result == Result::Success);
+    }
+
+    // Errors are reported the same way as with a transfer run in the calling thread
+    auto connection = connectionManager.MakeConnection({});
+    const std::string badUrl = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                       c_instanceId,
+                                                                       c_namespace,
+                                                                       "badName",
+                                                                       c_version);
+    REQUIRE_THROWS_CODE(connection->Get(badUrl), HttpNotFound);
+
+    REQUIRE(server.Stop() == Result::Success);
+}
+
+TEST("Testing concurrent requests share a single HTTP/2 connection")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        INFO("Skipping. Test overrides not enabled");
+        return;
+    }
+
+    // The mock server only speaks h2c, which curl uses without negotiation
+    ScopedTestOverride override(TestOverride::Http2PriorKnowledge, 1);
+
+    test::MockWebServer server;
+    test::MockHttp2Server http2Server(server);
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    ConnectionManagerConfig managerConfig;
+    managerConfig.useHttp2 = true;
+    CurlMultiConnectionManager connectionManager(handler, managerConfig);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string postUrl =
+        SFSUrlComponents::GetLatestVersionBatchUrl(http2Server.GetBaseUrl(), c_instanceId, c_namespace);
+    const std::string body = json({{{"TargetingAttributes", {}}, {"Product", c_productName}}}).dump();
+
+    // Each thread has its own connection, but their requests are multiplexed as streams of the same TCP connection
+    const int threadCount = 8;
+    const int requestsPerThread = 4;
+    std::vector<std::thread> threads;
+    std::vector<Result::Code> results(threadCount, Result::NotSet);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            try
+            {
+                auto connection = connectionManager.MakeConnection({});
+                for (int j = 0; j < requestsPerThread; ++j)
+                {
+                    const json response = json::parse(connection->Post(postUrl, body));
+                    if (response[0]["ContentId"]["Version"] != c_version)
+                    {
+                        results[i] = Result::ServiceInvalidResponse;
+                        return;
+                    }
+                }
+                results[i] = Result::Success;
+            }
+            catch (const SFSException& e)
+            {
+                results[i] = e.GetResult().GetCode();
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& result : results)
+    {
+        REQUIRE(result == Result::Success);
+    }
+
+    REQUIRE(http2Server.GetRequestCount() == threadCount * requestsPerThread);
+    REQUIRE(http2Server.GetConnectionCount() == 1);
+
+    REQUIRE(server.Stop() == Result::Success);
+}
+
 TEST("Testing a url that's too big throws 414")
 {
     ReportingHandler handler;
@@ -328,6 +592,13 @@ TEST("Testing a response over the limit fails the operation")
     json body = {{{"TargetingAttributes", {}}, {"Product", largeProductName}}};
     REQUIRE_NOTHROW(connection->Post(url, body.dump()));
 
+    // A smaller response after it only gets its own content, although the connection reuses its response buffer
+    server.RegisterProduct(c_productName, c_version);
+    body[0]["Product"] = c_productName;
+    std::string out;
+    REQUIRE_NOTHROW(out = connection->Post(url, body.dump()));
+    REQUIRE(json::parse(out)[0]["ContentId"]["Name"] == c_productName);
+
     // Over limit fails
     body[0]["Product"] = overLimitProductName;
     REQUIRE_THROWS_CODE_MSG(connection->Post(url, body.dump()),
@@ -335,6 +606,132 @@ TEST("Testing a response over the limit fails the operation")
                             "Failure writing output to destination");
 }
 
+TEST("Testing the response limit is configurable and responses over it can be streamed to a file")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    test::MockWebServer server;
+    CurlConnectionManager connectionManager(handler);
+    server.RegisterProduct(c_productName, c_version);
+
+    const std::string url =
+        SFSUrlComponents::GetDownloadInfoUrl(server.GetBaseUrl(), c_instanceId, c_namespace, c_productName, c_version);
+    const std::string expected = connectionManager.MakeConnection({})->Post(url, {});
+
+    const auto readFile = [](std::FILE* file) {
+        std::string contents;
+        char chunk[256];
+        size_t size = 0;
+        while ((size = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            contents.append(chunk, size);
+        }
+        return contents;
+    };
+
+    ConnectionConfig config;
+    config.maxResponseSize = expected.size() - 1;
+
+    SECTION("A response over the configured limit fails")
+    {
+        auto connection = connectionManager.MakeConnection(config);
+        REQUIRE_THROWS_CODE_MSG(connection->Post(url, {}),
+                                ConnectionUnexpectedError,
+                                "Failure writing output to destination");
+
+        // Streaming is disabled by default
+        REQUIRE_THROWS_CODE(connection->PostStreaming(url), ConnectionUnexpectedError);
+    }
+
+    SECTION("A streamed response over the limit is written to a file")
+    {
+        config.maxSpilledResponseSize = expected.size();
+        auto connection = connectionManager.MakeConnection(config);
+
+        StreamingResponse response;
+        REQUIRE_NOTHROW(response = connection->PostStreaming(url));
+        REQUIRE(response.body.empty());
+        REQUIRE(response.spillFile);
+        REQUIRE(readFile(response.spillFile.get()) == expected);
+
+        // The limit for other requests is unchanged
+        REQUIRE_THROWS_CODE(connection->Post(url, {}), ConnectionUnexpectedError);
+
+        // Child connections keep the limits
+        auto childConnection = connectionManager.MakeConnection(connection->MakeChildConfig());
+        REQUIRE_NOTHROW(response = childConnection->PostStreaming(url));
+        REQUIRE(response.spillFile);
+        REQUIRE(readFile(response.spillFile.get()) == expected);
+    }
+
+    SECTION("A streamed response over the spill limit fails")
+    {
+        config.maxSpilledResponseSize = expected.size() - 1;
+        auto connection = connectionManager.MakeConnection(config);
+        REQUIRE_THROWS_CODE(connection->PostStreaming(url), ConnectionUnexpectedError);
+    }
+
+    SECTION("A streamed response within the limit is kept in memory")
+    {
+        config.maxResponseSize = expected.size();
+        config.maxSpilledResponseSize = expected.size() * 2;
+        auto connection = connectionManager.MakeConnection(config);
+
+        StreamingResponse response;
+        REQUIRE_NOTHROW(response = connection->PostStreaming(url));
+        REQUIRE(response.body == expected);
+        REQUIRE(!response.spillFile);
+    }
+}
+
+TEST("Testing compressed responses are accepted and decompressed")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    test::MockWebServer server;
+    CurlConnectionManager connectionManager(handler);
+    server.RegisterProduct(c_productName, c_version);
+
+    const std::string url =
+        SFSUrlComponents::GetDownloadInfoUrl(server.GetBaseUrl(), c_instanceId, c_namespace, c_productName, c_version);
+    const std::string expected = connectionManager.MakeConnection({})->Post(url, {});
+
+    // From now on the server fails requests that do not accept gzip
+    server.EnableResponseCompression();
+
+    SECTION("The response is decompressed")
+    {
+        auto connection = connectionManager.MakeConnection({});
+        std::string out;
+        REQUIRE_NOTHROW(out = connection->Post(url, {}));
+        REQUIRE(out == expected);
+
+        const std::string versionUrl = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                               c_instanceId,
+                                                                               c_namespace,
+                                                                               c_productName,
+                                                                               c_version);
+        REQUIRE_NOTHROW(out = connection->Get(versionUrl));
+        REQUIRE(json::parse(out)["ContentId"]["Name"] == c_productName);
+    }
+
+    SECTION("The size limit applies to the decompressed response")
+    {
+        ConnectionConfig config;
+        config.maxResponseSize = expected.size() - 1;
+        auto connection = connectionManager.MakeConnection(config);
+        REQUIRE_THROWS_CODE(connection->Post(url, {}), ConnectionUnexpectedError);
+
+        config.maxSpilledResponseSize = expected.size();
+        connection = connectionManager.MakeConnection(config);
+        StreamingResponse response;
+        REQUIRE_NOTHROW(response = connection->PostStreaming(url));
+        REQUIRE(response.spillFile);
+    }
+}
+
 TEST("Testing MS-CV is sent to server")
 {
     test::MockWebServer server;
@@ -388,9 +785,13 @@ TEST("Testing retry behavior")
                                                                     c_productName,
                                                                     c_version);
 
+    // Without jitter, so that the delays are exact
+    ConnectionConfig noJitterConfig;
+    noJitterConfig.jitterRetryDelays = false;
+
     SECTION("Test exponential backoff")
     {
-        auto connection = connectionManager.MakeConnection({});
+        auto connection = connectionManager.MakeConnection(noJitterConfig);
 
         INFO("Sets the retry delay to 50ms to speed up the test");
         ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 50);
@@ -454,7 +855,7 @@ TEST("Testing retry behavior")
 
     SECTION("Test retriable errors with Retry-After headers")
     {
-        auto connection = connectionManager.MakeConnection({});
+        auto connection = connectionManager.MakeConnection(noJitterConfig);
 
         INFO("Sets the retry delay to 200ms to speed up the test");
         ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 200);
@@ -569,4 +970,352 @@ TEST("Testing retry behavior")
             }
         }
     }
+
+    SECTION("Test jittered backoff")
+    {
+        INFO("Sets the retry delay to 50ms to speed up the test");
+        ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 50);
+
+        const int retriableError = 503; // ServerBusy
+        ConnectionConfig config;
+        config.jitterRetryDelays = true;
+        auto connection = connectionManager.MakeConnection(config);
+
+        // Each delay is between 50ms and the 200ms cap of the exponential back-off with 3 retries
+        server.SetForcedHttpErrors(std::queue<HttpCode>({retriableError, retriableError, retriableError}));
+        const auto begin = steady_clock::now();
+        REQUIRE_NOTHROW(connection->Get(url));
+        const auto time = duration_cast<milliseconds>(steady_clock::now() - begin).count();
+        REQUIRE(time >= 150LL);
+        REQUIRE(time < 600LL + 200LL);
+    }
+
+    SECTION("Test retry budget")
+    {
+        INFO("Sets the retry delay to 1ms to speed up the test");
+        ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 1);
+
+        const int retriableError = 503; // ServerBusy
+
+        ConnectionConfig config;
+        config.retryBudget = std::make_shared<RetryBudget>(0.5 /*ratio*/, 2 /*maxTokens*/);
+        auto connection = connectionManager.MakeConnection(config);
+
+        INFO("The budget allows 2 retries, the third one is not made");
+        server.SetForcedHttpErrors(std::queue<HttpCode>({retriableError, retriableError, retriableError}));
+        REQUIRE_THROWS_CODE(connection->Get(url), HttpServiceNotAvailable);
+        REQUIRE(config.retryBudget->GetStatistics().retries == 2);
+        REQUIRE(config.retryBudget->GetStatistics().rejectedRetries == 1);
+
+        INFO("Two more requests earn another retry, which connections sharing the budget can use");
+        REQUIRE_NOTHROW(connection->Get(url));
+        auto otherConnection = connectionManager.MakeConnection(config);
+        server.SetForcedHttpErrors(std::queue<HttpCode>({retriableError}));
+        REQUIRE_NOTHROW(otherConnection->Get(url));
+        REQUIRE(config.retryBudget->GetStatistics().retries == 3);
+    }
+
+    SECTION("Test circuit breaker")
+    {
+        INFO("Sets the retry delay to 1ms to speed up the test");
+        ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 1);
+
+        const int retriableError = 503; // ServerBusy
+
+        ConnectionConfig config;
+        config.circuitBreaker = std::make_shared<CircuitBreaker>(2 /*failureThreshold*/, 200ms /*coolDown*/);
+        auto connection = connectionManager.MakeConnection(config);
+
+        INFO("The breaker trips after the second failed attempt, so the third one is not made");
+        server.SetForcedHttpErrors(std::queue<HttpCode>({retriableError, retriableError}));
+        REQUIRE_THROWS_CODE(connection->Get(url), HttpServiceNotAvailable);
+        REQUIRE(config.circuitBreaker->GetTripCount() == 1);
+        REQUIRE(config.circuitBreaker->GetRejectedCount() == 1);
+
+        INFO("Other connections to the host fail right away");
+        auto otherConnection = connectionManager.MakeConnection(config);
+        REQUIRE_THROWS_CODE(otherConnection->Get(url), HttpServiceNotAvailable);
+        REQUIRE(config.circuitBreaker->GetRejectedCount() == 2);
+
+        INFO("Once the cool-down is over, a successful probe closes the breaker");
+        std::this_thread::sleep_for(300ms);
+        REQUIRE_NOTHROW(otherConnection->Get(url));
+        REQUIRE_NOTHROW(connection->Get(url));
+        REQUIRE(config.circuitBreaker->GetRejectedCount() == 2);
+
+        INFO("Errors of the client itself do not count as failures of the host");
+        ConnectionConfig smallResponseConfig = config;
+        smallResponseConfig.maxResponseSize = 1;
+        auto smallResponseConnection = connectionManager.MakeConnection(smallResponseConfig);
+        REQUIRE_THROWS_CODE(smallResponseConnection->Get(url), ConnectionUnexpectedError);
+        REQUIRE_THROWS_CODE(smallResponseConnection->Get(url), ConnectionUnexpectedError);
+        REQUIRE(config.circuitBreaker->GetTripCount() == 1);
+        REQUIRE_NOTHROW(connection->Get(url));
+    }
+}
+
+TEST("Testing a Retry-After holds back the requests of other connections to the same host")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    MockWebServer server;
+    CurlConnectionManager connectionManager(handler);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string url = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                    c_instanceId,
+                                                                    c_namespace,
+                                                                    c_productName,
+                                                                    c_version);
+
+    const int throttledError = 429; // TooManyRequests
+    std::unordered_map<HttpCode, HeaderMap> headersByCode;
+    headersByCode[throttledError] = {{"Retry-After", "1"}}; // 1s delay
+    server.SetResponseHeaders(headersByCode);
+    server.SetForcedHttpErrors(std::queue<HttpCode>({throttledError}));
+
+    INFO("A first request is throttled without retrying");
+    ConnectionConfig noRetryConfig;
+    noRetryConfig.maxRetries = 0;
+    REQUIRE_THROWS_CODE(connectionManager.MakeConnection(noRetryConfig)->Get(url), HttpTooManyRequests);
+
+    const auto begin = steady_clock::now();
+    SECTION("Requests wait until the host accepts them again")
+    {
+        auto connection = connectionManager.MakeConnection({});
+        REQUIRE_NOTHROW(connection->Get(url));
+        REQUIRE(steady_clock::now() - begin >= 500ms);
+    }
+
+    SECTION("Requests can fail fast instead of waiting")
+    {
+        ConnectionConfig config;
+        config.failFastWhenThrottled = true;
+        auto connection = connectionManager.MakeConnection(config);
+        REQUIRE_THROWS_CODE(connection->Get(url), HttpTooManyRequests);
+        REQUIRE(steady_clock::now() - begin < 500ms);
+    }
+
+    SECTION("Requests fail fast if the host only accepts them after the deadline")
+    {
+        ConnectionConfig config;
+        config.retryDeadline = steady_clock::now() + 100ms;
+        auto connection = connectionManager.MakeConnection(config);
+        REQUIRE_THROWS_CODE(connection->Get(url), HttpTooManyRequests);
+        REQUIRE(steady_clock::now() - begin < 500ms);
+    }
+
+    REQUIRE(server.Stop() == Result::Success);
+}
+
+TEST("Testing retries stop at the deadline and can be cancelled")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        INFO("Skipping. Test overrides not enabled");
+        return;
+    }
+
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    MockWebServer server;
+    CurlConnectionManager connectionManager(handler);
+    CurlMultiConnectionManager multiConnectionManager(handler);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string url = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                    c_instanceId,
+                                                                    c_namespace,
+                                                                    c_productName,
+                                                                    c_version);
+    const int retriableError = 503; // ServerBusy
+
+    auto runTests = [&](ConnectionManager& manager) {
+        SECTION("A retry that starts before the deadline is made")
+        {
+            ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 50);
+
+            ConnectionConfig config;
+            config.retryDeadline = steady_clock::now() + 5s;
+            config.jitterRetryDelays = false;
+            auto connection = manager.MakeConnection(config);
+            server.SetForcedHttpErrors(std::queue<HttpCode>({retriableError, retriableError}));
+
+            const auto begin = steady_clock::now();
+            REQUIRE_NOTHROW(connection->Get(url));
+            REQUIRE(steady_clock::now() - begin >= 150ms);
+        }
+
+        SECTION("A retry that would start after the deadline is not made")
+        {
+            ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 10000);
+
+            ConnectionConfig config;
+            config.retryDeadline = steady_clock::now() + 5s;
+            auto connection = manager.MakeConnection(config);
+            server.SetForcedHttpErrors(std::queue<HttpCode>({retriableError}));
+
+            const auto begin = steady_clock::now();
+            REQUIRE_THROWS_CODE(connection->Get(url), HttpServiceNotAvailable);
+            REQUIRE(steady_clock::now() - begin < 5s);
+        }
+
+        SECTION("Cancelling abandons a retry waiting for its start time")
+        {
+            ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 10000);
+
+            auto connection = manager.MakeConnection({});
+            server.SetForcedHttpErrors(std::queue<HttpCode>({retriableError}));
+
+            // The request is cancelled either while it waits for its retry or, on a slow machine, during its first
+            // attempt, which fails the same way
+            Result::Code code = Result::NotSet;
+            std::thread thread([&]() {
+                try
+                {
+                    connection->Get(url);
+                    code = Result::Success;
+                }
+                catch (const SFSException& e)
+                {
+                    code = e.GetResult().GetCode();
+                }
+            });
+            std::this_thread::sleep_for(200ms);
+
+            const auto begin = steady_clock::now();
+            connection->Cancel();
+            thread.join();
+            REQUIRE(code == Result::ConnectionCancelled);
+            REQUIRE(steady_clock::now() - begin < 5s);
+
+            INFO("Requests made after the connection is cancelled fail right away");
+            REQUIRE_THROWS_CODE(connection->Get(url), ConnectionCancelled);
+        }
+    };
+
+    SECTION("With transfers in the calling thread")
+    {
+        runTests(connectionManager);
+    }
+
+    SECTION("With the background transfer thread")
+    {
+        runTests(multiConnectionManager);
+    }
+}
+
+TEST("Testing retries of asynchronous requests wait without holding a thread")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        INFO("Skipping. Test overrides not enabled");
+        return;
+    }
+
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    MockWebServer server;
+    CurlMultiConnectionManager connectionManager(handler);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string url = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                    c_instanceId,
+                                                                    c_namespace,
+                                                                    c_productName,
+                                                                    c_version);
+
+    ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 500);
+    ConnectionConfig config;
+    config.jitterRetryDelays = false;
+
+    // Every request gets an error and waits 500ms for its retry. All of them are started from this thread, and driven
+    // by the engine thread, so the retries only wait together if none of them holds a thread while it waits.
+    const int requestCount = 16;
+    server.SetForcedHttpErrors(std::queue<HttpCode>(std::deque<HttpCode>(requestCount, 503)));
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::vector<std::future<std::string>> futures;
+    const auto begin = steady_clock::now();
+    for (int i = 0; i < requestCount; ++i)
+    {
+        connections.push_back(connectionManager.MakeConnection(config));
+        futures.push_back(connections.back()->GetAsync(url));
+    }
+
+    for (auto& future : futures)
+    {
+        const json response = json::parse(future.get());
+        REQUIRE(response["ContentId"]["Version"] == c_version);
+    }
+    REQUIRE(steady_clock::now() - begin >= 500ms);
+    REQUIRE(steady_clock::now() - begin < 4s);
+
+    INFO("Errors are delivered through the future");
+    server.SetForcedHttpErrors(std::queue<HttpCode>({404}));
+    auto future = connections[0]->GetAsync(url);
+    REQUIRE_THROWS_CODE(future.get(), HttpNotFound);
+
+    REQUIRE(server.Stop() == Result::Success);
+}
+
+TEST("Testing destroying a connection aborts its asynchronous request")
+{
+    if (!AreTestOverridesAllowed())
+    {
+        INFO("Skipping. Test overrides not enabled");
+        return;
+    }
+
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    MockWebServer server;
+    CurlMultiConnectionManager connectionManager(handler);
+
+    server.RegisterProduct(c_productName, c_version);
+    const std::string url = SFSUrlComponents::GetSpecificVersionUrl(server.GetBaseUrl(),
+                                                                    c_instanceId,
+                                                                    c_namespace,
+                                                                    c_productName,
+                                                                    c_version);
+
+    SECTION("While a retry waits for its start time")
+    {
+        ScopedTestOverride override(TestOverride::BaseRetryDelayMs, 10000);
+        server.SetForcedHttpErrors(std::queue<HttpCode>({503}));
+
+        auto connection = connectionManager.MakeConnection({});
+        auto future = connection->GetAsync(url);
+        std::this_thread::sleep_for(200ms);
+
+        const auto begin = steady_clock::now();
+        connection.reset();
+        REQUIRE(steady_clock::now() - begin < 5s);
+        REQUIRE_THROWS_CODE(future.get(), ConnectionCancelled);
+    }
+
+    SECTION("While a transfer is in flight")
+    {
+        server.SetResponseDelays(std::queue<std::chrono::milliseconds>({3000ms}));
+
+        auto connection = connectionManager.MakeConnection({});
+        auto future = connection->GetAsync(url);
+        std::this_thread::sleep_for(200ms);
+
+        const auto begin = steady_clock::now();
+        connection.reset();
+        REQUIRE(steady_clock::now() - begin < 2s);
+        REQUIRE_THROWS_CODE(future.get(), ConnectionCancelled);
+    }
+
+    INFO("The handle of the destroyed connection is only used by the next one once the engine is done with it");
+    auto connection = connectionManager.MakeConnection({});
+    const json response = json::parse(connection->Get(url));
+    REQUIRE(response["ContentId"]["Version"] == c_version);
+
+    REQUIRE(server.Stop() == Result::Success);
 }
@@ -0,0 +1,552 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "MockHttp2Server.h"
+
+#include "MockWebServer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#include <httplib.h>
+
+#if defined(_MSC_VER) && !defined(ssize_t)
+#include <BaseTsd.h>
+typedef SSIZE_T ssize_t;
+#endif
+#include <nghttp2/nghttp2.h>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace SFS::test;
+using namespace SFS::test::details;
+
+namespace
+{
+#ifdef _WIN32
+using Socket = SOCKET;
+const Socket c_invalidSocket = INVALID_SOCKET;
+const int c_shutdownBoth = SD_BOTH;
+const int c_sendFlags = 0;
+
+void CloseSocket(Socket socket)
+{
+    closesocket(socket);
+}
+#else
+using Socket = int;
+const Socket c_invalidSocket = -1;
+const int c_shutdownBoth = SHUT_RDWR;
+#ifdef MSG_NOSIGNAL
+const int c_sendFlags = MSG_NOSIGNAL;
+#else
+const int c_sendFlags = 0;
+#endif
+
+void CloseSocket(Socket socket)
+{
+    close(socket);
+}
+#endif
+
+bool SendAll(Socket socket, const uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        const auto sent = send(socket, reinterpret_cast<const char*>(data), static_cast<int>(size), c_sendFlags);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+std::string ToLower(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return str;
+}
+
+struct ForwardedResponse
+{
+    int status;
+    httplib::Headers headers;
+    std::string body;
+};
+
+ForwardedResponse Forward(const std::string& backendUrl, const httplib::Request& request)
+{
+    httplib::Client client(backendUrl);
+    const auto result = client.send(request);
+    if (!result)
+    {
+        return {502, {}, {}};
+    }
+    return {result->status, result->headers, result->body};
+}
+
+struct Counters
+{
+    std::atomic<size_t> connections{0};
+    std::atomic<size_t> requests{0};
+    std::atomic<size_t> maxConcurrentStreams{0};
+
+    void OnStreamsOpen(size_t count)
+    {
+        size_t max = maxConcurrentStreams;
+        while (count > max && !maxConcurrentStreams.compare_exchange_weak(max, count))
+        {
+        }
+    }
+};
+
+struct Stream
+{
+    httplib::Request request;
+    std::string responseBody;
+    size_t responseOffset{0};
+};
+
+// Server side of a single h2c connection. Requests are forwarded to the backend once fully received, and the ones
+// received together are forwarded concurrently.
+class Http2Session
+{
+  public:
+    Http2Session(Socket socket, std::string backendUrl, Counters& counters)
+        : m_socket(socket)
+        , m_backendUrl(std::move(backendUrl))
+        , m_counters(counters)
+    {
+        nghttp2_session_callbacks* callbacks = nullptr;
+        if (nghttp2_session_callbacks_new(&callbacks) != 0)
+        {
+            throw std::runtime_error("Failed to create nghttp2 callbacks");
+        }
+        nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, OnBeginHeaders);
+        nghttp2_session_callbacks_set_on_header_callback(callbacks, OnHeader);
+        nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, OnDataChunk);
+        nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, OnFrame);
+        nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, OnStreamClose);
+
+        const int result = nghttp2_session_server_new(&m_session, callbacks, this);
+        nghttp2_session_callbacks_del(callbacks);
+        if (result != 0)
+        {
+            throw std::runtime_error("Failed to create nghttp2 session");
+        }
+    }
+
+    ~Http2Session()
+    {
+        nghttp2_session_del(m_session);
+    }
+
+    Http2Session(const Http2Session&) = delete;
+    Http2Session& operator=(const Http2Session&) = delete;
+
+    // Serves the connection until it is closed
+    void Run()
+    {
+        const nghttp2_settings_entry settings[] = {{NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 100}};
+        if (nghttp2_submit_settings(m_session, NGHTTP2_FLAG_NONE, settings, 1) != 0)
+        {
+            return;
+        }
+
+        uint8_t buffer[16 * 1024];
+        while (Flush() && (nghttp2_session_want_read(m_session) || nghttp2_session_want_write(m_session)))
+        {
+            const auto received = recv(m_socket, reinterpret_cast<char*>(buffer), static_cast<int>(sizeof(buffer)), 0);
+            if (received <= 0 || nghttp2_session_mem_recv(m_session, buffer, static_cast<size_t>(received)) < 0)
+            {
+                return;
+            }
+            RespondToCompletedStreams();
+        }
+    }
+
+  private:
+    bool Flush()
+    {
+        while (true)
+        {
+            const uint8_t* data = nullptr;
+            const auto size = nghttp2_session_mem_send(m_session, &data);
+            if (size < 0)
+            {
+                return false;
+            }
+            if (size == 0)
+            {
+                return true;
+            }
+            if (!SendAll(m_socket, data, static_cast<size_t>(size)))
+            {
+                return false;
+            }
+        }
+    }
+
+    void RespondToCompletedStreams()
+    {
+        std::vector<std::pair<int32_t, std::future<ForwardedResponse>>> responses;
+        for (const int32_t streamId : m_completedStreams)
+        {
+            const auto it = m_streams.find(streamId);
+            if (it != m_streams.end())
+            {
+                responses.emplace_back(
+                    streamId,
+                    std::async(std::launch::async, Forward, std::cref(m_backendUrl), std::cref(it->second.request)));
+            }
+        }
+        m_completedStreams.clear();
+
+        for (auto& [streamId, response] : responses)
+        {
+            SubmitResponse(streamId, response.get());
+        }
+    }
+
+    void SubmitResponse(int32_t streamId, ForwardedResponse&& response)
+    {
+        const auto it = m_streams.find(streamId);
+        if (it == m_streams.end())
+        {
+            return;
+        }
+
+        // HTTP/2 header names are lowercase, and connection-specific headers are not allowed
+        std::vector<std::pair<std::string, std::string>> headers;
+        headers.emplace_back(":status", std::to_string(response.status));
+        for (const auto& [name, value] : response.headers)
+        {
+            std::string lowerName = ToLower(name);
+            if (lowerName != "connection" && lowerName != "keep-alive" && lowerName != "transfer-encoding" &&
+                lowerName != "content-length")
+            {
+                headers.emplace_back(std::move(lowerName), value);
+            }
+        }
+
+        std::vector<nghttp2_nv> nva;
+        for (auto& [name, value] : headers)
+        {
+            nva.push_back({reinterpret_cast<uint8_t*>(name.data()),
+                           reinterpret_cast<uint8_t*>(value.data()),
+                           name.size(),
+                           value.size(),
+                           NGHTTP2_NV_FLAG_NONE});
+        }
+
+        Stream& stream = it->second;
+        stream.responseBody = std::move(response.body);
+
+        nghttp2_data_provider provider;
+        provider.source.ptr = &stream;
+        provider.read_callback = ReadResponseBody;
+        if (nghttp2_submit_response(m_session, streamId, nva.data(), nva.size(), &provider) == 0)
+        {
+            ++m_counters.requests;
+        }
+    }
+
+    Stream* FindStream(int32_t streamId)
+    {
+        const auto it = m_streams.find(streamId);
+        return it != m_streams.end() ? &it->second : nullptr;
+    }
+
+    static int OnBeginHeaders(nghttp2_session*, const nghttp2_frame* frame, void* userData)
+    {
+        if (frame->hd.type == NGHTTP2_HEADERS && frame->headers.cat == NGHTTP2_HCAT_REQUEST)
+        {
+            auto self = static_cast<Http2Session*>(userData);
+            self->m_streams[frame->hd.stream_id];
+            self->m_counters.OnStreamsOpen(self->m_streams.size());
+        }
+        return 0;
+    }
+
+    static int OnHeader(nghttp2_session*,
+                        const nghttp2_frame* frame,
+                        const uint8_t* name,
+                        size_t nameLength,
+                        const uint8_t* value,
+                        size_t valueLength,
+                        uint8_t,
+                        void* userData)
+    {
+        auto stream = static_cast<Http2Session*>(userData)->FindStream(frame->hd.stream_id);
+        if (!stream)
+        {
+            return 0;
+        }
+
+        std::string headerName(reinterpret_cast<const char*>(name), nameLength);
+        std::string headerValue(reinterpret_cast<const char*>(value), valueLength);
+        if (headerName == ":method")
+        {
+            stream->request.method = std::move(headerValue);
+        }
+        else if (headerName == ":path")
+        {
+            stream->request.path = std::move(headerValue);
+        }
+        else if (headerName[0] != ':' && headerName != "content-length")
+        {
+            // The backend client sets the host and the length of the body itself
+            stream->request.headers.emplace(std::move(headerName), std::move(headerValue));
+        }
+        return 0;
+    }
+
+    static int OnDataChunk(nghttp2_session*,
+                           uint8_t,
+                           int32_t streamId,
+                           const uint8_t* data,
+                           size_t length,
+                           void* userData)
+    {
+        if (auto stream = static_cast<Http2Session*>(userData)->FindStream(streamId))
+        {
+            stream->request.body.append(reinterpret_cast<const char*>(data), length);
+        }
+        return 0;
+    }
+
+    static int OnFrame(nghttp2_session*, const nghttp2_frame* frame, void* userData)
+    {
+        auto self = static_cast<Http2Session*>(userData);
+        const bool isRequestFrame = frame->hd.type == NGHTTP2_HEADERS || frame->hd.type == NGHTTP2_DATA;
+        if (isRequestFrame && (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) && self->FindStream(frame->hd.stream_id))
+        {
+            self->m_completedStreams.push_back(frame->hd.stream_id);
+        }
+        return 0;
+    }
+
+    static int OnStreamClose(nghttp2_session*, int32_t streamId, uint32_t, void* userData)
+    {
+        static_cast<Http2Session*>(userData)->m_streams.erase(streamId);
+        return 0;
+    }
+
+    static ssize_t ReadResponseBody(nghttp2_session*,
+                                    int32_t,
+                                    uint8_t* buffer,
+                                    size_t length,
+                                    uint32_t* dataFlags,
+                                    nghttp2_data_source* source,
+                                    void*)
+    {
+        auto stream = static_cast<Stream*>(source->ptr);
+        const size_t size = std::min(length, stream->responseBody.size() - stream->responseOffset);
+        std::memcpy(buffer, stream->responseBody.data() + stream->responseOffset, size);
+        stream->responseOffset += size;
+        if (stream->responseOffset == stream->responseBody.size())
+        {
+            *dataFlags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+        return static_cast<ssize_t>(size);
+    }
+
+    Socket m_socket;
+    std::string m_backendUrl;
+    Counters& m_counters;
+    nghttp2_session* m_session{nullptr};
+
+    // Open streams, by id. Entries are stable, so that response bodies can be read from them while they are sent.
+    std::map<int32_t, Stream> m_streams;
+
+    // Streams whose request was fully received during the last read
+    std::vector<int32_t> m_completedStreams;
+};
+} // namespace
+
+namespace SFS::test::details
+{
+class MockHttp2ServerImpl
+{
+  public:
+    explicit MockHttp2ServerImpl(std::string backendUrl);
+    ~MockHttp2ServerImpl();
+
+    MockHttp2ServerImpl(const MockHttp2ServerImpl&) = delete;
+    MockHttp2ServerImpl& operator=(const MockHttp2ServerImpl&) = delete;
+
+    std::string GetUrl() const;
+
+    const Counters& GetCounters() const;
+
+  private:
+    void AcceptConnections();
+
+    std::string m_backendUrl;
+    Socket m_listenSocket{c_invalidSocket};
+    int m_port{-1};
+
+    Counters m_counters;
+
+    std::atomic<bool> m_stopping{false};
+    std::thread m_acceptThread;
+
+    std::mutex m_sessionsMutex;
+    std::vector<Socket> m_sessionSockets;
+    std::vector<std::thread> m_sessionThreads;
+};
+} // namespace SFS::test::details
+
+MockHttp2Server::MockHttp2Server(const MockWebServer& backend)
+{
+    m_impl = std::make_unique<MockHttp2ServerImpl>(backend.GetBaseUrl());
+}
+
+MockHttp2Server::~MockHttp2Server() = default;
+
+std::string MockHttp2Server::GetBaseUrl() const
+{
+    return m_impl->GetUrl();
+}
+
+size_t MockHttp2Server::GetConnectionCount() const
+{
+    return m_impl->GetCounters().connections;
+}
+
+size_t MockHttp2Server::GetRequestCount() const
+{
+    return m_impl->GetCounters().requests;
+}
+
+size_t MockHttp2Server::GetMaxConcurrentStreams() const
+{
+    return m_impl->GetCounters().maxConcurrentStreams;
+}
+
+MockHttp2ServerImpl::MockHttp2ServerImpl(std::string backendUrl) : m_backendUrl(std::move(backendUrl))
+{
+    m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (m_listenSocket == c_invalidSocket)
+    {
+        throw std::runtime_error("Failed to create the listening socket");
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t addressLength = sizeof(address);
+    if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(m_listenSocket, SOMAXCONN) != 0 ||
+        getsockname(m_listenSocket, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0)
+    {
+        CloseSocket(m_listenSocket);
+        throw std::runtime_error("Failed to listen on a local port");
+    }
+    m_port = ntohs(address.sin_port);
+
+    m_acceptThread = std::thread([this]() { AcceptConnections(); });
+}
+
+MockHttp2ServerImpl::~MockHttp2ServerImpl()
+{
+    // Connecting to the listening socket wakes up the accept thread, which then sees that the server is stopping
+    m_stopping = true;
+    const Socket wakeUpSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (wakeUpSocket != c_invalidSocket)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(m_port));
+        connect(wakeUpSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        CloseSocket(wakeUpSocket);
+    }
+    m_acceptThread.join();
+    CloseSocket(m_listenSocket);
+
+    // Shutting the connections down makes their sessions return
+    std::lock_guard guard(m_sessionsMutex);
+    for (const Socket socket : m_sessionSockets)
+    {
+        shutdown(socket, c_shutdownBoth);
+    }
+    for (auto& thread : m_sessionThreads)
+    {
+        thread.join();
+    }
+    for (const Socket socket : m_sessionSockets)
+    {
+        CloseSocket(socket);
+    }
+}
+
+std::string MockHttp2ServerImpl::GetUrl() const
+{
+    return "http://127.0.0.1:" + std::to_string(m_port);
+}
+
+const Counters& MockHttp2ServerImpl::GetCounters() const
+{
+    return m_counters;
+}
+
+void MockHttp2ServerImpl::AcceptConnections()
+{
+    while (true)
+    {
+        const Socket socket = accept(m_listenSocket, nullptr, nullptr);
+        if (m_stopping)
+        {
+            if (socket != c_invalidSocket)
+            {
+                CloseSocket(socket);
+            }
+            return;
+        }
+        if (socket == c_invalidSocket)
+        {
+            continue;
+        }
+
+        ++m_counters.connections;
+
+        std::lock_guard guard(m_sessionsMutex);
+        m_sessionSockets.push_back(socket);
+        m_sessionThreads.emplace_back([this, socket]() {
+            try
+            {
+                Http2Session session(socket, m_backendUrl, m_counters);
+                session.Run();
+            }
+            catch (const std::exception&)
+            {
+                shutdown(socket, c_shutdownBoth);
+            }
+        });
+    }
+}
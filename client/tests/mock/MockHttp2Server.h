@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace SFS::test
+{
+namespace details
+{
+class MockHttp2ServerImpl;
+}
+
+class MockWebServer;
+
+/**
+ * @brief Local HTTP/2 stand-in for the service, without TLS (h2c), which clients have to reach with prior knowledge
+ * @details Each request received is forwarded over HTTP/1.1 to the given MockWebServer, and its response is sent back
+ * on the same stream, so this server answers like the MockWebServer does. It counts the connections it accepted and
+ * the requests it served, so that tests can check that concurrent requests were multiplexed.
+ */
+class MockHttp2Server
+{
+  public:
+    /// @param backend Server the requests are forwarded to. It must outlive this object
+    explicit MockHttp2Server(const MockWebServer& backend);
+    ~MockHttp2Server();
+
+    MockHttp2Server(const MockHttp2Server&) = delete;
+    MockHttp2Server& operator=(const MockHttp2Server&) = delete;
+
+    std::string GetBaseUrl() const;
+
+    /// @brief Number of TCP connections accepted so far
+    size_t GetConnectionCount() const;
+
+    /// @brief Number of requests served so far, over all connections
+    size_t GetRequestCount() const;
+
+    /// @brief Largest number of streams that were open at the same time on a single connection
+    size_t GetMaxConcurrentStreams() const;
+
+  private:
+    std::unique_ptr<details::MockHttp2ServerImpl> m_impl;
+};
+} // namespace SFS::test
@@ -15,6 +15,7 @@
 
 #include <httplib.h>
 #include <nlohmann/json.hpp>
+#include <zlib.h>
 
 #include <chrono>
 #include <mutex>
@@ -251,6 +252,44 @@ void CheckApiVersion(const httplib::Request& req, std::string_view apiVersion)
         throw StatusCodeException(httplib::StatusCode::NotFound_404);
     }
 }
+
+std::string GzipCompress(const std::string& data)
+{
+    z_stream stream{};
+
+    // Adding 16 to the window bits writes a gzip header and trailer instead of a zlib one
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw std::runtime_error("Failed to initialize gzip compression");
+    }
+
+    std::string compressed(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+
+    const int result = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END)
+    {
+        throw std::runtime_error("Failed to compress with gzip");
+    }
+    return compressed;
+}
+
+void CompressResponse(const httplib::Request& req, httplib::Response& res)
+{
+    // Encodings are listed as in "deflate, gzip, br"
+    if (req.get_header_value("Accept-Encoding").find("gzip") == std::string::npos)
+    {
+        throw StatusCodeException(httplib::StatusCode::NotAcceptable_406);
+    }
+
+    res.body = GzipCompress(res.body);
+    res.set_header("Content-Encoding", "gzip");
+}
 } // namespace
 
 namespace SFS::test::details
@@ -273,7 +312,9 @@ class MockWebServerImpl
     void RegisterAppProduct(std::string&& name, std::string&& version, std::vector<MockPrerequisite>&& prerequisites);
     void RegisterExpectedRequestHeader(std::string&& header, std::string&& value);
     void SetForcedHttpErrors(std::queue<HttpCode> forcedErrors);
+    void SetResponseDelays(std::queue<std::chrono::milliseconds> delays);
     void SetResponseHeaders(std::unordered_map<HttpCode, HeaderMap> headersByCode);
+    void EnableResponseCompression();
 
   private:
     void ConfigureServerSettings();
@@ -309,7 +350,12 @@ class MockWebServerImpl
 
     std::unordered_map<std::string, std::string> m_expectedRequestHeaders;
     std::queue<HttpCode> m_forcedHttpErrors;
+
+    // Delays of the next responses. Requests are served concurrently, so they take their delay under the mutex.
+    std::queue<std::chrono::milliseconds> m_responseDelays;
+    std::mutex m_responseDelaysMutex;
     std::unordered_map<HttpCode, HeaderMap> m_headersByCode;
+    bool m_compressResponses{false};
 
     std::vector<BufferedLogData> m_bufferedLog;
     std::mutex m_logMutex;
@@ -364,11 +410,21 @@ void MockWebServer::SetForcedHttpErrors(std::queue<HttpCode> forcedErrors)
     m_impl->SetForcedHttpErrors(std::move(forcedErrors));
 }
 
+void MockWebServer::SetResponseDelays(std::queue<std::chrono::milliseconds> delays)
+{
+    m_impl->SetResponseDelays(std::move(delays));
+}
+
 void MockWebServer::SetResponseHeaders(std::unordered_map<HttpCode, HeaderMap> headersByCode)
 {
     m_impl->SetResponseHeaders(std::move(headersByCode));
 }
 
+void MockWebServer::EnableResponseCompression()
+{
+    m_impl->EnableResponseCompression();
+}
+
 void MockWebServerImpl::Start()
 {
     ConfigureServerSettings();
@@ -699,6 +755,21 @@ void MockWebServerImpl::RunHttpCallback(const httplib::Request& req,
                                         const std::string& apiVersion,
                                         const std::function<void(const httplib::Request, httplib::Response&)>& callback)
 {
+    std::optional<std::chrono::milliseconds> delay;
+    {
+        std::lock_guard guard(m_responseDelaysMutex);
+        if (!m_responseDelays.empty())
+        {
+            delay = m_responseDelays.front();
+            m_responseDelays.pop();
+        }
+    }
+    if (delay)
+    {
+        BUFFER_LOG("Delaying response by " + std::to_string(delay->count()) + "ms");
+        std::this_thread::sleep_for(*delay);
+    }
+
     if (m_forcedHttpErrors.size() > 0)
     {
         res.status = m_forcedHttpErrors.front();
@@ -714,6 +785,10 @@ void MockWebServerImpl::RunHttpCallback(const httplib::Request& req,
             CheckApiVersion(req, apiVersion);
             CheckRequestHeaders(req);
             callback(req, res);
+            if (m_compressResponses)
+            {
+                CompressResponse(req, res);
+            }
             res.status = httplib::StatusCode::OK_200;
         }
         catch (const StatusCodeException& ex)
@@ -829,7 +904,18 @@ void MockWebServerImpl::SetForcedHttpErrors(std::queue<int> forcedErrors)
     m_forcedHttpErrors = std::move(forcedErrors);
 }
 
+void MockWebServerImpl::SetResponseDelays(std::queue<std::chrono::milliseconds> delays)
+{
+    std::lock_guard guard(m_responseDelaysMutex);
+    m_responseDelays = std::move(delays);
+}
+
 void MockWebServerImpl::SetResponseHeaders(std::unordered_map<HttpCode, HeaderMap> headersByCode)
 {
     m_headersByCode = std::move(headersByCode);
 }
+
+void MockWebServerImpl::EnableResponseCompression()
+{
+    m_compressResponses = true;
+}
@@ -5,6 +5,7 @@
 
 #include "Result.h"
 
+#include <chrono>
 #include <memory>
 #include <queue>
 #include <string>
@@ -59,9 +60,21 @@ class MockWebServer
      */
     void SetForcedHttpErrors(std::queue<HttpCode> forcedErrors);
 
+    /**
+     * @brief Registers a sequence of delays that the server waits for before answering the next requests, in the order
+     * in which they are passed
+     */
+    void SetResponseDelays(std::queue<std::chrono::milliseconds> delays);
+
     /// @brief Registers a set of headers that will be sent depending on the HTTP code
     void SetResponseHeaders(std::unordered_map<HttpCode, HeaderMap> headersByCode);
 
+    /**
+     * @brief Makes the server compress the bodies of successful responses with gzip
+     * @details Requests must then accept gzip through the Accept-Encoding header, or they fail with 406 Not Acceptable.
+     */
+    void EnableResponseCompression();
+
   private:
     std::unique_ptr<details::MockWebServerImpl> m_impl;
 };
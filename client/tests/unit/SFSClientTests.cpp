@@ -199,6 +199,41 @@ TEST("Testing SFSClient::Make()")
         REQUIRE(sfsClient == nullptr);
     }
 
+    SECTION("retryBudgetRatio cannot be negative")
+    {
+        ClientConfig config;
+        config.accountId = accountId;
+        config.retryBudgetRatio = -0.1;
+        REQUIRE(SFSClient::Make(config, sfsClient) == Result::InvalidArg);
+        REQUIRE(sfsClient == nullptr);
+
+        config.retryBudgetRatio = std::nullopt;
+        REQUIRE(SFSClient::Make(config, sfsClient) == Result::Success);
+        REQUIRE(sfsClient != nullptr);
+    }
+
+    SECTION("latestVersionHedgePercentile must be in (0, 1]")
+    {
+        ClientConfig config;
+        config.accountId = accountId;
+        config.latestVersionHedgePercentile = 0.0;
+        REQUIRE(SFSClient::Make(config, sfsClient) == Result::InvalidArg);
+        REQUIRE(sfsClient == nullptr);
+
+        config.latestVersionHedgePercentile = 1.5;
+        REQUIRE(SFSClient::Make(config, sfsClient) == Result::InvalidArg);
+        REQUIRE(sfsClient == nullptr);
+
+        config.latestVersionHedgePercentile = 0.95;
+        config.latestVersionHedgeMaxRate = -0.1;
+        REQUIRE(SFSClient::Make(config, sfsClient) == Result::InvalidArg);
+        REQUIRE(sfsClient == nullptr);
+
+        config.latestVersionHedgeMaxRate = 0.05;
+        REQUIRE(SFSClient::Make(config, sfsClient) == Result::Success);
+        REQUIRE(sfsClient != nullptr);
+    }
+
 #ifdef __GNUG__
 // For "-Wmissing-field-initializers"
 #pragma GCC diagnostic pop
@@ -235,12 +270,12 @@ TEST("Testing SFSClient::GetLatestDownloadInfo()")
         REQUIRE(contents.empty());
     }
 
-    SECTION("Accepting multiple products is not implemented yet")
+    SECTION("Does not allow an empty product among multiple products")
     {
-        params.productRequests = {{"p1", {}}, {"p2", {}}};
+        params.productRequests = {{"p1", {}}, {"", {}}};
         auto result = sfsClient->GetLatestDownloadInfo(params, contents);
-        REQUIRE(result.GetCode() == Result::NotImpl);
-        REQUIRE(result.GetMsg() == "There cannot be more than 1 productRequest at the moment");
+        REQUIRE(result.GetCode() == Result::InvalidArg);
+        REQUIRE(result.GetMsg() == "product cannot be empty");
         REQUIRE(contents.empty());
     }
 
@@ -261,6 +296,100 @@ TEST("Testing SFSClient::GetLatestDownloadInfo()")
     }
 }
 
+TEST("Testing SFSClient::GetLatestDownloadInfoAsync()")
+{
+    auto sfsClient = GetSFSClient();
+    RequestParams params;
+
+    SECTION("Errors are delivered through the future")
+    {
+        std::future<AsyncResult<std::vector<Content>>> future;
+        REQUIRE(sfsClient->GetLatestDownloadInfoAsync(params, future) == Result::Success);
+        REQUIRE(future.valid());
+
+        auto result = future.get();
+        REQUIRE(result.result.GetCode() == Result::InvalidArg);
+        REQUIRE(result.result.GetMsg() == "productRequests cannot be empty");
+        REQUIRE(result.value.empty());
+    }
+
+    SECTION("Many calls can be pending at once")
+    {
+        params.productRequests = {{"", {}}};
+        std::vector<std::future<AsyncResult<std::vector<Content>>>> futures(20);
+        for (auto& future : futures)
+        {
+            REQUIRE(sfsClient->GetLatestDownloadInfoAsync(params, future) == Result::Success);
+        }
+
+        for (auto& future : futures)
+        {
+            auto result = future.get();
+            REQUIRE(result.result.GetCode() == Result::InvalidArg);
+            REQUIRE(result.result.GetMsg() == "product cannot be empty");
+        }
+    }
+
+    SECTION("Request parameters are copied")
+    {
+        std::future<AsyncResult<std::vector<Content>>> future;
+        {
+            RequestParams tmpParams;
+            tmpParams.productRequests = {{"p1", {}}};
+            tmpParams.baseCV = "cv";
+            REQUIRE(sfsClient->GetLatestDownloadInfoAsync(tmpParams, future) == Result::Success);
+        }
+
+        auto result = future.get();
+        REQUIRE(result.result.GetCode() == Result::InvalidArg);
+        REQUIRE(result.result.GetMsg().find("baseCV is not a valid correlation vector:") == 0);
+    }
+}
+
+TEST("Testing SFSClient::GetLatestAppDownloadInfoAsync()")
+{
+    auto sfsClient = GetSFSClient("testInstanceId");
+    RequestParams params;
+    params.productRequests = {{"a", {}}};
+
+    std::future<AsyncResult<std::vector<AppContent>>> future;
+    REQUIRE(sfsClient->GetLatestAppDownloadInfoAsync(params, future) == Result::Success);
+
+    auto result = future.get();
+    REQUIRE(result.result.GetCode() == Result::Unexpected);
+    REQUIRE(result.result.GetMsg() == "At this moment only the \"storeapps\" instanceId can send app requests");
+    REQUIRE(result.value.empty());
+}
+
+TEST("Testing SFSClient::GetStatistics()")
+{
+    // Caches are disabled by default, so nothing is counted
+    auto sfsClient = GetSFSClient();
+    const auto statistics = sfsClient->GetStatistics();
+    REQUIRE(statistics.latestVersionCache.hits == 0);
+    REQUIRE(statistics.latestVersionCache.misses == 0);
+    REQUIRE(statistics.latestVersionCache.entries == 0);
+
+    // The retry budget is disabled by default
+    REQUIRE(statistics.retryBudget.availableRetries == 0);
+    REQUIRE(statistics.retryBudget.retries == 0);
+    REQUIRE(statistics.retryBudget.rejectedRetries == 0);
+
+    SECTION("An enabled retry budget starts full")
+    {
+        ClientConfig config;
+        config.accountId = "testAccountId";
+        config.retryBudgetRatio = 0.1;
+        std::unique_ptr<SFSClient> budgetClient;
+        REQUIRE(SFSClient::Make(config, budgetClient) == Result::Success);
+
+        const auto budgetStatistics = budgetClient->GetStatistics();
+        REQUIRE(budgetStatistics.retryBudget.availableRetries == 10);
+        REQUIRE(budgetStatistics.retryBudget.retries == 0);
+        REQUIRE(budgetStatistics.retryBudget.rejectedRetries == 0);
+    }
+}
+
 TEST("Testing SFSClient::GetAppLatestDownloadInfo()")
 {
     SECTION("With storeapps instance")
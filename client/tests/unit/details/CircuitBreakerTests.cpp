@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "connection/CircuitBreaker.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+
+#define TEST(...) TEST_CASE("[CircuitBreakerTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace std::chrono_literals;
+
+namespace
+{
+void FailTimes(CircuitBreaker& breaker, const std::string& url, int times)
+{
+    for (int i = 0; i < times; ++i)
+    {
+        REQUIRE(breaker.AllowRequest(url));
+        breaker.OnFailure(url, false /*isProbe*/);
+    }
+}
+} // namespace
+
+TEST("Testing CircuitBreaker trips after consecutive failures")
+{
+    CircuitBreaker breaker(3 /*failureThreshold*/, 1h /*coolDown*/);
+    const std::string url = "https://host.com/api/v2/contents";
+
+    SECTION("Failures below the threshold keep it closed")
+    {
+        FailTimes(breaker, url, 2);
+        REQUIRE(breaker.AllowRequest(url));
+        REQUIRE(breaker.GetTripCount() == 0);
+    }
+
+    SECTION("A success resets the count of failures")
+    {
+        FailTimes(breaker, url, 2);
+        REQUIRE(breaker.AllowRequest(url));
+        breaker.OnSuccess(url, false /*isProbe*/);
+        FailTimes(breaker, url, 2);
+        REQUIRE(breaker.AllowRequest(url));
+    }
+
+    SECTION("Reaching the threshold rejects the requests to the host")
+    {
+        FailTimes(breaker, url, 3);
+        REQUIRE(breaker.GetTripCount() == 1);
+        REQUIRE_FALSE(breaker.AllowRequest(url));
+        REQUIRE_FALSE(breaker.AllowRequest("https://host.com/other"));
+        REQUIRE(breaker.GetRejectedCount() == 2);
+
+        INFO("Other hosts are not affected");
+        REQUIRE(breaker.AllowRequest("https://other.com/api"));
+    }
+}
+
+TEST("Testing CircuitBreaker probes the host once the cool-down is over")
+{
+    CircuitBreaker breaker(1 /*failureThreshold*/, 50ms /*coolDown*/);
+    const std::string url = "https://host.com/api";
+
+    FailTimes(breaker, url, 1);
+    REQUIRE_FALSE(breaker.AllowRequest(url));
+    std::this_thread::sleep_for(100ms);
+
+    INFO("A single probe is let through");
+    bool isProbe = false;
+    REQUIRE(breaker.AllowRequest(url, &isProbe));
+    REQUIRE(isProbe);
+    REQUIRE_FALSE(breaker.AllowRequest(url));
+
+    SECTION("A successful probe closes the breaker")
+    {
+        breaker.OnSuccess(url, true /*isProbe*/);
+        REQUIRE(breaker.AllowRequest(url));
+        REQUIRE(breaker.AllowRequest(url));
+    }
+
+    SECTION("A failed probe opens the breaker for another cool-down")
+    {
+        breaker.OnFailure(url, true /*isProbe*/);
+        REQUIRE(breaker.GetTripCount() == 2);
+        REQUIRE_FALSE(breaker.AllowRequest(url));
+        std::this_thread::sleep_for(100ms);
+        REQUIRE(breaker.AllowRequest(url));
+    }
+
+    SECTION("An abandoned probe lets the next request probe the host")
+    {
+        breaker.OnAbandoned(url, true /*isProbe*/);
+        REQUIRE(breaker.AllowRequest(url));
+        REQUIRE_FALSE(breaker.AllowRequest(url));
+    }
+
+    SECTION("Attempts let through before the breaker opened do not stand for the probe")
+    {
+        breaker.OnSuccess(url, false /*isProbe*/);
+        breaker.OnFailure(url, false /*isProbe*/);
+        breaker.OnAbandoned(url, false /*isProbe*/);
+        REQUIRE_FALSE(breaker.AllowRequest(url));
+        REQUIRE(breaker.GetTripCount() == 1);
+    }
+}
+
+TEST("Testing CircuitBreaker stays open when a slow attempt succeeds late")
+{
+    CircuitBreaker breaker(1 /*failureThreshold*/, 1h /*coolDown*/);
+    const std::string url = "https://host.com/api";
+
+    // The slow attempt is let through while the breaker is closed, and only completes once another one tripped it
+    bool isProbe = true;
+    REQUIRE(breaker.AllowRequest(url, &isProbe));
+    REQUIRE_FALSE(isProbe);
+    FailTimes(breaker, url, 1);
+    REQUIRE(breaker.GetTripCount() == 1);
+
+    breaker.OnSuccess(url, isProbe);
+    REQUIRE_FALSE(breaker.AllowRequest(url));
+}
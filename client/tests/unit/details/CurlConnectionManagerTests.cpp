@@ -5,6 +5,7 @@
 #include "connection/Connection.h"
 #include "connection/CurlConnection.h"
 #include "connection/CurlConnectionManager.h"
+#include "connection/CurlMultiConnectionManager.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <curl/curl.h>
@@ -46,3 +47,20 @@ TEST("Testing CurlConnectionManager()")
     auto Connection3 = curlConnectionManager3.MakeConnection({});
     auto Connection4 = curlConnectionManager3.MakeConnection({});
 }
+
+TEST("Testing CurlMultiConnectionManager()")
+{
+    ReportingHandler handler;
+    CurlMultiConnectionManager curlMultiConnectionManager(handler);
+
+    // The multi manager still hands out CurlConnection objects, only the transfers are driven differently
+    std::unique_ptr<Connection> connection = curlMultiConnectionManager.MakeConnection({});
+    REQUIRE(connection != nullptr);
+    REQUIRE(dynamic_cast<CurlConnection*>(connection.get()) != nullptr);
+
+    // It can coexist with other managers, each running its own engine
+    CurlMultiConnectionManager curlMultiConnectionManager2(handler);
+    CurlConnectionManager curlConnectionManager(handler);
+    auto connection2 = curlMultiConnectionManager2.MakeConnection({});
+    auto connection3 = curlConnectionManager.MakeConnection({});
+}
@@ -6,6 +6,7 @@
 #include "ReportingHandler.h"
 #include "Result.h"
 #include "connection/CurlConnection.h"
+#include "connection/CurlHeaderList.h"
 #include "connection/mock/MockConnection.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -31,9 +32,18 @@ class MockCurlConnection : public CurlConnection
     {
     }
 
+    // Headers of the last request, apart from the correlation vector which CurlPerform() adds
+    std::vector<std::string> lastHeaders;
+
   protected:
-    std::string CurlPerform(const std::string&, CurlHeaderList&) override
+    std::string CurlPerform(const std::string&, CurlHeaderList& headers) override
     {
+        lastHeaders.clear();
+        for (auto node = headers.Get(); node; node = node->next)
+        {
+            lastHeaders.emplace_back(node->data);
+        }
+
         if (m_responseCode == Result::Success)
         {
             return m_response;
@@ -86,6 +96,24 @@ TEST("Testing CurlConnection()")
     }
 }
 
+TEST("Testing CurlConnection request headers")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+    Result::Code responseCode = Result::Success;
+    std::string response;
+    MockCurlConnection connection(handler, responseCode, response);
+
+    connection.Post("url", "{}");
+    REQUIRE(connection.lastHeaders == std::vector<std::string>{"Content-Type: application/json"});
+
+    connection.Get("url");
+    REQUIRE(connection.lastHeaders.empty());
+
+    static_cast<Connection&>(connection).Post("url");
+    REQUIRE(connection.lastHeaders == std::vector<std::string>{"Content-Type: application/json"});
+}
+
 TEST("Testing CurlConnection constructor passing a cv")
 {
     ReportingHandler handler;
@@ -0,0 +1,141 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "../../util/TestHelper.h"
+#include "ReportingHandler.h"
+#include "connection/CurlConnection.h"
+#include "connection/CurlConnectionManager.h"
+#include "connection/CurlHandlePool.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#define TEST(...) TEST_CASE("[CurlHandlePoolTests] " __VA_ARGS__)
+
+using namespace SFS;
+using namespace SFS::details;
+using namespace SFS::test;
+using namespace std::chrono_literals;
+
+namespace
+{
+class CurlConnectionWithHandle : public CurlConnection
+{
+  public:
+    CurlConnectionWithHandle(const ReportingHandler& handler, CurlHandlePool& pool) : CurlConnection({}, handler, &pool)
+    {
+    }
+
+    CURL* GetHandle() const
+    {
+        return m_handle;
+    }
+};
+} // namespace
+
+TEST("Testing CurlHandlePool reuses released handles")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    // Makes sure curl is initialized while the pool is in use
+    CurlConnectionManager connectionManager(handler);
+    CurlHandlePool pool(handler, 2 /*maxIdleHandles*/, 60s);
+
+    CURL* handle = pool.Acquire();
+    REQUIRE(handle != nullptr);
+    REQUIRE(pool.GetIdleCount() == 0);
+
+    pool.Release(handle);
+    REQUIRE(pool.GetIdleCount() == 1);
+
+    SECTION("The most recently released handle is handed out first")
+    {
+        CURL* handle2 = pool.Acquire();
+        REQUIRE(handle2 == handle);
+        REQUIRE(pool.GetIdleCount() == 0);
+
+        CURL* handle3 = pool.Acquire();
+        REQUIRE(handle3 != nullptr);
+        REQUIRE(handle3 != handle2);
+
+        pool.Release(handle3);
+        pool.Release(handle2);
+        REQUIRE(pool.GetIdleCount() == 2);
+        REQUIRE(pool.Acquire() == handle2);
+        REQUIRE(pool.Acquire() == handle3);
+
+        pool.Release(handle2);
+        pool.Release(handle3);
+    }
+
+    SECTION("Handles over the limit are not kept")
+    {
+        CURL* handle1 = pool.Acquire();
+        CURL* handle2 = pool.Acquire();
+        CURL* handle3 = pool.Acquire();
+
+        pool.Release(handle1);
+        pool.Release(handle2);
+        pool.Release(handle3);
+        REQUIRE(pool.GetIdleCount() == 2);
+    }
+
+    SECTION("Releasing a null handle is a no-op")
+    {
+        pool.Release(nullptr);
+        REQUIRE(pool.GetIdleCount() == 1);
+    }
+}
+
+TEST("Testing CurlHandlePool with pooling disabled")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+    CurlConnectionManager connectionManager(handler);
+
+    SECTION("maxIdleHandles is 0")
+    {
+        CurlHandlePool pool(handler, 0 /*maxIdleHandles*/, 60s);
+        pool.Release(pool.Acquire());
+        REQUIRE(pool.GetIdleCount() == 0);
+    }
+
+    SECTION("Idle handles expire")
+    {
+        CurlHandlePool pool(handler, 2 /*maxIdleHandles*/, 0s);
+        pool.Release(pool.Acquire());
+
+        // The handle is only evicted on the next access to the pool
+        CURL* handle = pool.Acquire();
+        REQUIRE(handle != nullptr);
+        REQUIRE(pool.GetIdleCount() == 0);
+        pool.Release(handle);
+    }
+}
+
+TEST("Testing CurlConnection returns its handle to the pool")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+    CurlConnectionManager connectionManager(handler);
+    CurlHandlePool pool(handler, 1 /*maxIdleHandles*/, 60s);
+
+    CURL* firstHandle = nullptr;
+    {
+        CurlConnectionWithHandle connection(handler, pool);
+        firstHandle = connection.GetHandle();
+        REQUIRE(firstHandle != nullptr);
+        REQUIRE(pool.GetIdleCount() == 0);
+    }
+    REQUIRE(pool.GetIdleCount() == 1);
+
+    CurlConnectionWithHandle connection(handler, pool);
+    REQUIRE(connection.GetHandle() == firstHandle);
+    REQUIRE(pool.GetIdleCount() == 0);
+
+    {
+        INFO("A concurrent connection gets a handle of its own");
+        CurlConnectionWithHandle connection2(handler, pool);
+        REQUIRE(connection2.GetHandle() != firstHandle);
+    }
+}
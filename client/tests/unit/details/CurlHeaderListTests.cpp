@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "connection/CurlHeaderList.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#define TEST(...) TEST_CASE("[CurlHeaderListTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+
+namespace
+{
+std::vector<std::string> ToVector(curl_slist* list)
+{
+    std::vector<std::string> lines;
+    for (auto node = list; node; node = node->next)
+    {
+        lines.emplace_back(node->data);
+    }
+    return lines;
+}
+} // namespace
+
+TEST("Testing CurlHeaderList")
+{
+    CurlHeaderList headers;
+    REQUIRE(headers.Get() == nullptr);
+    REQUIRE(headers.Size() == 0);
+
+    headers.Add(HttpHeader::ContentType, "application/json");
+    headers.Add(HttpHeader::RetryAfter, "10");
+    REQUIRE(headers.Size() == 2);
+    REQUIRE(ToVector(headers.Get()) == std::vector<std::string>{"Content-Type: application/json", "Retry-After: 10"});
+
+    SECTION("Clearing the list reuses its memory")
+    {
+        const auto* firstLine = headers.Get()->data;
+        headers.Clear();
+        REQUIRE(headers.Get() == nullptr);
+
+        headers.Add(HttpHeader::RetryAfter, "1");
+        REQUIRE(ToVector(headers.Get()) == std::vector<std::string>{"Retry-After: 1"});
+        REQUIRE(headers.Get()->data == firstLine);
+    }
+
+    SECTION("Adding to the list after getting it")
+    {
+        headers.Get();
+        for (int i = 0; i < 100; ++i)
+        {
+            headers.Add(HttpHeader::RetryAfter, std::to_string(i));
+        }
+        const auto lines = ToVector(headers.Get());
+        REQUIRE(lines.size() == 102);
+        REQUIRE(lines.back() == "Retry-After: 99");
+    }
+}
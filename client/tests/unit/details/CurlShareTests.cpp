@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "../../util/TestHelper.h"
+#include "ReportingHandler.h"
+#include "connection/CurlConnectionManager.h"
+#include "connection/CurlHandlePool.h"
+#include "connection/CurlShare.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <curl/curl.h>
+
+#include <thread>
+#include <vector>
+
+#define TEST(...) TEST_CASE("[CurlShareTests] " __VA_ARGS__)
+
+using namespace SFS;
+using namespace SFS::details;
+using namespace SFS::test;
+using namespace std::chrono_literals;
+
+TEST("Testing CurlShare()")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    // Makes sure curl is initialized while the share is in use
+    CurlConnectionManager connectionManager(handler);
+
+    CurlShare share(handler);
+    REQUIRE(share.GetHandle() != nullptr);
+
+    SECTION("Handles can be attached and detached")
+    {
+        CURL* handle = curl_easy_init();
+        REQUIRE(handle != nullptr);
+        REQUIRE(curl_easy_setopt(handle, CURLOPT_SHARE, share.GetHandle()) == CURLE_OK);
+        REQUIRE(curl_easy_setopt(handle, CURLOPT_SHARE, nullptr) == CURLE_OK);
+        curl_easy_cleanup(handle);
+    }
+
+    SECTION("Handles from a pool are attached to the share")
+    {
+        CurlHandlePool pool(handler, 2 /*maxIdleHandles*/, 60s, &share);
+
+        // Attached handles keep the share in use, so it can't be cleaned up
+        CURL* handle = pool.Acquire();
+        REQUIRE(curl_share_cleanup(share.GetHandle()) == CURLSHE_IN_USE);
+
+        pool.Release(handle);
+    }
+
+    SECTION("Handles can be attached concurrently")
+    {
+        CurlHandlePool pool(handler, 4 /*maxIdleHandles*/, 60s, &share);
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; ++i)
+        {
+            threads.emplace_back([&pool]() {
+                for (int j = 0; j < 10; ++j)
+                {
+                    pool.Release(pool.Acquire());
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        REQUIRE(pool.GetIdleCount() <= 4);
+    }
+}
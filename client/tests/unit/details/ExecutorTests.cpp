@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "Executor.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#define TEST(...) TEST_CASE("[ExecutorTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace std::chrono_literals;
+
+TEST("Testing Executor::Submit() returns the task's value")
+{
+    Executor executor(2);
+
+    auto future = executor.Submit([]() { return 42; });
+    REQUIRE(future.get() == 42);
+
+    SECTION("Exceptions are delivered through the future")
+    {
+        auto failing = executor.Submit([]() -> int { throw std::runtime_error("error"); });
+        REQUIRE_THROWS_AS(failing.get(), std::runtime_error);
+
+        // The worker survives the exception
+        REQUIRE(executor.Submit([]() { return 1; }).get() == 1);
+    }
+}
+
+TEST("Testing Executor does not exceed its maximum number of threads")
+{
+    const unsigned maxThreads = 3;
+    Executor executor(maxThreads);
+
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 20; ++i)
+    {
+        futures.push_back(executor.Submit([&]() {
+            const int now = ++running;
+            int expected = maxRunning;
+            while (now > expected && !maxRunning.compare_exchange_weak(expected, now))
+            {
+            }
+            std::this_thread::sleep_for(5ms);
+            --running;
+        }));
+    }
+
+    for (auto& future : futures)
+    {
+        future.get();
+    }
+
+    REQUIRE(maxRunning > 1);
+    REQUIRE(maxRunning <= static_cast<int>(maxThreads));
+}
+
+TEST("Testing Executor::ParallelFor()")
+{
+    Executor executor(4);
+
+    SECTION("Every index is visited once")
+    {
+        std::vector<std::atomic<int>> visits(100);
+        executor.ParallelFor(visits.size(), visits.size(), [&](size_t i) { ++visits[i]; });
+        for (const auto& count : visits)
+        {
+            REQUIRE(count == 1);
+        }
+    }
+
+    SECTION("No work")
+    {
+        executor.ParallelFor(0, 4, [](size_t) { FAIL("Should not be called"); });
+    }
+
+    SECTION("A parallelism of 0 runs everything in the calling thread")
+    {
+        const auto callerId = std::this_thread::get_id();
+        executor.ParallelFor(10, 0, [&](size_t) { REQUIRE(std::this_thread::get_id() == callerId); });
+    }
+
+    SECTION("Parallelism is capped")
+    {
+        std::atomic<int> running{0};
+        std::atomic<int> maxRunning{0};
+        executor.ParallelFor(20, 2, [&](size_t) {
+            const int now = ++running;
+            int expected = maxRunning;
+            while (now > expected && !maxRunning.compare_exchange_weak(expected, now))
+            {
+            }
+            std::this_thread::sleep_for(2ms);
+            --running;
+        });
+        REQUIRE(maxRunning <= 2);
+    }
+
+    SECTION("The first exception is rethrown and stops new calls")
+    {
+        std::atomic<int> calls{0};
+        REQUIRE_THROWS_AS(executor.ParallelFor(1000,
+                                               1,
+                                               [&](size_t i) {
+                                                   ++calls;
+                                                   if (i == 10)
+                                                   {
+                                                       throw std::runtime_error("error");
+                                                   }
+                                               }),
+                          std::runtime_error);
+        REQUIRE(calls == 11);
+    }
+
+    SECTION("Can be called from a task of the same executor when all workers are busy")
+    {
+        Executor singleThreadExecutor(1);
+        auto future = singleThreadExecutor.Submit([&]() {
+            std::atomic<int> sum{0};
+            singleThreadExecutor.ParallelFor(10, 10, [&](size_t i) { sum += static_cast<int>(i); });
+            return sum.load();
+        });
+        REQUIRE(future.get() == 45);
+    }
+}
+
+TEST("Testing Executor::TryPost() only queues tasks a worker can run right away")
+{
+    Executor executor(1);
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> started;
+    REQUIRE(executor.TryPost([&]() {
+        started.set_value();
+        released.wait();
+    }));
+    started.get_future().wait();
+
+    INFO("The only worker is busy");
+    REQUIRE_FALSE(executor.TryPost([]() {}));
+
+    INFO("Once the worker is idle again, it takes the next task");
+    release.set_value();
+    bool posted = false;
+    for (int i = 0; i < 1000 && !posted; ++i)
+    {
+        std::promise<void> done;
+        posted = executor.TryPost([&]() { done.set_value(); });
+        if (posted)
+        {
+            REQUIRE(done.get_future().wait_for(1s) == std::future_status::ready);
+        }
+        else
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    REQUIRE(posted);
+}
+
+TEST("Testing Executor runs queued tasks before being destroyed")
+{
+    std::atomic<int> completed{0};
+    {
+        // A single thread means all but the first task are still queued when the executor goes away
+        Executor executor(0);
+        for (int i = 0; i < 10; ++i)
+        {
+            executor.Post([&]() {
+                std::this_thread::sleep_for(1ms);
+                ++completed;
+            });
+        }
+    }
+    REQUIRE(completed == 10);
+}
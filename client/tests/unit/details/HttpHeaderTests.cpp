@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "connection/HttpHeader.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#define TEST(...) TEST_CASE("[HttpHeaderTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+
+TEST("Testing GetHeaderValue()")
+{
+    REQUIRE(GetHeaderValue("Content-Length: 123\r\n", HttpHeader::ContentLength) == "123");
+    REQUIRE(GetHeaderValue("content-length:123", HttpHeader::ContentLength) == "123");
+    REQUIRE(GetHeaderValue("CONTENT-LENGTH: \t 123 \r\n", HttpHeader::ContentLength) == "123");
+    REQUIRE(GetHeaderValue("Retry-After: Wed, 21 Oct 2015 07:28:00 GMT\r\n", HttpHeader::RetryAfter) ==
+            "Wed, 21 Oct 2015 07:28:00 GMT");
+    REQUIRE(GetHeaderValue("Content-Length:\r\n", HttpHeader::ContentLength) == "");
+
+    REQUIRE(!GetHeaderValue("Content-Type: application/json\r\n", HttpHeader::ContentLength));
+    REQUIRE(!GetHeaderValue("Content-Length-Extra: 123\r\n", HttpHeader::ContentLength));
+    REQUIRE(!GetHeaderValue("HTTP/1.1 200 OK\r\n", HttpHeader::ContentLength));
+    REQUIRE(!GetHeaderValue("\r\n", HttpHeader::ContentLength));
+}
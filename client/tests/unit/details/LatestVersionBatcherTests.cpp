@@ -0,0 +1,243 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "../../util/SFSExceptionMatcher.h"
+#include "../../util/TestHelper.h"
+#include "LatestVersionBatcher.h"
+#include "ReportingHandler.h"
+#include "SFSException.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define TEST(...) TEST_CASE("[LatestVersionBatcherTests] " __VA_ARGS__)
+
+using namespace SFS;
+using namespace SFS::details;
+using namespace SFS::test;
+using namespace std::chrono_literals;
+
+namespace
+{
+std::unique_ptr<VersionEntity> MakeEntity(const std::string& product)
+{
+    auto entity = std::make_unique<GenericVersionEntity>();
+    entity->contentId = {"ns", product, product + "Version"};
+    return entity;
+}
+
+// Answers every requested product, except for the ones named "unknown"
+struct MockService
+{
+    VersionEntities SendBatch(const std::vector<ProductRequest>& requests)
+    {
+        {
+            std::lock_guard guard(mutex);
+            batchSizes.push_back(requests.size());
+        }
+
+        VersionEntities entities;
+        for (const auto& request : requests)
+        {
+            if (request.product != "unknown")
+            {
+                entities.push_back(MakeEntity(request.product));
+            }
+        }
+        return entities;
+    }
+
+    std::mutex mutex;
+    std::vector<size_t> batchSizes;
+};
+} // namespace
+
+TEST("Testing LatestVersionBatcher sends concurrent lookups in a single batch")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    // The window is long enough that the batch is only sent once full
+    const size_t lookupCount = 8;
+    LatestVersionBatcher batcher(1h, lookupCount, handler);
+    MockService service;
+    auto sendBatch = [&service](const std::vector<ProductRequest>& requests) { return service.SendBatch(requests); };
+
+    // Catch2 assertions are not thread-safe, so the threads only record what they got
+    std::vector<std::string> versions(lookupCount);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < lookupCount; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            const std::string product = "p" + std::to_string(i);
+            versions[i] = batcher.GetLatestVersion({product, {}}, sendBatch)->contentId.version;
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(service.batchSizes == std::vector<size_t>{lookupCount});
+    for (size_t i = 0; i < lookupCount; ++i)
+    {
+        REQUIRE(versions[i] == "p" + std::to_string(i) + "Version");
+    }
+    REQUIRE(batcher.GetBatchCount() == 1);
+    REQUIRE(batcher.GetBatchedLookupCount() == lookupCount);
+}
+
+TEST("Testing LatestVersionBatcher sends a batch once its window ends")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    LatestVersionBatcher batcher(10ms, 32, handler);
+    MockService service;
+    auto sendBatch = [&service](const std::vector<ProductRequest>& requests) { return service.SendBatch(requests); };
+
+    REQUIRE(batcher.GetLatestVersion({"p1", {}}, sendBatch)->contentId.name == "p1");
+    REQUIRE(batcher.GetLatestVersion({"p2", {}}, sendBatch)->contentId.name == "p2");
+    REQUIRE(service.batchSizes == std::vector<size_t>{1, 1});
+
+    SECTION("Products the service does not return are not found")
+    {
+        REQUIRE_THROWS_CODE(batcher.GetLatestVersion({"unknown", {}}, sendBatch), HttpNotFound);
+    }
+
+    SECTION("A failed batch fails all of its lookups")
+    {
+        auto failBatch = [](const std::vector<ProductRequest>&) -> VersionEntities {
+            throw SFSException(Result::HttpServiceNotAvailable);
+        };
+        REQUIRE_THROWS_CODE(batcher.GetLatestVersion({"p1", {}}, failBatch), HttpServiceNotAvailable);
+    }
+}
+
+TEST("Testing LatestVersionBatcher sends lookups of the same product in different batches")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    LatestVersionBatcher batcher(50ms, 32, handler);
+    MockService service;
+    std::mutex mutex;
+    std::vector<std::vector<std::string>> batches;
+    auto sendBatch = [&](const std::vector<ProductRequest>& requests) {
+        {
+            std::lock_guard guard(mutex);
+            batches.emplace_back();
+            for (const auto& request : requests)
+            {
+                batches.back().push_back(request.product);
+            }
+        }
+        return service.SendBatch(requests);
+    };
+
+    std::vector<std::thread> threads;
+    for (const std::string product : {"p1", "p1", "p2", "p1"})
+    {
+        threads.emplace_back([&, product]() { batcher.GetLatestVersion({product, {}}, sendBatch); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    size_t lookups = 0;
+    for (auto& batch : batches)
+    {
+        lookups += batch.size();
+        std::sort(batch.begin(), batch.end());
+        REQUIRE(std::adjacent_find(batch.begin(), batch.end()) == batch.end());
+    }
+    REQUIRE(lookups == 4);
+    REQUIRE(batches.size() >= 3);
+}
+
+TEST("Testing LatestVersionBatcher does not hand the errors specific to the sender to the other lookups")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    LatestVersionBatcher batcher(1h, 2, handler);
+    MockService service;
+    auto isSharedError = [](const std::exception_ptr& error) {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const SFSException& e)
+        {
+            return e.GetResult().GetCode() != Result::ConnectionCancelled;
+        }
+        catch (...)
+        {
+            return true;
+        }
+    };
+
+    // The sender of the first batch is cancelled, and the other lookup joins the next batch instead of failing
+    std::atomic<bool> senderStarted{false};
+    auto cancelledBatch = [&](const std::vector<ProductRequest>&) -> VersionEntities {
+        throw SFSException(Result::ConnectionCancelled);
+    };
+    auto sendBatch = [&service](const std::vector<ProductRequest>& requests) { return service.SendBatch(requests); };
+
+    // Catch2 assertions are not thread-safe, so the threads only record what they got
+    Result::Code senderCode = Result::NotSet;
+    std::string followerVersion;
+    std::thread sender([&]() {
+        try
+        {
+            senderStarted = true;
+            batcher.GetLatestVersion({"p1", {}}, cancelledBatch, isSharedError);
+        }
+        catch (const SFSException& e)
+        {
+            senderCode = e.GetResult().GetCode();
+        }
+    });
+    while (!senderStarted)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+    std::this_thread::sleep_for(50ms);
+
+    // Joining fills the batch, which is then sent by the first lookup
+    std::thread follower([&]() {
+        followerVersion = batcher.GetLatestVersion({"p2", {}}, sendBatch, isSharedError)->contentId.version;
+    });
+
+    sender.join();
+    REQUIRE(senderCode == Result::ConnectionCancelled);
+
+    // The window is long, so the follower's own batch is only sent once another lookup fills it
+    std::string otherVersion;
+    std::thread other([&]() {
+        otherVersion = batcher.GetLatestVersion({"p3", {}}, sendBatch, isSharedError)->contentId.version;
+    });
+    follower.join();
+    other.join();
+
+    REQUIRE(followerVersion == "p2Version");
+    REQUIRE(otherVersion == "p3Version");
+    REQUIRE(service.batchSizes == std::vector<size_t>{2});
+    REQUIRE(batcher.GetBatchCount() == 2);
+
+    INFO("Shared errors are still handed to every lookup of the batch");
+    LatestVersionBatcher quickBatcher(10ms, 32, handler);
+    REQUIRE_THROWS_CODE(quickBatcher.GetLatestVersion(
+                            {"p1", {}},
+                            [](const std::vector<ProductRequest>&) -> VersionEntities {
+                                throw SFSException(Result::HttpServiceNotAvailable);
+                            },
+                            isSharedError),
+                        HttpServiceNotAvailable);
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "LruCache.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+#include <vector>
+
+#define TEST(...) TEST_CASE("[LruCacheTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace std::chrono_literals;
+
+TEST("Testing LruCache::Get() and LruCache::Put()")
+{
+    LruCache<int> cache(2, 1h);
+
+    REQUIRE(!cache.Get("a"));
+    cache.Put("a", 1);
+    REQUIRE(cache.Get("a") == 1);
+
+    // Replacing a value
+    cache.Put("a", 2);
+    REQUIRE(cache.Get("a") == 2);
+
+    cache.Remove("a");
+    REQUIRE(!cache.Get("a"));
+
+    auto statistics = cache.GetStatistics();
+    REQUIRE(statistics.hits == 2);
+    REQUIRE(statistics.misses == 2);
+    REQUIRE(statistics.evictions == 0);
+    REQUIRE(statistics.entries == 0);
+}
+
+TEST("Testing LruCache evicts the least recently used entry")
+{
+    LruCache<int> cache(2, 1h);
+    cache.Put("a", 1);
+    cache.Put("b", 2);
+
+    // Using "a" makes "b" the least recently used entry
+    REQUIRE(cache.Get("a") == 1);
+    cache.Put("c", 3);
+
+    REQUIRE(cache.Get("a") == 1);
+    REQUIRE(!cache.Get("b"));
+    REQUIRE(cache.Get("c") == 3);
+
+    auto statistics = cache.GetStatistics();
+    REQUIRE(statistics.evictions == 1);
+    REQUIRE(statistics.entries == 2);
+}
+
+TEST("Testing LruCache entries expire")
+{
+    LruCache<int> cache(2, 50ms);
+    cache.Put("a", 1);
+    cache.Put("b", 2, LruCache<int>::Clock::now() + 1h);
+    REQUIRE(cache.Get("a") == 1);
+
+    std::this_thread::sleep_for(60ms);
+    REQUIRE(!cache.Get("a"));
+    REQUIRE(cache.Get("b") == 2);
+
+    auto statistics = cache.GetStatistics();
+    REQUIRE(statistics.hits == 2);
+    REQUIRE(statistics.misses == 1);
+    REQUIRE(statistics.entries == 1);
+}
+
+TEST("Testing LruCache::GetAllowingStale()")
+{
+    LruCache<int> cache(2, 1h);
+    const auto now = LruCache<int>::Clock::now();
+    cache.Put("fresh", 1);
+    cache.Put("stale", 2, now - 1min);
+
+    auto lookup = cache.GetAllowingStale("fresh", 1h);
+    REQUIRE(lookup);
+    REQUIRE(lookup->value == 1);
+    REQUIRE(!lookup->isStale);
+
+    lookup = cache.GetAllowingStale("stale", 1h);
+    REQUIRE(lookup);
+    REQUIRE(lookup->value == 2);
+    REQUIRE(lookup->isStale);
+
+    // Too stale for the caller, so it is dropped
+    REQUIRE(!cache.GetAllowingStale("stale", 30s));
+    REQUIRE(!cache.GetAllowingStale("stale", 1h));
+
+    // Refreshing the value makes it fresh again
+    cache.Put("fresh", 3, now - 1min);
+    REQUIRE(!cache.Get("fresh"));
+    cache.Put("fresh", 4);
+    REQUIRE(cache.GetAllowingStale("fresh", 0s)->value == 4);
+
+    auto statistics = cache.GetStatistics();
+    REQUIRE(statistics.hits == 3);
+    REQUIRE(statistics.staleHits == 1);
+    REQUIRE(statistics.misses == 3);
+    REQUIRE(statistics.entries == 1);
+}
+
+TEST("Testing LruCache with no entries stores nothing")
+{
+    LruCache<int> cache(0, 1h);
+    cache.Put("a", 1);
+    REQUIRE(!cache.Get("a"));
+    REQUIRE(cache.GetStatistics().entries == 0);
+}
+
+TEST("Testing LruCache from multiple threads")
+{
+    LruCache<int> cache(16, 1h);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&cache, i]() {
+            for (int j = 0; j < 1000; ++j)
+            {
+                const std::string key = std::to_string((i + j) % 32);
+                if (!cache.Get(key))
+                {
+                    cache.Put(key, j);
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto statistics = cache.GetStatistics();
+    REQUIRE(statistics.hits + statistics.misses == 8000);
+    REQUIRE(statistics.entries <= 16);
+}
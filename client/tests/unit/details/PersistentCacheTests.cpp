@@ -0,0 +1,233 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "../../util/TestHelper.h"
+#include "PersistentCache.h"
+#include "ReportingHandler.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+#define TEST(...) TEST_CASE("[PersistentCacheTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace SFS::test;
+using namespace std::chrono_literals;
+
+namespace
+{
+class TemporaryDirectory
+{
+  public:
+    TemporaryDirectory()
+    {
+        std::random_device random;
+        m_path = std::filesystem::temp_directory_path() / ("PersistentCacheTests" + std::to_string(random()));
+    }
+
+    ~TemporaryDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    const std::filesystem::path& GetPath() const
+    {
+        return m_path;
+    }
+
+  private:
+    std::filesystem::path m_path;
+};
+} // namespace
+
+TEST("Testing PersistentCache::Get() and PersistentCache::Put()")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    TemporaryDirectory directory;
+    const auto filePath = directory.GetPath() / "cache.bin";
+    const auto expiresAt = PersistentCache::Clock::now() + 1h;
+
+    {
+        PersistentCache cache(filePath, 10, 0s, handler);
+        REQUIRE(!cache.Get("a"));
+        REQUIRE(!std::filesystem::exists(filePath));
+
+        cache.Put("a", "value", expiresAt);
+        cache.Put("b", std::string("with\0zero", 9), expiresAt);
+        cache.Put("", "", expiresAt);
+
+        // Entries are written in the background, or when the cache is destroyed, not by Put() itself
+        REQUIRE(!std::filesystem::exists(filePath));
+
+        auto entry = cache.Get("a");
+        REQUIRE(entry);
+        REQUIRE(entry->value == "value");
+
+        const auto statistics = cache.GetStatistics();
+        REQUIRE(statistics.hits == 1);
+        REQUIRE(statistics.misses == 1);
+        REQUIRE(statistics.entries == 3);
+    }
+
+    REQUIRE(std::filesystem::exists(filePath));
+
+    SECTION("Entries are read back by a new instance")
+    {
+        PersistentCache cache(filePath, 10, 0s, handler);
+
+        auto entry = cache.Get("a");
+        REQUIRE(entry);
+        REQUIRE(entry->value == "value");
+        REQUIRE(std::chrono::duration_cast<std::chrono::seconds>(entry->expiresAt - expiresAt) == 0s);
+
+        entry = cache.Get("b");
+        REQUIRE(entry);
+        REQUIRE(entry->value == std::string("with\0zero", 9));
+
+        entry = cache.Get("");
+        REQUIRE(entry);
+        REQUIRE(entry->value.empty());
+    }
+
+    SECTION("Instances sharing a file keep each other's entries")
+    {
+        PersistentCache cache1(filePath, 10, 0s, handler);
+        PersistentCache cache2(filePath, 10, 0s, handler);
+        REQUIRE(cache1.Get("a"));
+        REQUIRE(cache2.Get("a"));
+
+        cache1.Put("c", "from1", expiresAt);
+        cache1.Flush();
+        cache2.Put("d", "from2", expiresAt);
+        cache2.Flush();
+
+        PersistentCache cache3(filePath, 10, 0s, handler);
+        REQUIRE(cache3.Get("a"));
+        REQUIRE(cache3.Get("c")->value == "from1");
+        REQUIRE(cache3.Get("d")->value == "from2");
+
+        INFO("Entries written by other instances are picked up when writing");
+        REQUIRE(cache2.Get("c")->value == "from1");
+    }
+
+    SECTION("A corrupted file is ignored")
+    {
+        // Not a cache file, and a cache file with fewer entries than its header says
+        const std::string truncatedFile("SFSC\x01\0\0\0\x05\0\0\0\0\0\0\0", 16);
+        for (const std::string& contents : {std::string("garbage"), truncatedFile})
+        {
+            {
+                std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+                file << contents;
+            }
+
+            PersistentCache cache(filePath, 10, 0s, handler);
+            REQUIRE(!cache.Get("a"));
+
+            // And replaced on the next write
+            cache.Put("e", "value", expiresAt);
+            cache.Flush();
+            PersistentCache otherCache(filePath, 10, 0s, handler);
+            REQUIRE(otherCache.Get("e"));
+        }
+    }
+
+    SECTION("An entry with an out-of-range timestamp is ignored")
+    {
+        // The first entry follows the 16-byte file header: its key size, value size, storage time, expiry, then its key
+        std::string corruptedKey;
+        {
+            std::fstream file(filePath, std::ios::binary | std::ios::in | std::ios::out);
+            char keySize = 0;
+            file.seekg(16);
+            file.read(&keySize, 1);
+            corruptedKey.resize(static_cast<size_t>(keySize));
+            file.seekg(16 + 24);
+            file.read(corruptedKey.data(), keySize);
+
+            file.seekp(16 + 16);
+            file.write("\xff\xff\xff\xff\xff\xff\xff\x7f", 8);
+        }
+
+        PersistentCache cache(filePath, 10, 0s, handler);
+        REQUIRE(!cache.Get(corruptedKey));
+        for (const std::string key : {"", "a", "b"})
+        {
+            if (key != corruptedKey)
+            {
+                REQUIRE(cache.Get(key));
+            }
+        }
+    }
+}
+
+TEST("Testing PersistentCache drops old entries")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    TemporaryDirectory directory;
+    const auto filePath = directory.GetPath() / "cache.bin";
+    const auto now = PersistentCache::Clock::now();
+
+    SECTION("Expired entries are kept for the retention time")
+    {
+        PersistentCache cache(filePath, 10, 1h, handler);
+        cache.Put("expired", "value", now - 2h);
+        cache.Put("stale", "value", now - 30min);
+        cache.Flush();
+
+        PersistentCache otherCache(filePath, 10, 1h, handler);
+        REQUIRE(!otherCache.Get("expired"));
+        REQUIRE(otherCache.Get("stale"));
+    }
+
+    SECTION("The oldest entries are dropped beyond the maximum")
+    {
+        PersistentCache cache(filePath, 2, 0s, handler);
+        cache.Put("a", "value", now + 1h);
+        cache.Put("b", "value", now + 1h);
+        cache.Put("c", "value", now + 1h);
+        REQUIRE(cache.GetStatistics().evictions == 1);
+        REQUIRE(cache.GetStatistics().entries == 2);
+        REQUIRE(cache.Get("c"));
+    }
+
+    SECTION("A cache with no entries never stores anything")
+    {
+        PersistentCache cache(filePath, 0, 0s, handler);
+        cache.Put("a", "value", now + 1h);
+        cache.Flush();
+        REQUIRE(!cache.Get("a"));
+        REQUIRE(!std::filesystem::exists(filePath));
+    }
+}
+
+TEST("Testing PersistentCache writes entries in the background")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    TemporaryDirectory directory;
+    const auto filePath = directory.GetPath() / "cache.bin";
+
+    PersistentCache cache(filePath, 10, 0s, handler);
+    cache.Put("a", "value", PersistentCache::Clock::now() + 1h);
+
+    // The entries put within a second are written together
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!std::filesystem::exists(filePath) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(50ms);
+    }
+
+    PersistentCache otherCache(filePath, 10, 0s, handler);
+    REQUIRE(otherCache.Get("a"));
+}
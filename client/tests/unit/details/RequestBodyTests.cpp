@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "../../util/SFSExceptionMatcher.h"
+#include "../../util/TestHelper.h"
+#include "ReportingHandler.h"
+#include "RequestBody.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+#define TEST(...) TEST_CASE("[RequestBodyTests] " __VA_ARGS__)
+
+using namespace SFS;
+using namespace SFS::details;
+using namespace SFS::test;
+using json = nlohmann::json;
+
+TEST("Testing AppendJsonString() escapes like nlohmann::json")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    SECTION("Valid strings")
+    {
+        const std::vector<std::string> values = {"",
+                                                 "value",
+                                                 "quote \" backslash \\ slash /",
+                                                 "\b\f\n\r\t",
+                                                 std::string("\x00\x01\x1f\x7f", 4),
+                                                 "\xc3\xa9t\xc3\xa9",
+                                                 "\xe2\x82\xac \xf0\x9f\x98\x80 \xef\xbf\xbf \xf4\x8f\xbf\xbf"};
+        for (const auto& value : values)
+        {
+            INFO(value);
+            std::string body = "prefix";
+            AppendJsonString(value, body, handler);
+            REQUIRE(body == "prefix" + json(value).dump());
+        }
+    }
+
+    SECTION("Invalid UTF-8")
+    {
+        const std::vector<std::string> values = {"\x80",
+                                                 "a\xc3",
+                                                 "\xc0\xaf",
+                                                 "\xe0\x80\xaf",
+                                                 "\xed\xa0\x80",
+                                                 "\xf4\x90\x80\x80",
+                                                 "\xf5\x80\x80\x80",
+                                                 "\xe2\x82"};
+        for (const auto& value : values)
+        {
+            INFO(value);
+            std::string body;
+            REQUIRE_THROWS_CODE(AppendJsonString(value, body, handler), InvalidArg);
+            REQUIRE_THROWS_AS(json(value).dump(), json::type_error);
+        }
+    }
+}
+
+TEST("Testing WriteLatestVersionRequestBody()")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    std::string body;
+    WriteLatestVersionRequestBody({}, body, handler);
+    REQUIRE(body == R"({"TargetingAttributes":{}})");
+
+    const TargetingAttributes attributes{{"attr1", "value"}, {"attr\"2", "line\nbreak"}};
+    WriteLatestVersionRequestBody(attributes, body, handler);
+    REQUIRE(json::parse(body) == json({{"TargetingAttributes", attributes}}));
+
+    SECTION("The buffer is reused")
+    {
+        const auto capacity = body.capacity();
+        const auto* data = body.data();
+        WriteLatestVersionRequestBody({{"attr1", "value"}}, body, handler);
+        REQUIRE(body == R"({"TargetingAttributes":{"attr1":"value"}})");
+        REQUIRE(body.capacity() == capacity);
+        REQUIRE(body.data() == data);
+    }
+}
+
+TEST("Testing WriteLatestVersionBatchRequestBody()")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    std::string body = "previous contents";
+    WriteLatestVersionBatchRequestBody({}, body, handler);
+    REQUIRE(body == "[]");
+
+    const std::vector<ProductRequest> requests{{"p1", {}}, {"p\\2", {{"attr1", "value"}, {"attr2", "\xc3\xa9"}}}};
+    WriteLatestVersionBatchRequestBody(requests, body, handler);
+
+    json expected = json::array();
+    for (const auto& [product, attributes] : requests)
+    {
+        expected.push_back({{"TargetingAttributes", attributes}, {"Product", product}});
+    }
+    REQUIRE(json::parse(body) == expected);
+
+    REQUIRE_THROWS_CODE(WriteLatestVersionBatchRequestBody({{"\xff", {}}}, body, handler), InvalidArg);
+}
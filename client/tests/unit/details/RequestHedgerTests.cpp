@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "RequestHedger.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#define TEST(...) TEST_CASE("[RequestHedgerTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace std::chrono_literals;
+
+namespace
+{
+void RecordLatencies(RequestHedger& hedger, int first, int last)
+{
+    for (int i = first; i <= last; ++i)
+    {
+        hedger.RecordLatency(std::chrono::milliseconds(i));
+    }
+}
+} // namespace
+
+TEST("Testing RequestHedger does not hedge until enough latencies are recorded")
+{
+    RequestHedger hedger(0.9 /*percentile*/, 1.0 /*maxHedgeRate*/);
+
+    RecordLatencies(hedger, 1, 19);
+    REQUIRE_FALSE(hedger.OnRequest());
+
+    hedger.RecordLatency(20ms);
+    REQUIRE(hedger.OnRequest() == 18ms);
+}
+
+TEST("Testing RequestHedger hedges after a percentile of the recent latencies")
+{
+    SECTION("90th percentile")
+    {
+        RequestHedger hedger(0.9 /*percentile*/, 1.0 /*maxHedgeRate*/);
+        RecordLatencies(hedger, 1, 100);
+        REQUIRE(hedger.OnRequest() == 90ms);
+    }
+
+    SECTION("100th percentile")
+    {
+        RequestHedger hedger(1.0 /*percentile*/, 1.0 /*maxHedgeRate*/);
+        RecordLatencies(hedger, 1, 100);
+        REQUIRE(hedger.OnRequest() == 100ms);
+    }
+
+    SECTION("Only the last 100 latencies count")
+    {
+        RequestHedger hedger(0.5 /*percentile*/, 1.0 /*maxHedgeRate*/);
+        RecordLatencies(hedger, 1, 100);
+        RecordLatencies(hedger, 1001, 1100);
+        REQUIRE(hedger.OnRequest() == 1050ms);
+    }
+}
+
+TEST("Testing RequestHedger bounds hedges to a fraction of the requests")
+{
+    RequestHedger hedger(0.5 /*percentile*/, 0.25 /*maxHedgeRate*/);
+    RecordLatencies(hedger, 1, 100);
+
+    int hedges = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        if (hedger.OnRequest())
+        {
+            REQUIRE(hedger.TryHedge());
+            ++hedges;
+        }
+    }
+
+    // Only every fourth request earns a hedge
+    REQUIRE(hedges == 25);
+    REQUIRE(hedger.GetHedgeCount() == 25);
+    REQUIRE_FALSE(hedger.TryHedge());
+}
+
+TEST("Testing RequestHedger holds at most 10 hedges")
+{
+    RequestHedger hedger(0.5 /*percentile*/, 1.0 /*maxHedgeRate*/);
+    for (int i = 0; i < 100; ++i)
+    {
+        hedger.OnRequest();
+    }
+
+    int hedges = 0;
+    while (hedger.TryHedge())
+    {
+        ++hedges;
+    }
+    REQUIRE(hedges == 10);
+}
+
+TEST("Testing RequestHedger counts the hedges that won")
+{
+    RequestHedger hedger(0.5 /*percentile*/, 1.0 /*maxHedgeRate*/);
+    REQUIRE(hedger.GetHedgeWinCount() == 0);
+    hedger.OnHedgeWon();
+    REQUIRE(hedger.GetHedgeWinCount() == 1);
+}
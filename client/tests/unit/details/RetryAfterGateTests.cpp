@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "connection/RetryAfterGate.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+
+#define TEST(...) TEST_CASE("[RetryAfterGateTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+TEST("Testing RetryAfterGate holds back the requests to a host until it reopens")
+{
+    RetryAfterGate gate;
+    const std::string url = "https://host.com/api/v2/contents/product";
+
+    REQUIRE_FALSE(gate.GetReopenTime(url));
+
+    const auto reopenTime = steady_clock::now() + 1h;
+    gate.Close(url, reopenTime);
+
+    SECTION("The gate is closed for all URLs of the host")
+    {
+        REQUIRE(gate.GetReopenTime(url) == reopenTime);
+        REQUIRE(gate.GetReopenTime("https://host.com/other") == reopenTime);
+    }
+
+    SECTION("Other hosts are not affected")
+    {
+        REQUIRE_FALSE(gate.GetReopenTime("https://other.com/api"));
+        REQUIRE_FALSE(gate.GetReopenTime("https://host.com:8080/api"));
+        REQUIRE_FALSE(gate.GetReopenTime("http://host.com/api"));
+    }
+
+    SECTION("Closing the gate again only extends it")
+    {
+        gate.Close(url, reopenTime - 30min);
+        REQUIRE(gate.GetReopenTime(url) == reopenTime);
+
+        gate.Close(url, reopenTime + 30min);
+        REQUIRE(gate.GetReopenTime(url) == reopenTime + 30min);
+    }
+}
+
+TEST("Testing RetryAfterGate reopens once the time is reached")
+{
+    RetryAfterGate gate;
+    const std::string url = "https://host.com/api";
+
+    gate.Close(url, steady_clock::now() + 50ms);
+    gate.Close("https://other.com/api", steady_clock::now() - 1s);
+    REQUIRE(gate.GetReopenTime(url));
+    REQUIRE_FALSE(gate.GetReopenTime("https://other.com/api"));
+
+    std::this_thread::sleep_for(100ms);
+    REQUIRE_FALSE(gate.GetReopenTime(url));
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "connection/RetryBudget.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#define TEST(...) TEST_CASE("[RetryBudgetTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+
+TEST("Testing RetryBudget allows a burst of retries")
+{
+    RetryBudget budget(0.1 /*ratio*/, 3 /*maxTokens*/);
+    REQUIRE(budget.GetStatistics().availableRetries == 3);
+
+    REQUIRE(budget.TryRetry());
+    REQUIRE(budget.TryRetry());
+    REQUIRE(budget.TryRetry());
+    REQUIRE_FALSE(budget.TryRetry());
+
+    const auto statistics = budget.GetStatistics();
+    REQUIRE(statistics.availableRetries == 0);
+    REQUIRE(statistics.retries == 3);
+    REQUIRE(statistics.rejectedRetries == 1);
+}
+
+TEST("Testing RetryBudget bounds retries to a fraction of the requests")
+{
+    RetryBudget budget(0.25 /*ratio*/, 1 /*maxTokens*/);
+    REQUIRE(budget.TryRetry());
+
+    int retries = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        budget.OnRequest();
+        if (budget.TryRetry())
+        {
+            ++retries;
+        }
+    }
+
+    // Only every fourth request earns a retry
+    REQUIRE(retries == 25);
+    REQUIRE(budget.GetStatistics().retries == 26);
+    REQUIRE(budget.GetStatistics().rejectedRetries == 75);
+}
+
+TEST("Testing RetryBudget holds at most its maximum")
+{
+    RetryBudget budget(0.5 /*ratio*/, 2 /*maxTokens*/);
+    for (int i = 0; i < 100; ++i)
+    {
+        budget.OnRequest();
+    }
+    REQUIRE(budget.GetStatistics().availableRetries == 2);
+}
+
+TEST("Testing RetryBudget with a ratio of 0 only allows the initial burst")
+{
+    RetryBudget budget(0.0 /*ratio*/, 1 /*maxTokens*/);
+    budget.OnRequest();
+    REQUIRE(budget.TryRetry());
+    budget.OnRequest();
+    REQUIRE_FALSE(budget.TryRetry());
+}
@@ -14,6 +14,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <nlohmann/json.hpp>
 
+#include <filesystem>
+#include <random>
+
 #define TEST(...) TEST_CASE("[SFSClientImplTests] " __VA_ARGS__)
 
 using namespace SFS;
@@ -266,6 +269,251 @@ TEST("Testing class SFSClientImpl()")
     }
 }
 
+TEST("Testing SFSClientImpl latest version cache")
+{
+    const std::string ns = "testNameSpace";
+    ClientConfig config{"testAccountId", "testInstanceId", ns, LogCallbackToTest};
+    config.latestVersionCacheTtl = std::chrono::seconds(60);
+    config.latestVersionCacheMaxEntries = 2;
+    SFSClientImpl<CurlConnectionManager> sfsClient(std::move(config));
+
+    Result::Code responseCode = Result::Success;
+    std::string getResponse;
+    std::string postResponse;
+    bool expectEmptyPostBody = false;
+    std::unique_ptr<Connection> connection = std::make_unique<MockCurlConnection>(sfsClient.GetReportingHandler(),
+                                                                                  responseCode,
+                                                                                  getResponse,
+                                                                                  postResponse,
+                                                                                  expectEmptyPostBody);
+
+    auto SetResponse = [&](const std::string& name, const std::string& version) {
+        const json latestVersionResponse = {{"ContentId", {{"Namespace", ns}, {"Name", name}, {"Version", version}}}};
+        postResponse = latestVersionResponse.dump();
+    };
+
+    const TargetingAttributes attributes{{"attr1", "value"}, {"attr2", "value"}};
+    SetResponse("p1", "1.0");
+    auto entity = sfsClient.GetLatestVersion({"p1", attributes}, *connection);
+    CheckProduct(*entity, ns, "p1", "1.0");
+
+    // Cached lookups do not reach the connection, so they succeed even if it fails
+    responseCode = Result::HttpNotFound;
+    entity = sfsClient.GetLatestVersion({"p1", attributes}, *connection);
+    CheckProduct(*entity, ns, "p1", "1.0");
+
+    auto statistics = sfsClient.GetStatistics().latestVersionCache;
+    REQUIRE(statistics.hits == 1);
+    REQUIRE(statistics.misses == 1);
+    REQUIRE(statistics.entries == 1);
+
+    SECTION("Different attributes are different lookups")
+    {
+        REQUIRE_THROWS_CODE(sfsClient.GetLatestVersion({"p1", {{"attr1", "value"}}}, *connection), HttpNotFound);
+
+        responseCode = Result::Success;
+        SetResponse("p1", "2.0");
+        entity = sfsClient.GetLatestVersion({"p1", {{"attr1", "value"}}}, *connection);
+        CheckProduct(*entity, ns, "p1", "2.0");
+
+        // The order of the attributes does not matter
+        TargetingAttributes sameAttributes;
+        sameAttributes["attr2"] = "value";
+        sameAttributes["attr1"] = "value";
+        responseCode = Result::HttpNotFound;
+        entity = sfsClient.GetLatestVersion({"p1", sameAttributes}, *connection);
+        CheckProduct(*entity, ns, "p1", "1.0");
+    }
+
+    SECTION("Failed lookups are not cached")
+    {
+        REQUIRE_THROWS_CODE(sfsClient.GetLatestVersion({"p2", {}}, *connection), HttpNotFound);
+        REQUIRE_THROWS_CODE(sfsClient.GetLatestVersion({"p2", {}}, *connection), HttpNotFound);
+        REQUIRE(sfsClient.GetStatistics().latestVersionCache.entries == 1);
+    }
+
+    SECTION("The least recently used lookup is evicted")
+    {
+        responseCode = Result::Success;
+        SetResponse("p2", "1.0");
+        sfsClient.GetLatestVersion({"p2", {}}, *connection);
+        SetResponse("p3", "1.0");
+        sfsClient.GetLatestVersion({"p3", {}}, *connection);
+
+        statistics = sfsClient.GetStatistics().latestVersionCache;
+        REQUIRE(statistics.evictions == 1);
+        REQUIRE(statistics.entries == 2);
+
+        responseCode = Result::HttpNotFound;
+        REQUIRE_THROWS_CODE(sfsClient.GetLatestVersion({"p1", attributes}, *connection), HttpNotFound);
+    }
+}
+
+TEST("Testing SFSClientImpl download info cache")
+{
+    ClientConfig config{"testAccountId", "testInstanceId", "testNameSpace", LogCallbackToTest};
+    config.downloadInfoCacheTtl = std::chrono::hours(1);
+    SFSClientImpl<CurlConnectionManager> sfsClient(std::move(config));
+
+    Result::Code responseCode = Result::Success;
+    std::string getResponse;
+    std::string postResponse;
+    bool expectEmptyPostBody = true;
+    std::unique_ptr<Connection> connection = std::make_unique<MockCurlConnection>(sfsClient.GetReportingHandler(),
+                                                                                  responseCode,
+                                                                                  getResponse,
+                                                                                  postResponse,
+                                                                                  expectEmptyPostBody);
+
+    auto SetResponse = [&](const std::string& url) {
+        json downloadInfoResponse = json::array();
+        downloadInfoResponse.push_back({{"Url", url},
+                                        {"FileId", "file.bin"},
+                                        {"SizeInBytes", 100},
+                                        {"Hashes", {{"Sha1", "123"}, {"Sha256", "456"}}}});
+        postResponse = downloadInfoResponse.dump();
+    };
+
+    auto ToEpochSeconds = [](std::chrono::system_clock::time_point time) {
+        return std::to_string(std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count());
+    };
+
+    SECTION("Files of a version are cached")
+    {
+        SetResponse("http://localhost/file.bin");
+        auto files = sfsClient.GetDownloadInfo("p1", "1.0", *connection);
+        REQUIRE(files.size() == 1);
+
+        // Cached lookups do not reach the connection, so they succeed even if it fails
+        responseCode = Result::HttpNotFound;
+        files = sfsClient.GetDownloadInfo("p1", "1.0", *connection);
+        REQUIRE(files.size() == 1);
+        REQUIRE(files[0]->url == "http://localhost/file.bin");
+
+        // Other versions are different lookups
+        REQUIRE_THROWS_CODE(sfsClient.GetDownloadInfo("p1", "2.0", *connection), HttpNotFound);
+
+        const auto statistics = sfsClient.GetStatistics().downloadInfoCache;
+        REQUIRE(statistics.hits == 1);
+        REQUIRE(statistics.misses == 2);
+        REQUIRE(statistics.entries == 1);
+    }
+
+    SECTION("Files with URLs about to expire are not cached")
+    {
+        const auto expiry = std::chrono::system_clock::now() + std::chrono::minutes(1);
+        SetResponse("http://localhost/file.bin?P1=" + ToEpochSeconds(expiry));
+        REQUIRE(sfsClient.GetDownloadInfo("p1", "1.0", *connection).size() == 1);
+        REQUIRE(sfsClient.GetStatistics().downloadInfoCache.entries == 0);
+    }
+
+    SECTION("Files with URLs that expire later are cached")
+    {
+        const auto expiry = std::chrono::system_clock::now() + std::chrono::minutes(30);
+        SetResponse("http://localhost/file.bin?P1=" + ToEpochSeconds(expiry));
+        REQUIRE(sfsClient.GetDownloadInfo("p1", "1.0", *connection).size() == 1);
+        REQUIRE(sfsClient.GetStatistics().downloadInfoCache.entries == 1);
+    }
+}
+
+TEST("Testing SFSClientImpl persistent cache")
+{
+    const std::string ns = "testNameSpace";
+    const auto cacheFile =
+        std::filesystem::temp_directory_path() / ("SFSClientImplTests" + std::to_string(std::random_device()()));
+
+    // Lookups within the TTL are answered from the file, and stale ones only within the tolerance
+    std::chrono::seconds ttl{0};
+    std::chrono::seconds maxStaleness{0};
+    bool expectCachedAnswer = false;
+    SECTION("Fresh")
+    {
+        ttl = std::chrono::seconds(60);
+        expectCachedAnswer = true;
+    }
+    SECTION("Stale")
+    {
+    }
+    SECTION("Stale within the tolerance")
+    {
+        maxStaleness = std::chrono::hours(1);
+        expectCachedAnswer = true;
+    }
+
+    auto MakeConfig = [&]() {
+        ClientConfig config{"testAccountId", "testInstanceId", ns, LogCallbackToTest};
+        config.latestVersionCacheTtl = ttl;
+        config.downloadInfoCacheTtl = ttl;
+        config.persistentCacheFile = cacheFile.u8string();
+        config.persistentCacheMaxStaleness = maxStaleness;
+        return config;
+    };
+
+    Result::Code responseCode = Result::Success;
+    std::string getResponse;
+    std::string postResponse;
+    bool expectEmptyPostBody = false;
+
+    {
+        // Background refreshes use connections from the MockConnectionManager, which never reach the network
+        SFSClientImpl<MockConnectionManager> sfsClient(MakeConfig());
+        MockCurlConnection connection(sfsClient.GetReportingHandler(),
+                                      responseCode,
+                                      getResponse,
+                                      postResponse,
+                                      expectEmptyPostBody);
+
+        const json latestVersionResponse = {{"ContentId", {{"Namespace", ns}, {"Name", "p1"}, {"Version", "1.0"}}}};
+        postResponse = latestVersionResponse.dump();
+        CheckProduct(*sfsClient.GetLatestVersion({"p1", {}}, connection), ns, "p1", "1.0");
+
+        expectEmptyPostBody = true;
+        json downloadInfoResponse = json::array();
+        downloadInfoResponse.push_back({{"Url", "http://localhost/file.bin"},
+                                        {"FileId", "file.bin"},
+                                        {"SizeInBytes", 100},
+                                        {"Hashes", {{"Sha1", "123"}, {"Sha256", "456"}}}});
+        postResponse = downloadInfoResponse.dump();
+        REQUIRE(sfsClient.GetDownloadInfo("p1", "1.0", connection).size() == 1);
+    }
+
+    REQUIRE(std::filesystem::exists(cacheFile));
+
+    // A new client, as in a new process, does not need the service
+    responseCode = Result::HttpNotFound;
+    {
+        SFSClientImpl<MockConnectionManager> sfsClient(MakeConfig());
+        MockCurlConnection connection(sfsClient.GetReportingHandler(),
+                                      responseCode,
+                                      getResponse,
+                                      postResponse,
+                                      expectEmptyPostBody);
+
+        if (expectCachedAnswer)
+        {
+            CheckProduct(*sfsClient.GetLatestVersion({"p1", {}}, connection), ns, "p1", "1.0");
+            const auto files = sfsClient.GetDownloadInfo("p1", "1.0", connection);
+            REQUIRE(files.size() == 1);
+            REQUIRE(files[0]->url == "http://localhost/file.bin");
+
+            const auto statistics = sfsClient.GetStatistics().persistentCache;
+            REQUIRE(statistics.hits == 2);
+            REQUIRE(statistics.entries == 2);
+        }
+        else
+        {
+            REQUIRE_THROWS_CODE(sfsClient.GetLatestVersion({"p1", {}}, connection), HttpNotFound);
+            REQUIRE_THROWS_CODE(sfsClient.GetDownloadInfo("p1", "1.0", connection), HttpNotFound);
+        }
+
+        // Other lookups still go to the service
+        REQUIRE_THROWS_CODE(sfsClient.GetLatestVersion({"p2", {}}, connection), HttpNotFound);
+    }
+
+    std::error_code error;
+    std::filesystem::remove(cacheFile, error);
+}
+
 TEST("Testing SFSClientImpl::SetCustomBaseUrl()")
 {
     ClientConfig config;
@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "SingleFlight.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define TEST(...) TEST_CASE("[SingleFlightTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace std::chrono_literals;
+
+namespace
+{
+void WaitForCoalescedCalls(const SingleFlight<int>& flights, uint64_t count)
+{
+    while (flights.GetCoalescedCalls() < count)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+}
+} // namespace
+
+TEST("Testing SingleFlight::Do() runs sequential calls")
+{
+    SingleFlight<int> flights;
+    int calls = 0;
+    auto fn = [&calls]() { return std::make_shared<const int>(++calls); };
+
+    REQUIRE(*flights.Do("a", fn) == 1);
+    REQUIRE(*flights.Do("a", fn) == 2);
+    REQUIRE(*flights.Do("b", fn) == 3);
+    REQUIRE(flights.GetCoalescedCalls() == 0);
+}
+
+TEST("Testing SingleFlight::Do() coalesces concurrent calls")
+{
+    SingleFlight<int> flights;
+    std::atomic<int> calls{0};
+    std::atomic<bool> release{false};
+
+    const int threadCount = 8;
+    std::vector<SingleFlight<int>::ResultPtr> results(threadCount);
+    std::vector<std::thread> threads;
+
+    // The first call blocks until all the others are waiting for it
+    threads.emplace_back([&]() {
+        results[0] = flights.Do("a", [&]() {
+            ++calls;
+            while (!release)
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+            return std::make_shared<const int>(42);
+        });
+    });
+    while (calls == 0)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    for (int i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            results[i] = flights.Do("a", [&]() {
+                ++calls;
+                return std::make_shared<const int>(0);
+            });
+        });
+    }
+
+    // A different key is not coalesced
+    REQUIRE(*flights.Do("b", []() { return std::make_shared<const int>(1); }) == 1);
+
+    WaitForCoalescedCalls(flights, threadCount - 1);
+    release = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(calls == 1);
+    for (const auto& result : results)
+    {
+        REQUIRE(result == results[0]);
+        REQUIRE(*result == 42);
+    }
+}
+
+TEST("Testing SingleFlight::Do() shares exceptions")
+{
+    SingleFlight<int> flights;
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+
+    // Catch2 assertions are not thread-safe, so the threads only record what they caught
+    std::atomic<int> caughtErrors{0};
+    auto callAndCatch = [&](auto fn) {
+        try
+        {
+            flights.Do("a", fn);
+        }
+        catch (const std::runtime_error&)
+        {
+            ++caughtErrors;
+        }
+    };
+
+    std::thread leader([&]() {
+        callAndCatch([&]() -> SingleFlight<int>::ResultPtr {
+            started = true;
+            while (!release)
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+            throw std::runtime_error("error");
+        });
+    });
+    while (!started)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    std::thread follower([&]() { callAndCatch([]() { return std::make_shared<const int>(0); }); });
+
+    WaitForCoalescedCalls(flights, 1);
+    release = true;
+    leader.join();
+    follower.join();
+    REQUIRE(caughtErrors == 2);
+
+    // The failed call is not remembered
+    REQUIRE(*flights.Do("a", []() { return std::make_shared<const int>(1); }) == 1);
+}
+
+TEST("Testing SingleFlight::Do() does not share unshared exceptions")
+{
+    SingleFlight<int> flights;
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    auto isSharedError = [](const std::exception_ptr& error) {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const std::logic_error&)
+        {
+            return false;
+        }
+        catch (...)
+        {
+            return true;
+        }
+    };
+
+    // Catch2 assertions are not thread-safe, so the threads only record what they got
+    std::atomic<int> caughtErrors{0};
+    std::atomic<int> followerValue{-1};
+    std::thread leader([&]() {
+        try
+        {
+            flights.Do(
+                "a",
+                [&]() -> SingleFlight<int>::ResultPtr {
+                    started = true;
+                    while (!release)
+                    {
+                        std::this_thread::sleep_for(1ms);
+                    }
+                    throw std::logic_error("cancelled");
+                },
+                isSharedError);
+        }
+        catch (const std::logic_error&)
+        {
+            ++caughtErrors;
+        }
+    });
+    while (!started)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    std::thread follower([&]() {
+        followerValue = *flights.Do("a", []() { return std::make_shared<const int>(1); }, isSharedError);
+    });
+
+    WaitForCoalescedCalls(flights, 1);
+    release = true;
+    leader.join();
+    follower.join();
+
+    // The follower makes its own call instead of getting the error of the leader
+    REQUIRE(caughtErrors == 1);
+    REQUIRE(followerValue == 1);
+}
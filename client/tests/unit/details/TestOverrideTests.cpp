@@ -24,6 +24,7 @@ TEST("Testing AreTestOverridesAllowed()")
 TEST("Testing GetEnvVarNameFromOverride")
 {
     REQUIRE(GetEnvVarNameFromOverride(TestOverride::BaseUrl) == "SFS_TEST_OVERRIDE_BASE_URL");
+    REQUIRE(GetEnvVarNameFromOverride(TestOverride::Http2PriorKnowledge) == "SFS_TEST_HTTP2_PRIOR_KNOWLEDGE");
 }
 
 TEST("Testing GetTestOverride()")
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "UrlExpiry.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#define TEST(...) TEST_CASE("[UrlExpiryTests] " __VA_ARGS__)
+
+using namespace SFS::details;
+using namespace std::chrono;
+
+namespace
+{
+system_clock::time_point FromEpoch(long long seconds)
+{
+    return system_clock::time_point(duration_cast<system_clock::duration>(std::chrono::seconds(seconds)));
+}
+} // namespace
+
+TEST("Testing GetUrlExpiry()")
+{
+    // 2030-01-02T03:04:05Z
+    const long long expiry = 1893553445;
+
+    SECTION("No expiry")
+    {
+        REQUIRE(!GetUrlExpiry(""));
+        REQUIRE(!GetUrlExpiry("http://localhost/file.bin"));
+        REQUIRE(!GetUrlExpiry("http://localhost/file.bin?a=b&c"));
+        REQUIRE(!GetUrlExpiry("http://localhost/file.bin?se=&Expires=abc&P1=12x"));
+        REQUIRE(!GetUrlExpiry("http://localhost/file.bin?se=notadate"));
+    }
+
+    SECTION("Azure Storage SAS")
+    {
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?sv=2020&se=2030-01-02T03:04:05Z&sig=abc") ==
+                FromEpoch(expiry));
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?se=2030-01-02T03%3A04%3A05Z") == FromEpoch(expiry));
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?se=2030-01-02T03:04Z") == FromEpoch(expiry - 5));
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?se=2030-01-02") == FromEpoch(expiry - 3 * 3600 - 4 * 60 - 5));
+    }
+
+    SECTION("Epoch seconds")
+    {
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?Expires=1893553445") == FromEpoch(expiry));
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?expires=1893553445") == FromEpoch(expiry));
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?P1=1893553445&P2=404&P3=2&P4=abc") == FromEpoch(expiry));
+    }
+
+    SECTION("AWS SigV4")
+    {
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?X-Amz-Date=20300102T030405Z&X-Amz-Expires=3600") ==
+                FromEpoch(expiry + 3600));
+
+        // Both parameters are needed
+        REQUIRE(!GetUrlExpiry("http://localhost/file.bin?X-Amz-Date=20300102T030405Z"));
+        REQUIRE(!GetUrlExpiry("http://localhost/file.bin?X-Amz-Expires=3600"));
+    }
+
+    SECTION("The earliest expiry wins")
+    {
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?P1=1893553445&se=2030-01-02") ==
+                FromEpoch(expiry - 3 * 3600 - 4 * 60 - 5));
+    }
+
+    SECTION("Fragments are ignored")
+    {
+        REQUIRE(GetUrlExpiry("http://localhost/file.bin?P1=1893553445#P1=1") == FromEpoch(expiry));
+    }
+}
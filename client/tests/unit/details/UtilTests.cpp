@@ -30,3 +30,12 @@ TEST("Testing AreNotEqualI")
     REQUIRE(AreNotEqualI("ab", "abc"));
     REQUIRE(AreNotEqualI("abc", "abd"));
 }
+
+TEST("Testing GetHostKey")
+{
+    REQUIRE(GetHostKey("https://host.com/api/v2/contents") == "https://host.com");
+    REQUIRE(GetHostKey("https://host.com:8080/api") == "https://host.com:8080");
+    REQUIRE(GetHostKey("http://127.0.0.1:1234?action=x") == "http://127.0.0.1:1234");
+    REQUIRE(GetHostKey("https://host.com") == "https://host.com");
+    REQUIRE(GetHostKey("host.com/api") == "host.com");
+}
@@ -637,3 +637,47 @@ TEST("Testing FileEntity::DownloadInfoResponseToFileEntities()")
         }
     }
 }
+
+TEST("Testing FileEntity::CloneEntities()")
+{
+    auto generic = std::make_unique<GenericFileEntity>();
+    generic->fileId = c_fileId;
+    generic->url = c_url;
+    generic->sizeInBytes = c_size;
+    generic->hashes = {{"Sha1", c_sha1}, {"Sha256", c_sha256}};
+
+    auto app = std::make_unique<AppFileEntity>();
+    app->fileId = c_fileId;
+    app->url = c_url;
+    app->sizeInBytes = c_size;
+    app->hashes = {{"Sha1", c_sha1}, {"Sha256", c_sha256}};
+    app->fileMoniker = c_fileMoniker;
+    app->applicabilityDetails = c_appDetailsEntity;
+
+    FileEntities entities;
+    entities.push_back(std::move(generic));
+    entities.push_back(std::move(app));
+
+    FileEntities clones = FileEntity::CloneEntities(entities);
+    REQUIRE(clones.size() == 2);
+    REQUIRE(clones[0].get() != entities[0].get());
+    REQUIRE(clones[1].get() != entities[1].get());
+
+    REQUIRE(clones[0]->GetContentType() == ContentType::Generic);
+    REQUIRE(clones[0]->fileId == c_fileId);
+    REQUIRE(clones[0]->url == c_url);
+    REQUIRE(clones[0]->sizeInBytes == c_size);
+    REQUIRE(clones[0]->hashes == entities[0]->hashes);
+
+    REQUIRE(clones[1]->GetContentType() == ContentType::App);
+    const auto& appClone = dynamic_cast<const AppFileEntity&>(*clones[1]);
+    REQUIRE(appClone.fileId == c_fileId);
+    REQUIRE(appClone.fileMoniker == c_fileMoniker);
+    REQUIRE(appClone.applicabilityDetails.architectures == c_appDetailsEntity.architectures);
+    REQUIRE(appClone.applicabilityDetails.platformApplicabilityForPackage ==
+            c_appDetailsEntity.platformApplicabilityForPackage);
+
+    // Changing a clone does not change the original
+    clones[0]->url = "other";
+    REQUIRE(entities[0]->url == c_url);
+}
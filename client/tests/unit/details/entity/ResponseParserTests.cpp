@@ -0,0 +1,263 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "../../../util/SFSExceptionMatcher.h"
+#include "../../../util/TestHelper.h"
+#include "ReportingHandler.h"
+#include "SFSException.h"
+#include "connection/Connection.h"
+#include "entity/ResponseParser.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <functional>
+#include <map>
+
+#define TEST(...) TEST_CASE("[ResponseParserTests] " __VA_ARGS__)
+
+using namespace SFS;
+using namespace SFS::details;
+using namespace SFS::test;
+using json = nlohmann::json;
+
+namespace
+{
+std::string Describe(const ContentIdEntity& contentId)
+{
+    return contentId.nameSpace + "/" + contentId.name + "/" + contentId.version;
+}
+
+std::string Describe(const VersionEntity& entity)
+{
+    std::string description = Describe(entity.contentId);
+    if (auto app = dynamic_cast<const AppVersionEntity*>(&entity))
+    {
+        description += " app " + app->updateId;
+        for (const auto& prereq : app->prerequisites)
+        {
+            description += " " + Describe(prereq.contentId);
+        }
+    }
+    return description;
+}
+
+std::string Describe(const FileEntity& entity)
+{
+    std::string description = entity.fileId + " " + entity.url + " " + std::to_string(entity.sizeInBytes);
+    for (const auto& [hashType, hashValue] : std::map(entity.hashes.begin(), entity.hashes.end()))
+    {
+        description += " " + hashType + "=" + hashValue;
+    }
+    if (auto app = dynamic_cast<const AppFileEntity*>(&entity))
+    {
+        description += " app " + app->fileMoniker;
+        for (const auto& arch : app->applicabilityDetails.architectures)
+        {
+            description += " " + arch;
+        }
+        for (const auto& app : app->applicabilityDetails.platformApplicabilityForPackage)
+        {
+            description += " " + app;
+        }
+    }
+    return description;
+}
+
+template <typename EntitiesT>
+std::string Describe(const EntitiesT& entities)
+{
+    std::string description;
+    for (const auto& entity : entities)
+    {
+        description += "[" + Describe(*entity) + "]";
+    }
+    return description;
+}
+
+// Returns the description of what @param parse returns, or the message of the exception it throws
+std::string Outcome(const std::function<std::string()>& parse)
+{
+    try
+    {
+        return parse();
+    }
+    catch (const SFSException& ex)
+    {
+        REQUIRE(ex.GetResult().GetCode() == Result::ServiceInvalidResponse);
+
+        // The details of syntax errors depend on the JSON library the parsers are built with
+        const std::string syntaxError = "JSON Parsing error";
+        std::string message = ex.GetResult().GetMsg();
+        if (const auto pos = message.find(syntaxError); pos != std::string::npos)
+        {
+            message.resize(pos + syntaxError.size());
+        }
+        return "Error: " + message;
+    }
+}
+
+// Parses a response the way it was done before the SAX parsers, by building a JSON document first
+json ParseDocument(const std::string& data, const std::string& method)
+{
+    try
+    {
+        return json::parse(data);
+    }
+    catch (const json::parse_error& ex)
+    {
+        throw SFSException(Result::ServiceInvalidResponse, "(" + method + ") JSON Parsing error: " + ex.what());
+    }
+}
+
+const std::string c_contentId = R"("ContentId": {"Namespace": "ns", "Name": "name", "Version": "1.0"})";
+const std::string c_prereq = R"({"Namespace": "pns", "Name": "pname", "Version": "2.0"})";
+const std::string c_file = R"("FileId": "id", "Url": "http://url", "SizeInBytes": 10, "Hashes": {"Sha1": "abc"})";
+const std::string c_details = R"("ApplicabilityDetails": {"Architectures": ["x86"],
+                                                          "PlatformApplicabilityForPackage": ["app"]})";
+} // namespace
+
+TEST("Testing ParseVersionResponse() matches VersionEntity::FromJson()")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    const std::vector<std::string> responses = {
+        "{" + c_contentId + "}",
+        R"({"Extra": [{"ContentId": 1}], )" + c_contentId + "}",
+        "{" + c_contentId + R"(, "UpdateId": "id", "Prerequisites": [)" + c_prereq + "," + c_prereq + "]}",
+        R"({"UpdateId": "id", "Prerequisites": [], )" + c_contentId + "}",
+        R"({"ContentId": 1, )" + c_contentId + "}",
+        "{" + c_contentId + R"(, "ContentId": {"Namespace": "ns", "Name": "name"}})",
+        "{" + c_contentId + R"(, "Prerequisites": "ignored"})",
+        R"({"ContentId": {"Namespace": "ns", "Name": "name", "Version": 1}})",
+        R"({"ContentId": {"Namespace": "ns", "Version": "1.0"}})",
+        R"({"ContentId": {"Namespace": ["ns"], "Name": "name", "Version": "1.0"}})",
+        R"({"ContentId": []})",
+        R"({"Namespace": "ns", "Name": "name", "Version": "1.0"})",
+        "{" + c_contentId + R"(, "UpdateId": null, "Prerequisites": []})",
+        "{" + c_contentId + R"(, "UpdateId": "id"})",
+        "{" + c_contentId + R"(, "UpdateId": "id", "Prerequisites": {}})",
+        "{" + c_contentId + R"(, "UpdateId": "id", "Prerequisites": [)" + c_prereq + R"(, "prereq"]})",
+        "{" + c_contentId + R"(, "UpdateId": "id", "Prerequisites": [{"Namespace": "pns", "Name": "pname"}]})",
+        "{" + c_contentId + R"(, "UpdateId": "id", "Prerequisites": [{"Namespace": "pns", "Version": 2}]})",
+        "[{" + c_contentId + "}]",
+        R"("string")",
+        "{" + c_contentId,
+        R"({"ContentId": 1, "Extra": })",
+        "{" + c_contentId + "} trailing",
+        "",
+    };
+
+    for (const auto& response : responses)
+    {
+        INFO(response);
+        const std::string expected = Outcome([&]() {
+            return Describe(*VersionEntity::FromJson(ParseDocument(response, "Method"), handler));
+        });
+        const std::string actual =
+            Outcome([&]() { return Describe(*ParseVersionResponse(response, "Method", handler)); });
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST("Testing ParseVersionBatchResponse()")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    SECTION("Correct")
+    {
+        const std::string response = "[{" + c_contentId + "}, {" + c_contentId + R"(, "UpdateId": "id", )" +
+                                     R"("Prerequisites": [)" + c_prereq + "]}]";
+        VersionEntities entities;
+        REQUIRE_NOTHROW(entities = ParseVersionBatchResponse(response, "Method", handler));
+        REQUIRE(Describe(entities) == "[ns/name/1.0][ns/name/1.0 app id pns/pname/2.0]");
+    }
+
+    SECTION("Invalid")
+    {
+        REQUIRE_THROWS_CODE_MSG(ParseVersionBatchResponse("{" + c_contentId + "}", "Method", handler),
+                                ServiceInvalidResponse,
+                                "Response is not a JSON array");
+        REQUIRE_THROWS_CODE_MSG(ParseVersionBatchResponse("[]", "Method", handler),
+                                ServiceInvalidResponse,
+                                "Response does not have the expected size");
+        REQUIRE_THROWS_CODE_MSG(ParseVersionBatchResponse("[{" + c_contentId + "}, 1]", "Method", handler),
+                                ServiceInvalidResponse,
+                                "Response is not a JSON object");
+        REQUIRE_THROWS_CODE_MSG(ParseVersionBatchResponse(R"([{"ContentId": {}}])", "Method", handler),
+                                ServiceInvalidResponse,
+                                "Missing ContentId.Namespace in response");
+    }
+
+    SECTION("Syntax errors take precedence")
+    {
+        const std::string response = R"([{"ContentId": 1}, {)";
+        const std::string expected = Outcome([&]() { return ParseDocument(response, "Method").dump(); });
+        const std::string actual =
+            Outcome([&]() { return Describe(ParseVersionBatchResponse(response, "Method", handler)); });
+        REQUIRE(actual == expected);
+        REQUIRE(actual.find("(Method) JSON Parsing error") != std::string::npos);
+    }
+}
+
+TEST("Testing ParseDownloadInfoResponse() matches FileEntity::DownloadInfoResponseToFileEntities()")
+{
+    ReportingHandler handler;
+    handler.SetLoggingCallback(LogCallbackToTest);
+
+    const std::vector<std::string> responses = {
+        "[]",
+        "[{" + c_file + "}]",
+        "[{" + c_file + R"(, "Hashes": {"Sha256": "def", "Sha1": "abc"}, "DeliveryOptimization": {"a": [1]}}])",
+        "[{" + c_file + R"(, "FileMoniker": "moniker", )" + c_details + "}, {" + c_file + "}]",
+        "[{" + c_file + R"(, )" + c_details + "}]",
+        R"([{"Url": "http://url", "SizeInBytes": 10, "Hashes": {}}])",
+        R"([{"FileId": 1, "Url": "http://url", "SizeInBytes": 10, "Hashes": {}}])",
+        R"([{"FileId": "id", "SizeInBytes": 10, "Hashes": {}}])",
+        R"([{"FileId": "id", "Url": "http://url", "Hashes": {}}])",
+        R"([{"FileId": "id", "Url": "http://url", "SizeInBytes": -10, "Hashes": {}}])",
+        R"([{"FileId": "id", "Url": "http://url", "SizeInBytes": 10.5, "Hashes": {}}])",
+        R"([{"FileId": "id", "Url": "http://url", "SizeInBytes": "10", "Hashes": {}}])",
+        R"([{"FileId": "id", "Url": "http://url", "SizeInBytes": 10}])",
+        R"([{"FileId": "id", "Url": "http://url", "SizeInBytes": 10, "Hashes": []}])",
+        R"([{"FileId": "id", "Url": "http://url", "SizeInBytes": 10, "Hashes": {"Sha1": {"a": "b"}}}])",
+        "[{" + c_file + R"(, "Hashes": {"Sha1": 1}, "Hashes": {"Sha256": "def"}}])",
+        "[{" + c_file + R"(, "FileMoniker": 1, )" + c_details + "}]",
+        "[{" + c_file + R"(, "FileMoniker": "moniker"}])",
+        "[{" + c_file + R"(, "FileMoniker": "moniker", "ApplicabilityDetails": []}])",
+        "[{" + c_file + R"(, "FileMoniker": "moniker", "ApplicabilityDetails": {"Architectures": ["x86"]}}])",
+        "[{" + c_file + R"(, "FileMoniker": "moniker", "ApplicabilityDetails": {"Architectures": "x86",
+                                                         "PlatformApplicabilityForPackage": []}}])",
+        "[{" + c_file + R"(, "FileMoniker": "moniker", "ApplicabilityDetails": {"Architectures": [["x86"]],
+                                                         "PlatformApplicabilityForPackage": []}}])",
+        "[{" + c_file + R"(, "FileMoniker": "moniker", "ApplicabilityDetails": {"Architectures": [],
+                                                         "PlatformApplicabilityForPackage": [1]}}])",
+        "[{" + c_file + "}, 1]",
+        "{" + c_file + "}",
+        "[{" + c_file + "}",
+        R"([{"FileId": 1}, {"FileId": ])",
+    };
+
+    for (const auto& response : responses)
+    {
+        INFO(response);
+        const std::string expected = Outcome([&]() {
+            return Describe(FileEntity::DownloadInfoResponseToFileEntities(ParseDocument(response, "Method"), handler));
+        });
+        const std::string actual =
+            Outcome([&]() { return Describe(ParseDownloadInfoResponse(response, "Method", handler)); });
+        REQUIRE(actual == expected);
+
+        // A response read from a file, as done for those too large to be kept in memory, gives the same outcome
+        const FilePtr file(std::tmpfile());
+        REQUIRE(file);
+        REQUIRE(std::fwrite(response.data(), 1, response.size(), file.get()) == response.size());
+        std::rewind(file.get());
+        const std::string actualFromFile =
+            Outcome([&]() { return Describe(ParseDownloadInfoResponse(file.get(), "Method", handler)); });
+        REQUIRE(actualFromFile == expected);
+    }
+}
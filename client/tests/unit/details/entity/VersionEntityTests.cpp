@@ -303,3 +303,40 @@ TEST("Testing VersionEntity conversions")
         }
     }
 }
+
+TEST("Testing VersionEntity::Clone()")
+{
+    SECTION("GenericVersionEntity")
+    {
+        GenericVersionEntity entity;
+        entity.contentId = {c_ns, c_name, c_version};
+
+        auto clone = entity.Clone();
+        REQUIRE(clone->GetContentType() == ContentType::Generic);
+        REQUIRE(clone->contentId.nameSpace == c_ns);
+        REQUIRE(clone->contentId.name == c_name);
+        REQUIRE(clone->contentId.version == c_version);
+    }
+
+    SECTION("AppVersionEntity")
+    {
+        AppVersionEntity entity;
+        entity.contentId = {c_ns, c_name, c_version};
+        entity.updateId = c_updateId;
+        entity.prerequisites.emplace_back();
+        entity.prerequisites[0].contentId = {c_ns, "prereq", c_version};
+
+        auto clone = entity.Clone();
+        REQUIRE(clone->GetContentType() == ContentType::App);
+        auto appClone = dynamic_cast<AppVersionEntity*>(clone.get());
+        REQUIRE(appClone != nullptr);
+        REQUIRE(appClone->contentId.name == c_name);
+        REQUIRE(appClone->updateId == c_updateId);
+        REQUIRE(appClone->prerequisites.size() == 1);
+        REQUIRE(appClone->prerequisites[0].contentId.name == "prereq");
+
+        // The clone is independent from the original
+        entity.prerequisites.clear();
+        REQUIRE(appClone->prerequisites.size() == 1);
+    }
+}
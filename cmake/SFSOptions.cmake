@@ -9,6 +9,11 @@ option(
     "Set SFS_ENABLE_OVERRIDES to ON to enable certain test overrides through environment variables."
     OFF)
 
+option(
+    SFS_USE_SIMDJSON
+    "Set SFS_USE_SIMDJSON to ON to parse service responses with simdjson instead of nlohmann/json."
+    OFF)
+
 option(
     SFS_WINDOWS_STATIC_ONLY
     "Indicates if only static libraries and dependencies should be built on Windows."